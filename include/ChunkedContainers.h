@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Контейнеры, копии которых разделяют неизменённые части.
+// Копия копирует только указатели на блоки; изменение копирует свой блок,
+// если им ещё владеет другая копия (copy-on-write). Так IndexSnapshots::update
+// получает новую версию индекса за время, пропорциональное числу блоков,
+// а переиндексация копирует только блоки, которых касается.
+
+// Массив из блоков по kChunkSize элементов; блоки выделяются аллокатором Allocator.
+// Разные элементы можно изменять из разных потоков, пока массив ни с кем
+// не разделён (например, сразу после assign).
+template <typename T, typename Allocator = std::allocator<T>>
+class ChunkedVector {
+public:
+    static constexpr size_t kChunkSize = 1024;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const T& operator[](size_t i) const { return (*chunks_[i / kChunkSize])[i % kChunkSize]; }
+
+    // Элемент для изменения (копирует блок, если он разделён)
+    T& mutableAt(size_t i) { return mutableChunk(i / kChunkSize)[i % kChunkSize]; }
+
+    // count копий value в новых, ни с кем не разделённых блоках
+    void assign(size_t count, const T& value = T()) {
+        chunks_.clear();
+        chunks_.reserve((count + kChunkSize - 1) / kChunkSize);
+        for (size_t begin = 0; begin < count; begin += kChunkSize) {
+            chunks_.push_back(std::allocate_shared<Chunk>(Allocator(), std::min(kChunkSize, count - begin), value));
+        }
+        size_ = count;
+    }
+
+    void push_back(T value) {
+        if (size_ % kChunkSize == 0) chunks_.push_back(std::allocate_shared<Chunk>(Allocator()));
+        mutableChunk(chunks_.size() - 1).push_back(std::move(value));
+        ++size_;
+    }
+
+    void clear() {
+        chunks_.clear();
+        size_ = 0;
+    }
+
+    // Память блоков (без памяти, на которую ссылаются сами элементы)
+    size_t memoryBytes() const {
+        size_t bytes = chunks_.capacity() * sizeof(std::shared_ptr<Chunk>);
+        for (const auto& chunk : chunks_) bytes += sizeof(Chunk) + chunk->capacity() * sizeof(T);
+        return bytes;
+    }
+
+private:
+    using Chunk = std::vector<T, Allocator>;
+
+    Chunk& mutableChunk(size_t c) {
+        if (chunks_[c].use_count() > 1) chunks_[c] = std::allocate_shared<Chunk>(Allocator(), *chunks_[c]);
+        return *chunks_[c];
+    }
+
+    std::vector<std::shared_ptr<Chunk>> chunks_;
+    size_t size_ = 0;
+};
+
+// Хеш-таблица из сегментов Map (unordered_map) примерно по kShardSize
+// элементов; сегмент выбирается по хешу ключа, память сегментов выделяется
+// аллокатором Map. Число сегментов удваивается по мере роста таблицы.
+template <typename Map>
+class ShardedMap {
+public:
+    using key_type = typename Map::key_type;
+    using mapped_type = typename Map::mapped_type;
+    static constexpr size_t kShardSize = 64;
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    // Значение по ключу (nullptr, если ключа нет)
+    const mapped_type* find(const key_type& key) const {
+        if (shards_.empty()) return nullptr;
+        const Map& shard = *shards_[shardOf(key)];
+        auto it = shard.find(key);
+        return it == shard.end() ? nullptr : &it->second;
+    }
+
+    // Готовит сегменты под count элементов, чтобы вставки не делили их заново
+    void reserve(size_t count) {
+        if (count == 0) return;
+        size_t shards = std::max<size_t>(shards_.size(), 1);
+        while (shards * kShardSize < count) shards *= 2;
+        if (shards != shards_.size()) reshard(shards);
+    }
+
+    // Вставляет значение или заменяет прежнее
+    void assign(const key_type& key, mapped_type value) {
+        if (shards_.empty()) reshard(1);
+        const bool inserted = mutableShard(shardOf(key)).insert_or_assign(key, std::move(value)).second;
+        if (inserted && ++size_ > 2 * kShardSize * shards_.size()) reshard(2 * shards_.size());
+    }
+
+    // Удаляет ключ; false, если его не было
+    bool erase(const key_type& key) {
+        if (shards_.empty()) return false;
+        const size_t s = shardOf(key);
+        if (!shards_[s]->contains(key)) return false;  // не копировать сегмент напрасно
+        mutableShard(s).erase(key);
+        --size_;
+        return true;
+    }
+
+    void clear() {
+        shards_.clear();
+        size_ = 0;
+    }
+
+    // Обход всех пар (ключ, значение) в произвольном порядке
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const auto& shard : shards_) {
+            for (const auto& [key, value] : *shard) f(key, value);
+        }
+    }
+
+    // Память сегментов и их корзин (без узлов с элементами)
+    size_t tableBytes() const {
+        size_t bytes = shards_.capacity() * sizeof(std::shared_ptr<Map>);
+        for (const auto& shard : shards_) bytes += sizeof(Map) + shard->bucket_count() * sizeof(void*);
+        return bytes;
+    }
+
+private:
+    size_t shardOf(const key_type& key) const {
+        return typename Map::hasher{}(key) & (shards_.size() - 1);
+    }
+
+    std::shared_ptr<Map> makeShard() const {
+        return std::allocate_shared<Map>(typename Map::allocator_type());
+    }
+
+    Map& mutableShard(size_t s) {
+        if (shards_[s].use_count() > 1) {
+            auto copy = makeShard();
+            *copy = *shards_[s];
+            shards_[s] = std::move(copy);
+        }
+        return *shards_[s];
+    }
+
+    // Раскладывает элементы по count сегментам (count — степень двойки)
+    void reshard(size_t count) {
+        std::vector<std::shared_ptr<Map>> old = std::move(shards_);
+        shards_.clear();
+        shards_.reserve(count);
+        for (size_t s = 0; s < count; ++s) shards_.push_back(makeShard());
+        for (const auto& shard : old) {
+            for (const auto& [key, value] : *shard) shards_[shardOf(key)]->emplace(key, value);
+        }
+    }
+
+    std::vector<std::shared_ptr<Map>> shards_;
+    size_t size_ = 0;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "json.hpp"
+
+// Элемент массива files: путь или объект {"path": ..., "fields": {...}}
+struct ConfigFileEntry {
+    std::string path;
+    nlohmann::json fields;  // значение fields (null, если его нет)
+    bool valid = true;      // false — элемент не строка и не объект
+};
+
+// config.json или requests.json, прочитанный потоково (SAX). Элементы files
+// и requests сразу становятся строками, без дерева nlohmann::json на весь
+// массив; деревом собирается только небольшой объект config и объекты-элементы
+// files. Остальные ключи верхнего уровня пропускаются.
+struct ConfigDocument {
+    nlohmann::json config;          // значение ключа config (null — ключа нет)
+    bool has_files = false;         // files есть и это массив
+    std::vector<ConfigFileEntry> files;
+    bool has_requests = false;      // requests есть и это массив
+    std::vector<std::string> requests;
+    size_t skipped_requests = 0;    // элементы requests, которые не строки
+};
+
+enum class ConfigReadStatus {
+    Ok,
+    NotFound,          // файл не открылся
+    ParseError,        // не JSON; error — сообщение разборщика
+    InvalidStructure   // нарушена общая схема; error — описание
+};
+
+// Читает файл filename целиком и разбирает его за один проход.
+// Общая для всех читателей конфига проверка: объект в files должен
+// содержать строку path, а fields (если есть) — быть объектом.
+ConfigReadStatus ReadConfigDocument(const std::string& filename, ConfigDocument& document, std::string& error);
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 bool load_config(const std::string& filename,
@@ -11,8 +12,20 @@ bool save_config(const std::string& filename,
                  const std::vector<std::wstring>& files,
                  const std::vector<std::wstring>& queries);
 
+// Перекодирование UTF-8 <-> wchar_t (UTF-32, при 16-битном wchar_t — UTF-16).
+// Участки ASCII копируются без разбора. Некорректная последовательность
+// (обрыв, избыточная форма, суррогат, код больше U+10FFFF) — std::range_error.
 std::wstring utf8_to_wstring(const std::string& str);
 std::string wstring_to_utf8(const std::wstring& wstr);
+
+// Длина начального участка из байтов ASCII (< 0x80), проверяется блоками SSE2/AVX2
+size_t utf8_ascii_prefix(std::string_view text);
+
+// Корректен ли текст в UTF-8 (те же правила, что у utf8_to_wstring)
+bool is_valid_utf8(std::string_view text);
+
+// Заменяет короткое и длинное тире (U+2013, U+2014) на '-'
 std::wstring normalize_dash(const std::wstring& input);
+std::string normalize_dash(std::string_view input);
 
 std::wstring to_lower(const std::wstring& input);
@@ -3,6 +3,11 @@
 #include <string>
 #include <vector>
 #include "RelativeIndex.h"
+#include "DocumentStore.h"
+#include "DocumentTable.h"
+#include "FileWatcher.h"
+#include "Snippet.h"
+#include "Stemmer.h"
 
 class ConverterJSON {
 public:
@@ -11,8 +16,12 @@ public:
     bool SaveRequests(const std::string& filename) const;
     void SetRequests(const std::vector<std::string>& requests);
 
-    // Загружает конфиг
-    bool LoadConfig(const std::string& filename, std::string& error);
+    // Загружает конфиг. При read_documents = false тексты документов не
+    // читаются (только пути), их можно прочитать позже через ReadDocuments
+    bool LoadConfig(const std::string& filename, std::string& error, bool read_documents = true);
+
+    // Читает тексты документов по путям из конфига (параллельно)
+    bool ReadDocuments(std::string& error);
 
     // Загружает запросы
     bool LoadRequests(const std::string& filename, std::string& error);
@@ -20,6 +29,61 @@ public:
     // Возвращает загруженные документы
     const std::vector<std::string>& GetTextDocuments() const;
 
+    // Возвращает пути загруженных документов (в том же порядке, что и тексты)
+    const std::vector<std::string>& GetDocumentPaths() const;
+
+    // Пользовательские поля документов (в том же порядке, что и пути).
+    // Элемент files может быть объектом {"path": ..., "fields": {имя: число или строка}}
+    const std::vector<DocumentFields>& GetDocumentFields() const;
+
+    // Освобождает тексты документов после индексации
+    void ReleaseTextDocuments();
+
+    // Политика хранения документов в индексе из config.document_store, по умолчанию none
+    DocumentStorePolicy GetDocumentStorePolicy() const;
+
+    // Нужен ли позиционный индекс (config.positional_index), по умолчанию нет
+    bool IsPositionalIndexEnabled() const;
+
+    // Допустимое число опечаток в словах запроса (config.fuzzy, 0..2), по умолчанию 0
+    int GetFuzzyMaxEdits() const;
+
+    // Приводить ли слова к нижнему регистру (config.lowercase), по умолчанию нет
+    bool IsLowercaseEnabled() const;
+
+    // Стоп-слова (config.stop_words), по умолчанию нет
+    const std::vector<std::string>& GetStopWords() const;
+
+    // Языки стемминга (config.stemming: "english", "russian"), по умолчанию нет
+    const std::vector<StemLanguage>& GetStemLanguages() const;
+
+    // Число частых слов в индексе пар (config.pair_index_terms), по умолчанию 0 — выключен
+    size_t GetPairIndexTerms() const;
+
+    // Добавлять ли в ответы фрагменты документов (config.snippets), по умолчанию нет.
+    // Нужно хранилище документов (config.document_store)
+    bool IsSnippetsEnabled() const;
+
+    // Ограничения фрагментов (config.snippet_words — длина в словах, по умолчанию 30)
+    const SnippetOptions& GetSnippetOptions() const;
+
+    // Число шардов индекса (config.shards), по умолчанию 1
+    size_t GetShardCount() const;
+
+    // Бюджет памяти построения индекса во внешней памяти в байтах
+    // (config.index_memory_budget_mb), 0 — индекс строится в памяти
+    size_t GetIndexMemoryBudget() const;
+
+    // Файл сохранённого индекса для повторных запусков (config.index_path, путь
+    // относительно конфига), пусто — индекс каждый раз строится заново
+    const std::string& GetIndexPath() const;
+
+    // Наблюдение за файлами в режиме --watch: config.watch_debounce_ms (пауза
+    // перед обработкой пачки изменений), config.watch_poll_ms (период опроса
+    // без inotify), config.watch_polling (всегда опрашивать, например на
+    // сетевых файловых системах)
+    const WatchOptions& GetWatchOptions() const;
+
     // Возвращает загруженные запросы
     const std::vector<std::string>& GetRequests() const;
 
@@ -29,18 +93,37 @@ public:
     // Проверяет, совпадает ли версия из конфига с версией приложения
     bool CheckConfigVersion(const std::string& app_version) const;
 
-    // Сохраняет ответы в файл answers.json
+    // Сохраняет ответы в файл answers.json. snippets[i][j] — фрагмент для
+    // answers[i][j] (пустые не выводятся), documents[i][j] — сведения о документе
     bool SaveAnswers(const std::string& filename,
                      const std::vector<std::string>& requests,
-                     const std::vector<std::vector<RelativeIndex>>& answers) const;
+                     const std::vector<std::vector<RelativeIndex>>& answers,
+                     const std::vector<std::vector<Snippet>>& snippets = {},
+                     const std::vector<std::vector<DocumentInfo>>& documents = {}) const;
 
     // Сохраняет ответы в answers.json (по умолчанию)
     bool putAnswers(const std::vector<std::string>& requests,
-                    const std::vector<std::vector<RelativeIndex>>& answers) const;
+                    const std::vector<std::vector<RelativeIndex>>& answers,
+                    const std::vector<std::vector<Snippet>>& snippets = {},
+                    const std::vector<std::vector<DocumentInfo>>& documents = {}) const;
 
 private:
-    std::vector<std::wstring> file_paths_w;
     std::vector<std::string> text_documents_;
+    std::vector<std::string> document_paths_;
+    std::vector<DocumentFields> document_fields_;
+    DocumentStorePolicy document_store_policy_ = DocumentStorePolicy::None;
+    bool positional_index_ = false;
+    bool lowercase_ = false;
+    std::vector<std::string> stop_words_;
+    std::vector<StemLanguage> stem_languages_;
+    size_t pair_index_terms_ = 0;
+    bool snippets_ = false;
+    SnippetOptions snippet_options_;
+    int fuzzy_max_edits_ = 0;
+    size_t shard_count_ = 1;
+    size_t index_memory_budget_ = 0;
+    std::string index_path_;
+    WatchOptions watch_options_;
     std::vector<std::string> requests_;
     int max_responses_ = 5;
     std::string config_version_;
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Текущий и пиковый объём памяти, выделенной через CountingAllocator
+class MemoryCounter {
+public:
+    void add(size_t bytes) {
+        size_t now = current_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        size_t prev = peak_.load(std::memory_order_relaxed);
+        while (prev < now && !peak_.compare_exchange_weak(prev, now, std::memory_order_relaxed)) {
+        }
+    }
+
+    void sub(size_t bytes) { current_.fetch_sub(bytes, std::memory_order_relaxed); }
+
+    size_t current() const { return current_.load(std::memory_order_relaxed); }
+    size_t peak() const { return peak_.load(std::memory_order_relaxed); }
+
+    // Начинает новый замер пика с текущего значения
+    void resetPeak() { peak_.store(current(), std::memory_order_relaxed); }
+
+private:
+    std::atomic<size_t> current_{0};
+    std::atomic<size_t> peak_{0};
+};
+
+// Один счётчик на каждый тег
+template <typename Tag>
+MemoryCounter& MemoryCounterFor() {
+    static MemoryCounter counter;
+    return counter;
+}
+
+// Аллокатор без состояния, учитывающий выделения в счётчике тега Tag
+template <typename T, typename Tag>
+class CountingAllocator {
+public:
+    using value_type = T;
+
+    CountingAllocator() noexcept = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U, Tag>&) noexcept {}
+
+    T* allocate(size_t n) {
+        T* p = std::allocator<T>{}.allocate(n);
+        MemoryCounterFor<Tag>().add(n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        MemoryCounterFor<Tag>().sub(n * sizeof(T));
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U, Tag>&) const noexcept { return true; }
+};
+
+// Тег памяти структур инвертированного индекса
+struct IndexMemoryTag {};
+
+template <typename T>
+using IndexAllocator = CountingAllocator<T, IndexMemoryTag>;
@@ -0,0 +1,15 @@
+#pragma once
+
+// Уровень векторных инструкций, доступный на текущем процессоре.
+// Ядра с SIMD выбирают реализацию по нему при первом вызове.
+enum class SimdLevel {
+    Scalar,
+    Sse2,
+    Avx2
+};
+
+// Лучший уровень, поддерживаемый процессором и сборкой (определяется один раз)
+SimdLevel DetectSimdLevel();
+
+// Название уровня для отчётов ("scalar", "sse2", "avx2")
+const char* SimdLevelName(SimdLevel level);
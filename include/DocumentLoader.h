@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Буфер ввода-вывода, выровненный по kAlignment байт (странице): такой буфер
+// годится для чтения с O_DIRECT и регистрации в io_uring без частично
+// занятых страниц. Размер округляется вверх до кратного kAlignment.
+class AlignedBuffer {
+public:
+    static constexpr size_t kAlignment = 4096;
+
+    AlignedBuffer() = default;
+    explicit AlignedBuffer(size_t size);
+
+    char* data() const { return data_.get(); }
+    size_t size() const { return size_; }
+
+private:
+    struct Free {
+        void operator()(char* p) const;
+    };
+    std::unique_ptr<char[], Free> data_;
+    size_t size_ = 0;
+};
+
+// Читает файл целиком: размер берётся из fstat, ядру сообщается о
+// последовательном чтении (posix_fadvise), данные читаются крупными блоками
+// прямо в строку. Пустой файл — не ошибка. mtime (необязательно) — время
+// изменения файла (секунды Unix) из того же fstat, то есть до чтения.
+// direct — читать в обход кеша страниц (O_DIRECT) через выровненный буфер
+// потока; если файловая система O_DIRECT не поддерживает, файл читается обычно.
+bool ReadWholeFile(const std::string& path, std::string& text, std::string& error, int64_t* mtime = nullptr,
+                   bool direct = false);
+
+// Конвейер загрузки документов: потоки ввода-вывода читают файлы в
+// очередь ограниченного размера, потоки обработки забирают из неё тексты.
+// Чтение следующих файлов идёт одновременно с обработкой уже прочитанных,
+// а в памяти одновременно находится не больше queue_capacity текстов
+// (плюс обрабатываемые).
+class DocumentLoader {
+public:
+    struct Options {
+        size_t io_threads = 2;
+        size_t worker_threads = 0;   // 0 — по числу ядер
+        size_t queue_capacity = 16;  // число прочитанных, но не обработанных текстов
+        bool use_io_uring = true;    // читать через io_uring, если он доступен (см. UringReader)
+        bool direct_io = false;      // читать в обход кеша страниц (O_DIRECT, см. ReadWholeFile)
+    };
+
+    // Вызывается из потоков обработки для каждого файла (в любом порядке)
+    using Consumer = std::function<void(size_t doc_id, std::string& text)>;
+    // Вызывается из потоков ввода-вывода для файла, который не удалось прочитать
+    using ErrorHandler = std::function<void(size_t doc_id, const std::string& error)>;
+
+    DocumentLoader() = default;
+    explicit DocumentLoader(Options options) : options(options) {}
+
+    // Обрабатывает все файлы и возвращает управление после последнего.
+    // mtimes (необязательно, размером с paths) получает время изменения файлов,
+    // снятое до чтения; mtimes[i] записывается до вызова consume для i.
+    void run(const std::vector<std::string>& paths, const Consumer& consume,
+             const ErrorHandler& on_error = {}, std::vector<int64_t>* mtimes = nullptr) const;
+
+private:
+    Options options;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ChunkedContainers.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Что индекс хранит от текста документов после индексации
+enum class DocumentStorePolicy {
+    None,        // ничего: поиску тексты не нужны
+    Mapped,      // только путь и размер, текст читается через mmap исходного файла
+    Compressed   // текст, сжатый LZ-кодеком
+};
+
+// Разбирает название политики из конфига ("none", "mapped", "compressed")
+std::optional<DocumentStorePolicy> ParseDocumentStorePolicy(const std::string& name);
+
+class DocumentStore {
+public:
+    explicit DocumentStore(DocumentStorePolicy policy = DocumentStorePolicy::None)
+        : policy_(policy) {}
+
+    DocumentStorePolicy policy() const { return policy_; }
+    void setPolicy(DocumentStorePolicy policy);
+
+    // Очищает хранилище и резервирует count слотов
+    void reset(size_t count);
+
+    // Сохраняет документ согласно политике. Разные doc_id можно
+    // записывать из разных потоков после reset().
+    // Для Mapped без source_path документ сохраняется сжатым.
+    void set(size_t doc_id, const std::string& text, const std::string& source_path = {});
+
+    // Возвращает текст документа (не больше max_bytes от начала),
+    // если политика его сохраняет
+    std::optional<std::string> get(size_t doc_id, size_t max_bytes = SIZE_MAX) const;
+
+    size_t size() const { return slots_.size(); }
+
+    // Память, занятая хранилищем (без отображённых файлов)
+    size_t memoryBytes() const;
+
+private:
+    struct Slot {
+        std::shared_ptr<const std::string> compressed;  // разделяется между копиями хранилища
+        std::string path;
+        size_t raw_size = 0;
+        bool stored = false;
+    };
+
+    DocumentStorePolicy policy_;
+    ChunkedVector<Slot> slots_;  // блоки слотов общие у копий хранилища
+};
+
+// LZ77-кодек (формат блока LZ4) для Compressed-хранилища
+std::string LzCompress(const std::string& input);
+// max_output — распаковка останавливается, набрав столько байт (результат обрезается)
+std::string LzDecompress(const std::string& input, size_t raw_size, size_t max_output = SIZE_MAX);
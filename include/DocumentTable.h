@@ -0,0 +1,111 @@
+#pragma once
+
+#include "ChunkedContainers.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+// Значение пользовательского поля документа: число или строка
+using FieldValue = std::variant<double, std::string>;
+
+// Пользовательские поля одного документа (имя → значение)
+using DocumentFields = std::vector<std::pair<std::string, FieldValue>>;
+
+// Сведения о документе, возвращаемые вместе с ответом
+struct DocumentInfo {
+    std::string path;   // пусто, если документ передан строкой
+    uint64_t size = 0;  // размер текста в байтах
+    int64_t mtime = 0;  // время изменения файла (секунды Unix), 0 — неизвестно
+    uint64_t hash = 0;  // XXH64 текста
+    DocumentFields fields;
+
+    bool operator==(const DocumentInfo& other) const = default;
+};
+
+// Отпечаток файла документа: по нему решается, нужно ли перечитывать файл
+struct FileFingerprint {
+    std::string path;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t hash = 0;
+
+    bool operator==(const FileFingerprint& other) const = default;
+};
+
+// Столбец пользовательского поля. Тип столбца задаёт первое значение;
+// значения другого типа не сохраняются.
+class FieldColumn {
+public:
+    bool numeric() const { return numeric_; }
+
+    // Значение документа или nullopt, если у документа его нет
+    std::optional<FieldValue> get(size_t doc_id) const;
+
+    // Числовое значение (NaN, если нет или столбец строковый)
+    double number(size_t doc_id) const;
+
+    size_t memoryBytes() const;
+
+private:
+    friend class DocumentTable;
+    static constexpr uint32_t kMissing = UINT32_MAX;
+
+    bool numeric_ = true;
+    std::vector<double> numbers_;         // NaN — значения нет
+    std::vector<uint32_t> string_ids_;    // номер в dictionary_ или kMissing
+    std::vector<std::string> dictionary_; // различные строковые значения
+};
+
+// Таблица документов индекса: путь, размер, время изменения, хеш текста и
+// пользовательские поля. Каждое свойство хранится отдельным массивом по doc_id;
+// копии таблицы делят неизменённые блоки массивов и столбцы полей.
+class DocumentTable {
+public:
+    // Очищает таблицу (кроме пользовательских полей) и резервирует count строк
+    void reset(size_t count);
+
+    // Заполняет строку по тексту документа. mtime — время изменения файла path,
+    // снятое до чтения text (0 — неизвестно): если файл изменят во время
+    // индексации, отпечаток окажется старше содержимого и файл перечитают.
+    // Разные doc_id можно записывать из разных потоков после reset().
+    void set(size_t doc_id, const std::string& path, const std::string& text, int64_t mtime);
+
+    // Заполняет строку готовым отпечатком (текст не нужен)
+    void setFingerprint(size_t doc_id, const FileFingerprint& file);
+    FileFingerprint fingerprint(size_t doc_id) const;
+
+    // Добавляет строку в конец таблицы
+    void add(const std::string& path, const std::string& text, int64_t mtime);
+
+    // Заменяет пользовательские поля; fields[i] — поля документа i
+    void setFields(const std::vector<DocumentFields>& fields);
+
+    size_t size() const { return paths_.size(); }
+
+    // Все сведения о документе (doc_id < size())
+    DocumentInfo get(size_t doc_id) const;
+
+    const std::string& path(size_t doc_id) const { return paths_[doc_id]; }
+    uint64_t hash(size_t doc_id) const { return hashes_[doc_id]; }
+
+    // Столбец поля (nullptr, если поля нет)
+    const FieldColumn* field(const std::string& name) const;
+
+    // Память, занятая таблицей
+    size_t memoryBytes() const;
+
+private:
+    ChunkedVector<std::string> paths_;
+    ChunkedVector<uint64_t> sizes_;
+    ChunkedVector<int64_t> mtimes_;
+    ChunkedVector<uint64_t> hashes_;
+    std::shared_ptr<const std::map<std::string, FieldColumn>> fields_;  // nullptr — полей нет
+};
+
+// Время изменения файла в секундах Unix (0, если файл недоступен)
+int64_t FileModificationTime(const std::string& path);
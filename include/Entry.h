@@ -1,8 +1,64 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Номер документа и число вхождений слова. По умолчанию 32-битные: списки
+// вхождений и результаты поиска вдвое компактнее, чем с size_t.
+// SEARCH_ENGINE_WIDE_IDS включает 64-битные (сжатые списки всё равно
+// ограничены 32 битами, см. CompressedPostings).
+#ifdef SEARCH_ENGINE_WIDE_IDS
+using DocId = uint64_t;
+using TermCount = uint64_t;
+#else
+using DocId = uint32_t;
+using TermCount = uint32_t;
+#endif
+
 struct Entry {
-    size_t doc_id;
-    size_t count;
+    DocId doc_id;
+    TermCount count;
 
     bool operator==(const Entry& other) const = default;
 };
+
+// Список вхождений в виде структуры массивов: doc_id и частоты лежат
+// отдельно, поэтому проходы по doc_id (пересечение, поиск документа)
+// читают только нужные байты и векторизуются компилятором.
+template <template <typename> class Allocator>
+struct BasicPostings {
+    std::vector<DocId, Allocator<DocId>> doc_ids;
+    std::vector<TermCount, Allocator<TermCount>> counts;
+
+    size_t size() const { return doc_ids.size(); }
+    bool empty() const { return doc_ids.empty(); }
+
+    void reserve(size_t n) {
+        doc_ids.reserve(n);
+        counts.reserve(n);
+    }
+
+    void push_back(DocId doc_id, TermCount count) {
+        doc_ids.push_back(doc_id);
+        counts.push_back(count);
+    }
+
+    template <template <typename> class OtherAllocator>
+    void append(const BasicPostings<OtherAllocator>& other) {
+        doc_ids.insert(doc_ids.end(), other.doc_ids.begin(), other.doc_ids.end());
+        counts.insert(counts.end(), other.counts.begin(), other.counts.end());
+    }
+
+    Entry operator[](size_t i) const { return {doc_ids[i], counts[i]}; }
+
+    std::vector<Entry> entries() const {
+        std::vector<Entry> out;
+        out.reserve(size());
+        for (size_t i = 0; i < size(); ++i) out.push_back((*this)[i]);
+        return out;
+    }
+};
+
+using Postings = BasicPostings<std::allocator>;
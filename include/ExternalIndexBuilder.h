@@ -0,0 +1,62 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "DocumentTable.h"
+#include "Entry.h"
+#include "Tokenizer.h"
+
+// Построение индекса во внешней памяти (SPIMI).
+// Документы индексируются по одному в словарь в памяти; когда его размер
+// достигает memory_budget байт, словарь сортируется и сбрасывается во
+// временный файл-прогон. finish() сливает прогоны k-путевым слиянием в
+// итоговый файл индекса (формат PostingFileWriter), который загружается
+// InvertedIndex::loadFromFile. Бюджетом (и самым длинным списком вхождений
+// одного слова) ограничена только память построения: загруженный для поиска
+// индекс целиком находится в памяти.
+class ExternalIndexBuilder {
+public:
+    // temp_dir создаётся при необходимости; прогоны удаляются после finish()
+    ExternalIndexBuilder(std::string temp_dir, size_t memory_budget, TokenizerOptions options = {});
+    ~ExternalIndexBuilder();
+
+    ExternalIndexBuilder(const ExternalIndexBuilder&) = delete;
+    ExternalIndexBuilder& operator=(const ExternalIndexBuilder&) = delete;
+
+    // Индексирует документ; номера документов присваиваются по порядку
+    bool addDocument(const std::string& text, std::string& error);
+
+    // Индексирует документ из файла (пустой файл — документ без слов)
+    bool addFile(const std::string& path, std::string& error);
+
+    // Сбрасывает остаток, сливает прогоны в index_path и удаляет их
+    bool finish(const std::string& index_path, std::string& error);
+
+    size_t documentCount() const { return doc_count_; }
+
+    // Таблица добавленных документов (для InvertedIndex::setDocumentTable)
+    const DocumentTable& documentTable() const { return documents_; }
+
+    // Число прогонов, сброшенных на диск
+    size_t runCount() const { return run_paths_.size(); }
+
+private:
+    bool AddText(const std::string& text, const std::string& path, int64_t mtime, std::string& error);
+    bool FlushRun(std::string& error);
+    void RemoveRuns();
+
+    std::string temp_dir_;
+    size_t memory_budget_;
+    TokenizerOptions options_;
+    size_t doc_count_ = 0;
+    DocumentTable documents_;
+    std::unordered_map<std::string, std::vector<Entry>> block_;
+    size_t block_bytes_ = 0;  // оценка памяти, занятой block_
+    std::vector<std::string> run_paths_;
+};
+
+// Создаёт новый каталог prefix + случайный суффикс во временном каталоге
+// системы, чтобы одновременные запуски не делили прогоны. nullopt — не удалось.
+std::optional<std::string> CreateUniqueTempDirectory(const std::string& prefix);
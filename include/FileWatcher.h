@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Настройки наблюдения за файлами
+struct WatchOptions {
+    std::chrono::milliseconds debounce{300};         // пачка отдаётся после такой паузы в событиях
+    std::chrono::milliseconds max_delay{3000};       // но не позже этого срока от первого события
+    std::chrono::milliseconds poll_interval{1000};   // период опроса stat без inotify
+    bool force_polling = false;                      // опрашивать stat даже при доступном inotify
+};
+
+// Следит за файлами paths и сообщает об изменениях пачками.
+// С inotify (Linux, сборка с SEARCH_ENGINE_INOTIFY) наблюдаются каталоги
+// файлов: так замечается и запись на месте, и замена файла переименованием.
+// Иначе (или если inotify недоступен во время работы) раз в poll_interval
+// сравниваются размер и время изменения каждого файла.
+// События копятся, пока не наступит пауза debounce, затем on_change получает
+// номера изменившихся файлов по возрастанию. on_change вызывается из потока
+// наблюдения; следующая пачка копится, пока он работает.
+class FileWatcher {
+public:
+    using ChangeHandler = std::function<void(const std::vector<size_t>& changed)>;
+
+    explicit FileWatcher(std::vector<std::string> paths, WatchOptions options = {});
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Запускает поток наблюдения
+    bool start(ChangeHandler on_change, std::string& error);
+
+    // Останавливает наблюдение; накопленная пачка не отдаётся
+    void stop();
+
+    // Наблюдение идёт через inotify (иначе — опрос stat)
+    bool usesInotify() const { return inotify_fd_ >= 0; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    // Состояние файла для опроса: размер и время изменения (нс), -1 — файла нет
+    struct FileState {
+        int64_t size = -1;
+        int64_t mtime = 0;
+        bool operator==(const FileState& other) const = default;
+    };
+
+    bool openInotify(std::string& error);
+    void closeInotify();
+    void run();
+    // Ждёт событий не дольше timeout; false — наблюдение остановлено
+    bool waitInotify(Clock::duration timeout);
+    bool waitPolling(Clock::duration timeout);
+    void markChanged(size_t index);
+    static FileState ReadState(const std::string& path);
+
+    std::vector<std::string> paths_;
+    WatchOptions options_;
+    ChangeHandler on_change_;
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+    std::mutex stop_mutex_;
+    std::condition_variable stop_cv_;
+
+    // inotify: дескриптор наблюдения каталога → имя файла → номера файлов
+    int inotify_fd_ = -1;
+    int wake_fd_ = -1;  // eventfd для остановки
+    std::unordered_map<int, std::unordered_map<std::string, std::vector<size_t>>> watched_;
+
+    std::vector<FileState> states_;
+    Clock::time_point next_poll_;
+
+    // Накопленная пачка
+    std::vector<bool> pending_;
+    size_t pending_count_ = 0;
+    Clock::time_point first_event_;
+    Clock::time_point last_event_;
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// XXH64 (совместим с эталонной реализацией xxHash)
+uint64_t XXH64(const void* data, size_t size, uint64_t seed = 0);
+
+inline uint64_t XXH64(const std::string& text, uint64_t seed = 0) {
+    return XXH64(text.data(), text.size(), seed);
+}
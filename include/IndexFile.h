@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Entry.h"
+
+// Последовательный файл списков вхождений, упорядоченный по словам.
+// Используется для промежуточных прогонов внешнего построения и для
+// итогового индекса на диске. Формат:
+//   заголовок: "SEPL", версия, число документов (varint)
+//   записи:    длина слова, слово, число вхождений,
+//              затем пары (разность doc_id с предыдущим, count) — всё varint
+class PostingFileWriter {
+public:
+    bool open(const std::string& path, size_t doc_count, std::string& error);
+
+    // Слова должны идти строго по возрастанию, doc_id внутри списка — по возрастанию
+    void write(const std::string& word, const std::vector<Entry>& entries);
+
+    bool close(std::string& error);
+
+private:
+    void putVarint(uint64_t value);
+
+    std::ofstream out_;
+    std::string path_;
+};
+
+class PostingFileReader {
+public:
+    bool open(const std::string& path, std::string& error);
+
+    size_t documentCount() const { return doc_count_; }
+
+    // Читает следующую запись; false в конце файла или при ошибке (см. failed)
+    bool next();
+    bool failed() const { return failed_; }
+
+    const std::string& word() const { return word_; }
+    const std::vector<Entry>& entries() const { return entries_; }
+
+private:
+    bool getVarint(uint64_t& value);
+
+    std::ifstream in_;
+    size_t doc_count_ = 0;
+    bool failed_ = false;
+    std::string word_;
+    std::vector<Entry> entries_;
+};
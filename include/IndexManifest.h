@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DocumentTable.h"
+#include "InvertedIndex.h"
+
+// Манифест сохранённого индекса: отпечаток настроек разбора и отпечатки
+// файлов (путь, размер, время изменения, XXH64) в порядке doc_id.
+// Текстовый файл: строка "SEMF <версия> <настройки> <время записи>", затем по строке на файл.
+struct IndexManifest {
+    uint64_t settings = 0;
+    // Время начала проверки файлов (секунды Unix). Файл, изменённый в эту секунду
+    // или позже, мог измениться ещё раз без смены mtime, поэтому он всегда перечитывается.
+    int64_t saved_at = 0;
+    std::vector<FileFingerprint> files;
+};
+
+bool SaveManifest(const std::string& path, const IndexManifest& manifest, std::string& error);
+bool LoadManifest(const std::string& path, IndexManifest& manifest, std::string& error);
+
+// Итог обновления индекса
+struct ReloadStats {
+    bool full_rebuild = false;  // сохранённый индекс не подошёл, индекс построен заново
+    size_t files_read = 0;      // прочитано файлов
+    size_t files_changed = 0;   // проиндексировано документов (при обновлении — с изменённым содержимым)
+};
+
+// Строит index по файлам paths, используя индекс, сохранённый в index_path, и
+// его манифест (index_path + ".manifest"). Файл перечитывается, только если
+// его размер или время изменения не совпадают с манифестом, и переиндексируется,
+// только если изменилось содержимое (XXH64). Индекс строится заново, если
+// сохранённого нет, изменился список файлов или настройки разбора. Нечитаемый
+// файл, как и при полном построении, индексируется пустым документом. В конце
+// индекс и манифест сохраняются. Позиции и тексты документов в файле индекса
+// не хранятся, поэтому при positional_index или document_store индекс
+// всегда строится заново и не сохраняется.
+bool ReloadIndex(InvertedIndex& index, const std::vector<std::string>& paths, const std::string& index_path,
+                 ReloadStats& stats, std::string& error);
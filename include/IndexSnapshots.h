@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "InvertedIndex.h"
+
+// Публикация неизменяемых версий индекса (RCU).
+// Читатель закрепляет текущую версию через acquire() и работает с ней без
+// блокировок; писатель строит новый индекс в стороне и атомарно подменяет
+// указатель. Старая версия освобождается, когда её отпустит последний читатель.
+class IndexSnapshots {
+public:
+    IndexSnapshots() : IndexSnapshots(std::make_shared<const InvertedIndex>()) {}
+    explicit IndexSnapshots(std::shared_ptr<const InvertedIndex> initial);
+
+    // Текущая версия; остаётся корректной, пока жив возвращённый указатель
+    std::shared_ptr<const InvertedIndex> acquire() const {
+        return current.load(std::memory_order_acquire);
+    }
+
+    // Делает next текущей версией
+    void publish(std::shared_ptr<const InvertedIndex> next);
+
+    // Строит новый индекс функцией build и публикует его.
+    // Построения выполняются по одному; чтение при этом не останавливается.
+    void rebuild(const std::function<void(InvertedIndex&)>& build);
+
+    // Копирует текущую версию, изменяет копию функцией change и публикует её
+    // (например, переиндексация нескольких документов без полного построения).
+    // Копия делит с текущей версией списки вхождений, позиции и сжатые тексты,
+    // а также блоки словарей, страниц словаря терминов и таблиц документов
+    // (ChunkedContainers.h): копируются только указатели на блоки, а изменение
+    // копирует лишь затронутые блоки.
+    void update(const std::function<void(InvertedIndex&)>& change);
+
+    // Номер текущей версии (растёт с каждой публикацией)
+    uint64_t version() const { return published.load(std::memory_order_acquire); }
+
+private:
+    std::atomic<std::shared_ptr<const InvertedIndex>> current;
+    std::atomic<uint64_t> published{0};
+    std::mutex writer_mutex;
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FileWatcher.h"
+#include "IndexManifest.h"
+#include "IndexSnapshots.h"
+
+// Держит опубликованный индекс в соответствии с файлами документов.
+// Пачки изменений FileWatcher применяются в потоке наблюдения: изменившиеся
+// файлы перечитываются, документы с другим содержимым (размер, XXH64)
+// переиндексируются в копии текущей версии, и копия публикуется.
+// Поиск по snapshots при этом не останавливается.
+class IndexWatcher {
+public:
+    using UpdateHandler = std::function<void(const ReloadStats& stats)>;
+
+    // Файлы берутся из таблицы документов текущей версии индекса
+    explicit IndexWatcher(std::shared_ptr<IndexSnapshots> snapshots, WatchOptions options = {});
+
+    // on_update (необязательно) вызывается после каждой обработанной пачки
+    bool start(std::string& error, UpdateHandler on_update = {});
+    void stop() { watcher_.stop(); }
+
+    bool usesInotify() const { return watcher_.usesInotify(); }
+
+    // Проверяет файлы changed (номера документов) и публикует новую версию,
+    // если содержимое хотя бы одного изменилось. Недоступный файл
+    // индексируется как пустой документ.
+    ReloadStats apply(const std::vector<size_t>& changed);
+
+private:
+    static std::vector<std::string> DocumentPaths(const InvertedIndex& index);
+
+    std::shared_ptr<IndexSnapshots> snapshots_;
+    FileWatcher watcher_;
+};
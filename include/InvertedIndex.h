@@ -3,17 +3,221 @@
 #include <vector>
 #include <unordered_map>
 #include "Entry.h"
+#include "ChunkedContainers.h"
+#include "CountingAllocator.h"
+#include "DocumentStore.h"
+#include "DocumentTable.h"
+#include "PositionList.h"
+#include "PostingCodec.h"
+#include "TermDictionary.h"
+#include "Tokenizer.h"
+#include <memory>
 #include <mutex>
 
+// Список вхождений слова при построении; память учитывается счётчиком IndexMemoryTag
+using PostingList = BasicPostings<IndexAllocator>;
+
+using TermPostings = std::unordered_map<
+    std::string, PostingList,
+    std::hash<std::string>, std::equal_to<std::string>,
+    IndexAllocator<std::pair<const std::string, PostingList>>>;
+
+// Готовый индекс хранит списки вхождений сжатыми (см. CompressedPostings).
+// Списки неизменяемы и разделяются между копиями индекса, как и сегменты
+// словарей (ShardedMap): копия для IndexSnapshots::update копирует указатели
+// на сегменты, а переиндексация заменяет только затронутые списки и сегменты.
+using SharedPostings = std::shared_ptr<const CompressedPostings>;
+using CompressedTermPostings = std::unordered_map<
+    std::string, SharedPostings,
+    std::hash<std::string>, std::equal_to<std::string>,
+    IndexAllocator<std::pair<const std::string, SharedPostings>>>;
+
+// Номера различных слов документа в прямом индексе
+using TermIdList = std::vector<uint32_t, IndexAllocator<uint32_t>>;
+using TermIds = std::unordered_map<
+    std::string, uint32_t,
+    std::hash<std::string>, std::equal_to<std::string>,
+    IndexAllocator<std::pair<const std::string, uint32_t>>>;
+using IndexString = std::basic_string<char, std::char_traits<char>, IndexAllocator<char>>;
+
+using SharedPositions = std::shared_ptr<const PositionList>;
+using TermPositions = std::unordered_map<
+    std::string, SharedPositions,
+    std::hash<std::string>, std::equal_to<std::string>,
+    IndexAllocator<std::pair<const std::string, SharedPositions>>>;
+
+// Отчёт о памяти, занятой индексом (в байтах)
+struct IndexMemoryUsage {
+    size_t term_bytes = 0;        // строки терминов вне SSO-буфера
+    size_t posting_bytes = 0;     // сжатые списки вхождений
+    size_t hash_table_bytes = 0;  // бакеты и узлы freq_dictionary
+    size_t position_bytes = 0;    // позиционный индекс (если включён)
+    size_t dictionary_bytes = 0;  // упорядоченный словарь терминов
+    size_t document_bytes = 0;    // хранилище документов (DocumentStore)
+    size_t table_bytes = 0;       // таблица документов (DocumentTable)
+    size_t pair_bytes = 0;        // индекс пар частых слов
+    size_t forward_bytes = 0;     // прямой индекс: номера слов каждого документа
+    size_t peak_build_bytes = 0;  // пик учтённой памяти во время последнего построения
+
+    size_t total() const {
+        return term_bytes + posting_bytes + hash_table_bytes + position_bytes + dictionary_bytes
+             + document_bytes + table_bytes + pair_bytes + forward_bytes;
+    }
+};
+
 class InvertedIndex {
 public:
     void updateDocumentBase(const std::vector<std::string>& file_paths);
+    // Декодированный список вхождений слова (по возрастанию doc_id)
     std::vector<Entry> getWordCount(const std::string& word) const;
-    void updateDocumentBaseFromStrings(const std::vector<std::string>& docs_input);
+
+    // То же в виде отдельных массивов doc_id и частот (для поиска)
+    Postings getPostings(const std::string& word) const;
+
+    // Сжатый список вхождений слова (nullptr, если слова нет)
+    const CompressedPostings* findPostings(const std::string& word) const;
+
+    // Число документов со словом (без копирования списка)
+    size_t documentFrequency(const std::string& word) const;
+
+    // source_paths (необязательно) — пути к исходным файлам для политики Mapped
+    void updateDocumentBaseFromStrings(const std::vector<std::string>& docs_input,
+                                       const std::vector<std::string>& source_paths = {});
+
+    // Заменяет документы doc_ids (< documentCount()) новыми текстами, не
+    // перестраивая остальные: по прямому индексу (строится из списков
+    // вхождений при первом вызове) находятся прежние слова изменённых документов, и перекодируются только их списки, списки
+    // новых слов, страницы словаря с появившимися и исчезнувшими словами и
+    // пары частых слов, встречавшихся в изменённых документах.
+    // mtimes (необязательно) — время изменения файлов, снятое до их чтения;
+    // без него время берётся у файла сейчас.
+    void reindexDocuments(const std::vector<size_t>& doc_ids, const std::vector<std::string>& texts,
+                          const std::vector<std::string>& source_paths = {},
+                          const std::vector<int64_t>& mtimes = {});
+
+    // Сохраняет списки вхождений в формате PostingFileWriter (читается loadFromFile)
+    bool saveToFile(const std::string& path, std::string& error) const;
+
+    // Загружает индекс из файла, построенного ExternalIndexBuilder.
+    // Позиции и тексты документов в файле не хранятся: позиционный индекс
+    // выключается, хранилище документов остаётся пустым.
+    bool loadFromFile(const std::string& path, std::string& error);
+
+    // Подсчитывает память, занятую индексом
+    IndexMemoryUsage memoryUsage() const;
+
+    // Политика хранения текстов документов (по умолчанию не хранятся).
+    // Применяется при следующем построении индекса.
+    void setDocumentStorePolicy(DocumentStorePolicy policy);
+    DocumentStorePolicy documentStorePolicy() const { return documents.policy(); }
+
+    // Текст документа (не больше max_bytes от начала), если политика хранения его сохраняет
+    std::optional<std::string> getDocument(size_t doc_id, size_t max_bytes = SIZE_MAX) const;
+
+    // Таблица документов: путь, размер, время изменения, хеш, пользовательские поля
+    const DocumentTable& documentTable() const { return document_table; }
+
+    // Заменяет таблицу документов (например, собранную ExternalIndexBuilder
+    // для индекса из файла); пользовательские поля берутся из setDocumentFields
+    void setDocumentTable(DocumentTable table);
+
+    // Пользовательские поля документов: fields[i] — поля документа i.
+    // Применяются при следующем построении индекса.
+    void setDocumentFields(std::vector<DocumentFields> fields) {
+        document_fields = std::make_shared<const std::vector<DocumentFields>>(std::move(fields));
+    }
+
+    // Упорядоченный словарь всех слов индекса (префиксы, диапазоны, шаблоны)
+    const TermDictionary& terms() const { return term_dictionary; }
+
+    // Количество документов в индексе
+    size_t documentCount() const { return doc_count; }
+
+    // Включает хранение позиций слов (для фразовых запросов).
+    // Применяется при следующем построении индекса.
+    void setPositionalIndex(bool enabled) { positional = enabled; }
+    bool hasPositions() const { return positional; }
+
+    // Приведение слов к нижнему регистру (латиница). Применяется при
+    // следующем построении; слова запросов нормализуются так же.
+    void setLowercase(bool enabled) { tokenizer_options.lowercase = enabled; }
+    const TokenizerOptions& tokenizerOptions() const { return tokenizer_options; }
+
+    // Стоп-слова не индексируются и выбрасываются из запросов.
+    // Применяется при следующем построении.
+    void setStopWords(const std::vector<std::string>& words);
+
+    // Стемминг слов документов и запросов для языков (с кешем основ).
+    // Русский включает буквы UTF-8 в словах. Применяется при следующем построении.
+    void setStemming(const std::vector<StemLanguage>& languages);
+
+    // Отпечаток настроек разбора текста (регистр, стоп-слова, стемминг):
+    // индекс, сохранённый с другими настройками, использовать нельзя
+    uint64_t settingsFingerprint() const;
+
+    // Индекс пар: для terms самых частых слов заранее пересекаются списки
+    // каждой пары (частота документа — сумма частот слов). Запросы из
+    // частых слов берут готовый короткий список вместо пересечения длинных.
+    // 0 — выключен. Применяется при следующем построении; reindexDocuments
+    // обновляет списки пар, но набор частых слов не меняет.
+    void setPairIndexTerms(size_t terms) { pair_terms = terms; }
+
+    // Готовое пересечение списков слов a и b (nullptr, если пары нет в индексе)
+    const CompressedPostings* findPairPostings(const std::string& a, const std::string& b) const;
+
+    // Позиции слова; i-й список соответствует i-му элементу getWordCount(word).
+    // nullptr, если слова нет или позиции не хранятся.
+    const PositionList* getPositionList(const std::string& word) const;
 
 private:
-    std::mutex index_mutex;
-    std::unordered_map<std::string, std::vector<Entry>> BuildIndexForDocument(const std::string& document, size_t doc_id);
-    std::vector<std::string> documents;
-    std::unordered_map<std::string, std::vector<Entry>> freq_dictionary;
+    // Индекс одного документа до слияния
+    struct PartialIndex {
+        TermPostings postings;
+        std::unordered_map<std::string, std::string> positions;  // закодированные позиции
+    };
+
+    // Частые слова изменённого документа: номер в pair_words и частота в новом тексте
+    using FrequentCounts = std::vector<std::pair<uint32_t, TermCount>>;
+
+    PartialIndex BuildIndexForDocument(const std::string& document, size_t doc_id) const;
+    void BuildTermDictionary();
+    void BuildPairIndex();
+    void BuildForwardIndex();
+    // Постоянный номер слова в прямом индексе (новому слову выдаётся свободный)
+    uint32_t ForwardTermId(const std::string& word);
+    // Номер слова в pair_words (UINT32_MAX, если слово не из частых)
+    uint32_t PairWordId(const std::string& word) const;
+    // Обновляет списки пар affected (номера в pair_words): записи документов
+    // changed (по возрастанию) заменяются записями fresh (по возрастанию doc_id)
+    void UpdatePairIndex(const std::vector<size_t>& changed,
+                         const std::vector<std::pair<uint32_t, uint32_t>>& affected,
+                         const std::vector<std::pair<size_t, FrequentCounts>>& fresh);
+    DocumentStore documents;
+    DocumentTable document_table;
+    std::shared_ptr<const std::vector<DocumentFields>> document_fields =
+        std::make_shared<const std::vector<DocumentFields>>();
+    size_t doc_count = 0;
+    ShardedMap<CompressedTermPostings> freq_dictionary;
+    // Прямой индекс нужен только reindexDocuments (обновление по манифесту,
+    // наблюдение за файлами), поэтому построение и загрузка его не строят.
+    // Номера слов постоянны: номер в TermDictionary сдвигался бы при каждом
+    // добавлении слова.
+    struct ForwardIndex {
+        bool built = false;
+        // Номера слов документа (nullptr — слов нет)
+        ChunkedVector<std::shared_ptr<const TermIdList>, IndexAllocator<std::shared_ptr<const TermIdList>>> documents;
+        ShardedMap<TermIds> ids;                                       // слово → номер
+        ChunkedVector<IndexString, IndexAllocator<IndexString>> names;  // номер → слово ("" — номер свободен)
+        std::vector<uint32_t> free_ids;
+    };
+    ForwardIndex forward;
+    ShardedMap<TermPositions> position_dictionary;
+    TermDictionary term_dictionary;
+    ShardedMap<CompressedTermPostings> pair_dictionary;  // ключ — два слова по возрастанию через '\0'
+    std::vector<std::string> pair_words;  // частые слова индекса пар, по алфавиту
+    size_t pair_terms = 0;
+    bool positional = false;
+    TokenizerOptions tokenizer_options;
+    std::vector<StemLanguage> stem_languages;
+    size_t peak_build_bytes = 0;
 };
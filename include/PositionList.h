@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "CountingAllocator.h"
+
+// Кодирует возрастающие позиции слова в документе как varint-дельты
+void EncodePositions(const std::vector<uint32_t>& positions, std::string& out);
+
+// Сжатые списки позиций одного слова. i-й список соответствует
+// i-му элементу PostingList этого слова и декодируется независимо.
+class PositionList {
+public:
+    // Добавляет список, закодированный EncodePositions
+    void appendEncoded(const std::string& encoded);
+
+    // Количество списков (равно числу документов со словом)
+    size_t size() const { return ends_.size(); }
+
+    // Декодирует позиции для posting_index-го документа
+    std::vector<uint32_t> decode(size_t posting_index) const;
+
+    size_t memoryBytes() const {
+        return data_.capacity() + ends_.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    std::vector<uint8_t, IndexAllocator<uint8_t>> data_;
+    std::vector<uint32_t, IndexAllocator<uint32_t>> ends_;  // конец i-го списка в data_
+};
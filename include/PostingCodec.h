@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include "CountingAllocator.h"
+#include "CpuFeatures.h"
+#include "Entry.h"
+
+// Сжатый список вхождений слова. Вхождения хранятся блоками по kBlockSize:
+//   заголовок: последний doc_id блока, длина блока в байтах (по 4 байта)
+//   разности doc_id и частоты — каждые в формате StreamVByte: управляющие
+//   байты (2 бита на число — длина 1..4 байта), затем сами байты чисел.
+// Декодирование блока — перестановка байтов pshufb (AVX2) и векторная
+// префиксная сумма разностей (SSE2); без SIMD — скалярный код.
+//
+// Частые слова (вхождений не меньше 1/kBitmapDensity от диапазона doc_id и
+// не меньше kBitmapMinSize) хранятся битовой картой: бит на документ,
+// счётчик единиц на каждые 512 бит для ранга, частоты — отдельным
+// массивом чисел фиксированной ширины. Проверка документа и его частота —
+// O(1), пересечение двух карт — побитовое И по 64-битным словам.
+//
+// doc_id должны возрастать и помещаться в 32 бита.
+class CompressedPostings {
+public:
+    static constexpr size_t kBlockSize = 128;
+    static constexpr size_t kBitmapDensity = 8;
+    static constexpr size_t kBitmapMinSize = 32;
+
+    CompressedPostings() = default;
+    CompressedPostings(const DocId* doc_ids, const TermCount* counts, size_t count);
+
+    template <template <typename> class Allocator>
+    explicit CompressedPostings(const BasicPostings<Allocator>& postings)
+        : CompressedPostings(postings.doc_ids.data(), postings.counts.data(), postings.size()) {}
+
+    size_t size() const { return size_; }
+
+    bool isBitmap() const { return bitmap_; }
+
+    // Только для битовой карты: есть ли документ и его частота
+    bool lookup(size_t doc_id, uint32_t& count) const;
+
+    // Пересечение двух битовых карт: on_match(DocId, count_a, count_b)
+    // вызывается по возрастанию doc_id
+    template <typename F>
+    static void IntersectBitmaps(const CompressedPostings& a, const CompressedPostings& b, F&& on_match);
+
+    // Дописывает все вхождения в out
+    void decode(Postings& out) const;
+    void decode(Postings& out, SimdLevel level) const;
+
+    size_t memoryBytes() const { return data_.capacity(); }
+
+private:
+    // Разметка битовой карты в data_:
+    //   [число слов W: 4 байта][ширина частоты: 1 байт][3 байта выравнивания]
+    //   [W слов по 8 байт][ранги: по 4 байта на 8 слов][частоты, упакованные по битам]
+    static constexpr size_t kBitmapHeader = 8;
+    static constexpr size_t kRankWords = 8;
+
+    void encodeBitmap(const DocId* doc_ids, const TermCount* counts, size_t count);
+    void decodeBitmap(Postings& out) const;
+
+    size_t bitmapWords() const;
+    uint64_t bitmapWord(size_t i) const;
+    uint32_t countAt(size_t rank) const;
+    size_t rankBefore(size_t word, uint64_t bits_below) const;
+
+    std::vector<uint8_t, IndexAllocator<uint8_t>> data_;
+    uint32_t size_ = 0;
+    bool bitmap_ = false;
+};
+
+template <typename F>
+void CompressedPostings::IntersectBitmaps(const CompressedPostings& a, const CompressedPostings& b, F&& on_match) {
+    const size_t words = std::min(a.bitmapWords(), b.bitmapWords());
+    for (size_t w = 0; w < words; ++w) {
+        const uint64_t wa = a.bitmapWord(w);
+        const uint64_t wb = b.bitmapWord(w);
+        uint64_t both = wa & wb;
+        if (!both) continue;
+        const size_t rank_a = a.rankBefore(w, 0);
+        const size_t rank_b = b.rankBefore(w, 0);
+        for (; both; both &= both - 1) {
+            const int bit = std::countr_zero(both);
+            const uint64_t below = (uint64_t{1} << bit) - 1;
+            on_match(static_cast<DocId>(w * 64 + static_cast<size_t>(bit)),
+                     a.countAt(rank_a + static_cast<size_t>(std::popcount(wa & below))),
+                     b.countAt(rank_b + static_cast<size_t>(std::popcount(wb & below))));
+        }
+    }
+}
+
+// Кодирование и декодирование массива uint32 в StreamVByte (для тестов и кодека)
+void EncodeStreamVByte(const uint32_t* values, size_t count, std::vector<uint8_t>& out);
+// Возвращает указатель за последним прочитанным байтом; end — граница буфера
+const uint8_t* DecodeStreamVByte(const uint8_t* in, const uint8_t* end, size_t count, uint32_t* out,
+                                 SimdLevel level);
+
+// values[i] += base + values[0..i-1]
+void PrefixSum(uint32_t* values, size_t count, uint32_t base, SimdLevel level);
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Сравнение числового поля документа с числом (year>=2020)
+enum class FieldCompare { Less, LessEqual, Equal, GreaterEqual, Greater };
+
+// Узел плана выполнения запроса
+struct QueryNode {
+    enum class Type {
+        Term,    // одно слово
+        Phrase,  // слова подряд (или с расстоянием slop)
+        And,
+        Or,
+        Not,     // исключение; имеет смысл только внутри And
+        Wildcard,// шаблон со '*' и '?' (в т.ч. префикс: capit*)
+        Range,   // диапазон терминов [from TO to]
+        Fuzzy,   // слово с опечатками: milk~1 (slop — допустимое число правок)
+        Filter   // условие на числовое поле документа: year>=2020 (действует внутри И)
+    };
+
+    Type type = Type::Term;
+    std::vector<std::string> words;                  // Term: слово, Phrase: слова фразы,
+                                                     // Wildcard: шаблон, Range: {from, to},
+                                                     // Filter: имя поля
+    size_t slop = 0;                                 // Phrase: допустимое число слов между соседними,
+                                                     // Fuzzy: допустимое число правок
+    float weight = 1.0f;                             // Term: множитель релевантности
+    FieldCompare compare = FieldCompare::Equal;      // Filter: сравнение
+    double value = 0;                                // Filter: число, с которым сравнивается поле
+    std::vector<std::unique_ptr<QueryNode>> children;
+};
+
+using QueryNodePtr = std::unique_ptr<QueryNode>;
+
+// Порядок результатов: по числовому полю документа вместо релевантности
+struct SortOrder {
+    std::string field;  // пусто — по релевантности
+    bool descending = false;
+};
+
+// Разбор запросов:
+//   a b          — a И b (неявное И)
+//   a AND b      — то же явно
+//   a OR b       — a ИЛИ b
+//   NOT a, -a    — исключить документы с a
+//   +a           — обязательное слово (то же, что просто a)
+//   (a OR b) c   — группировка
+//   "a b", "a b"~N — фраза / близость (N больше 1000 считается равным 1000)
+//   capit*, ca?ital — шаблон, [apple TO banana] — диапазон слов
+//   milk~, milk~1  — слово с опечатками (до 2 правок, по умолчанию 2)
+//   year>=2020     — условие на числовое поле документа (<, <=, =, >=, >)
+//   sort:year, sort:-year — порядок по полю (по возрастанию / убыванию)
+// Разбор нестрогий: лишние скобки и операторы без операндов игнорируются,
+// незакрытые скобки и кавычки закрываются в конце запроса, скобки глубже
+// 64 уровней не группируют (их содержимое разбирается как без них).
+class QueryParser {
+public:
+    // Возвращает nullptr для пустого запроса
+    static QueryNodePtr Parse(const std::string& query);
+
+    // То же; порядок sort:поле из запроса записывается в sort
+    // (последний, если их несколько; без него sort не меняется)
+    static QueryNodePtr Parse(const std::string& query, SortOrder& sort);
+};
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "Entry.h"
+
+// Документ ответа и его релевантность относительно лучшего (8 байт)
 struct RelativeIndex {
-    size_t doc_id;
+    DocId doc_id;
     float rank;
 
     bool operator==(const RelativeIndex& other) const = default;
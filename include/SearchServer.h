@@ -1,18 +1,66 @@
 #pragma once
+#include <functional>
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 #include "RelativeIndex.h"
 #include "json.hpp"
+#include "IndexSnapshots.h"
 #include "InvertedIndex.h"
+#include "QueryParser.h"
+#include "Snippet.h"
+
+// Документ-кандидат с суммарной релевантностью
+struct ScoredDoc {
+    DocId doc_id;
+    float score;
+};
+
+// Список кандидатов; при выполнении плана упорядочен по возрастанию doc_id
+using ScoredDocs = std::vector<ScoredDoc>;
 
 class SearchServer {
 public:
-    explicit SearchServer(InvertedIndex& idx, int max_responses = 5)
-        : _index(idx), _max_responses(max_responses) {}
+    // Поиск по индексу, которым владеет вызывающий; перестраивать его
+    // во время поиска нельзя
+    explicit SearchServer(InvertedIndex& idx, int max_responses = 5);
 
-    // Поиск по запросам
+    // Поиск по опубликованным версиям: каждый пакет запросов закрепляет
+    // текущую версию, поэтому индекс можно перестраивать во время поиска
+    explicit SearchServer(std::shared_ptr<IndexSnapshots> snapshots, int max_responses = 5);
+
+    // Поиск по запросам (синтаксис см. QueryParser). Слова без операторов
+    // объединяются по И. "слово1 слово2" — фраза (требует позиционного индекса),
+    // "слово1 слово2"~N — слова по порядку, между соседними не более N других слов.
+    // year>=2020 оставляет документы с подходящим полем, sort:-year упорядочивает
+    // ответ по полю (ранг по-прежнему — релевантность относительно лучшей в ответе).
     std::vector<std::vector<RelativeIndex>> search(const std::vector<std::string>& queries_input);
 
+    // Лучшие max_responses документов запроса с абсолютной релевантностью
+    // (без нормализации), по убыванию релевантности, при равенстве — по doc_id
+    ScoredDocs searchScored(const std::string& query) const;
+
+    // Фрагменты документов ответа с подсвеченными словами запроса.
+    // Строятся только для переданных документов (итогового top-K) по
+    // текстам из хранилища документов; без хранилища фрагменты пустые.
+    std::vector<Snippet> snippets(const std::string& query, const std::vector<RelativeIndex>& top,
+                                  const SnippetOptions& limits = {}) const;
+
+    // Сведения о документах ответа из таблицы документов индекса
+    std::vector<DocumentInfo> documents(const std::vector<RelativeIndex>& top) const;
+
+    // Упорядочивает docs по убыванию релевантности и оставляет k первых
+    static void SelectTop(ScoredDocs& docs, size_t k);
+
+    // Упорядочивает docs по значению поля value(doc_id) (NaN — значения нет,
+    // такие документы в конце), при равенстве — по релевантности; оставляет k первых
+    static void SelectTopByField(ScoredDocs& docs, size_t k, const std::function<double(DocId)>& value,
+                                 bool descending);
+
+    // Нормализует список: rank = релевантность / максимальная в списке
+    static std::vector<RelativeIndex> Normalize(const ScoredDocs& top);
+
     // Сохранение результатов в JSON
     void saveAnswers(const std::string& filename,
                  const std::vector<std::string>& queries,
@@ -21,7 +69,52 @@ public:
     // Установка максимального числа ответов (если нужно изменить после создания)
     void setMaxResponses(int max_responses);
 
+    // Нечёткий режим: каждое слово запроса раскрывается в слова словаря на
+    // расстоянии Левенштейна до max_edits (0 — выключено, не больше 2).
+    // Вклад найденного слова умножается на penalty за каждую правку.
+    void setFuzzy(size_t max_edits, float penalty = 0.5f);
+
+    // Ограничение на число слов, в которое раскрывается шаблон или диапазон
+    void setMaxExpansions(size_t max_expansions);
+
 private:
-    InvertedIndex& _index;
+    ScoredDocs searchScored(const InvertedIndex& index, const std::string& query) const;
+
+    // Пропускает слова плана через фильтры индекса (стоп-слова, стемминг);
+    // true, если от узла ничего не осталось
+    bool FilterWords(const InvertedIndex& index, QueryNode& node) const;
+
+    // Заменяет узлы Wildcard/Range/Fuzzy на ИЛИ по словам из словаря
+    void ExpandPlan(const InvertedIndex& index, QueryNode& node) const;
+
+    // Слова плана, которые ищутся в документах (кроме исключённых через NOT)
+    static void CollectTerms(const QueryNode& node, std::unordered_set<std::string>& terms);
+
+    // Оценка стоимости узла: ожидаемое число документов
+    size_t EstimateCost(const InvertedIndex& index, const QueryNode& node) const;
+
+    ScoredDocs Evaluate(const InvertedIndex& index, const QueryNode& node) const;
+    ScoredDocs EvaluateTerm(const InvertedIndex& index, const std::string& word, float weight = 1.0f) const;
+    ScoredDocs EvaluateWords(const InvertedIndex& index, const std::vector<std::string>& words) const;
+    ScoredDocs EvaluateAnd(const InvertedIndex& index, const QueryNode& node) const;
+
+    // Оставляет из docs документы со словом: для битовой карты — проверкой
+    // битов, без декодирования списка
+    ScoredDocs IntersectTerm(const InvertedIndex& index, const ScoredDocs& docs,
+                             const std::string& word, float weight) const;
+
+    // Пересечение двух слов: готовое из индекса пар, если оно там есть;
+    // две битовые карты пересекаются пословным И
+    ScoredDocs IntersectTerms(const InvertedIndex& index, const std::string& a, float weight_a,
+                              const std::string& b, float weight_b) const;
+
+    // Оставляет документы, в которых слова фразы стоят рядом
+    void FilterByPhrase(const InvertedIndex& index, const std::vector<std::string>& phrase, size_t slop,
+                        ScoredDocs& docs) const;
+
+    std::shared_ptr<IndexSnapshots> _snapshots;
     int _max_responses;
+    size_t _max_expansions = 64;
+    size_t _fuzzy_edits = 0;
+    float _fuzzy_penalty = 0.5f;
 };
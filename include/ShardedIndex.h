@@ -0,0 +1,51 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "InvertedIndex.h"
+
+// Индекс, разбитый на независимые шарды по документам.
+// Документ i попадает в шард i % N; внутри шарда у него локальный номер.
+class ShardedIndex {
+public:
+    explicit ShardedIndex(size_t shard_count);
+
+    // Распределяет документы по шардам и строит их параллельно
+    void updateDocumentBaseFromStrings(const std::vector<std::string>& docs_input,
+                                       const std::vector<std::string>& source_paths = {});
+
+    // Настройки, применяемые к каждому шарду при следующем построении
+    void setPositionalIndex(bool enabled);
+    void setDocumentStorePolicy(DocumentStorePolicy policy);
+    void setLowercase(bool enabled);
+    void setStopWords(const std::vector<std::string>& words);
+    void setStemming(const std::vector<StemLanguage>& languages);
+    void setPairIndexTerms(size_t terms);
+    // fields[i] — поля документа с глобальным номером i
+    void setDocumentFields(const std::vector<DocumentFields>& fields);
+
+    size_t shardCount() const { return shards.size(); }
+    InvertedIndex& shard(size_t i) { return *shards[i]; }
+    const InvertedIndex& shard(size_t i) const { return *shards[i]; }
+
+    // Глобальный номер документа по номеру шарда и локальному номеру
+    size_t globalDocId(size_t shard_id, size_t local_id) const {
+        return local_to_global[shard_id][local_id];
+    }
+
+    // Шард и локальный номер по глобальному номеру документа
+    std::pair<size_t, size_t> locate(size_t doc_id) const {
+        return {doc_id % shards.size(), doc_id / shards.size()};
+    }
+
+    size_t documentCount() const { return doc_count; }
+
+    // Суммарная память всех шардов
+    IndexMemoryUsage memoryUsage() const;
+
+private:
+    std::vector<std::unique_ptr<InvertedIndex>> shards;
+    std::vector<std::vector<size_t>> local_to_global;
+    size_t doc_count = 0;
+};
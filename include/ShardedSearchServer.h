@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "RelativeIndex.h"
+#include "SearchServer.h"
+#include "ShardedIndex.h"
+#include "ThreadPool.h"
+
+// Поиск по шардированному индексу: запросы рассылаются всем шардам
+// параллельно, лучшие результаты шардов сливаются в общий top-K.
+// Релевантность в шардах абсолютная (сумма вхождений), поэтому после
+// слияния нормализация даёт те же ранги, что и на едином индексе.
+class ShardedSearchServer {
+public:
+    explicit ShardedSearchServer(ShardedIndex& index, int max_responses = 5);
+
+    std::vector<std::vector<RelativeIndex>> search(const std::vector<std::string>& queries_input);
+
+    // Фрагменты документов ответа (см. SearchServer::snippets)
+    std::vector<Snippet> snippets(const std::string& query, const std::vector<RelativeIndex>& top,
+                                  const SnippetOptions& limits = {}) const;
+
+    // Сведения о документах ответа (см. SearchServer::documents)
+    std::vector<DocumentInfo> documents(const std::vector<RelativeIndex>& top) const;
+
+    void setMaxResponses(int max_responses);
+    void setFuzzy(size_t max_edits, float penalty = 0.5f);
+    void setMaxExpansions(size_t max_expansions);
+
+private:
+    ShardedIndex& _index;
+    std::vector<SearchServer> _servers;
+    int _max_responses;
+    ThreadPool _pool;
+};
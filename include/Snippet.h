@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "Tokenizer.h"
+
+// Фрагмент документа с найденными словами
+struct Snippet {
+    std::string text;
+    // Подсвеченные слова: (смещение в байтах от начала text, длина в байтах)
+    std::vector<std::pair<uint32_t, uint32_t>> highlights;
+
+    bool operator==(const Snippet& other) const = default;
+};
+
+// Ограничения на построение фрагмента
+struct SnippetOptions {
+    size_t window_words = 30;         // длина фрагмента в словах
+    size_t max_scan_bytes = 1 << 20;  // просматривается не больше этого начала документа
+};
+
+// Выбирает окно из window_words слов текста, в котором больше всего разных
+// слов запроса (при равенстве — больше всего вхождений, затем самое раннее).
+// Слова текста нормализуются так же, как при индексации (options), и
+// сравниваются с уже нормализованными terms.
+Snippet MakeSnippet(const std::string& text, const std::unordered_set<std::string>& terms,
+                    const TokenizerOptions& options, const SnippetOptions& limits = {});
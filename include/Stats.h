@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+// Атомарный счётчик событий
+class StatCounter {
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+    void reset() { value_.store(0, std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// Гистограмма длительностей в наносекундах.
+// Лог-линейные корзины: 16 подкорзин на каждую степень двойки (погрешность перцентилей ~6%).
+class LatencyHistogram {
+public:
+    void record(uint64_t ns);
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+    // Значение перцентиля p (0..1), верхняя граница соответствующей корзины
+    uint64_t percentile(double p) const;
+
+    void reset();
+
+private:
+    static constexpr int kSubBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBits;
+    static constexpr int kBuckets = 64 * kSubBuckets;
+
+    static int BucketIndex(uint64_t value);
+    static uint64_t BucketUpperBound(int index);
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+// Глобальный реестр счётчиков и таймеров
+class Stats {
+public:
+    static Stats& Instance();
+
+    // Возвращают объект по имени, создавая его при первом обращении.
+    // Ссылки остаются валидными до конца работы программы.
+    StatCounter& counter(const std::string& name);
+    LatencyHistogram& histogram(const std::string& name);
+
+    // Снимок всех метрик в JSON
+    std::string DumpJSON() const;
+
+    // Сохраняет снимок метрик в файл
+    bool SaveJSON(const std::string& filename) const;
+
+    // Обнуляет все метрики (сами объекты не удаляются)
+    void Reset();
+
+private:
+    Stats() = default;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<StatCounter>> counters_;
+    std::map<std::string, std::unique_ptr<LatencyHistogram>> histograms_;
+};
+
+// Замеряет время жизни объекта и записывает его в гистограмму
+class ScopedTimer {
+public:
+    explicit ScopedTimer(LatencyHistogram& histogram)
+        : histogram_(histogram), start_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedTimer() {
+        auto elapsed = std::chrono::steady_clock::now() - start_;
+        histogram_.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    LatencyHistogram& histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Макросы инструментирования. При сборке без SEARCH_ENGINE_STATS
+// полностью исчезают вместе с вычислением аргументов.
+#ifdef SEARCH_ENGINE_STATS
+#define SE_STATS_CONCAT_IMPL(a, b) a##b
+#define SE_STATS_CONCAT(a, b) SE_STATS_CONCAT_IMPL(a, b)
+
+#define SE_SCOPED_TIMER(name)                                                          \
+    static LatencyHistogram& SE_STATS_CONCAT(se_histogram_, __LINE__) =               \
+        Stats::Instance().histogram(name);                                             \
+    ScopedTimer SE_STATS_CONCAT(se_timer_, __LINE__)(SE_STATS_CONCAT(se_histogram_, __LINE__))
+
+#define SE_COUNTER_ADD(name, n)                                                        \
+    do {                                                                               \
+        static StatCounter& se_counter_ = Stats::Instance().counter(name);             \
+        se_counter_.add(static_cast<uint64_t>(n));                                     \
+    } while (0)
+#else
+#define SE_SCOPED_TIMER(name) ((void)0)
+#define SE_COUNTER_ADD(name, n) ((void)0)
+#endif
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+enum class StemLanguage {
+    English,  // Snowball English (Porter2)
+    Russian   // Snowball Russian
+};
+
+// Разбирает название языка из конфига ("english", "russian")
+std::optional<StemLanguage> ParseStemLanguage(const std::string& name);
+
+// Основа английского слова по алгоритму Porter2. Слово из латинских букв
+// приводится к нижнему регистру; слова с другими символами не меняются.
+void StemEnglish(std::string& word);
+
+// Основа русского слова (UTF-8) по алгоритму Snowball. Слово из кириллицы
+// приводится к нижнему регистру, «ё» заменяется на «е»; слова с другими
+// символами не меняются.
+void StemRussian(std::string& word);
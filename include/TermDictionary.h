@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Упорядоченный словарь терминов со сжатием префиксов (front coding).
+// Термины хранятся блоками по kBlockSize: первый целиком, остальные как
+// (длина общего с предыдущим префикса, суффикс). Поиск блока — двоичный
+// по первым терминам, внутри блока — последовательное декодирование.
+// Блоки собраны в неизменяемые страницы около kPageSize терминов, общие у
+// копий словаря: update перекодирует только страницы с изменениями.
+class TermDictionary {
+public:
+    static constexpr size_t kBlockSize = 16;
+    static constexpr size_t kPageSize = 1024;
+
+    // Последовательный обход терминов в лексикографическом порядке
+    class Iterator {
+    public:
+        bool valid() const { return page_ < dict_->pages_.size(); }
+        const std::string& term() const { return term_; }
+        void next();
+
+    private:
+        friend class TermDictionary;
+        Iterator(const TermDictionary* dict, size_t page, size_t block);
+
+        void decodeCurrent();
+
+        const TermDictionary* dict_;
+        size_t page_;    // номер текущей страницы
+        size_t index_;   // номер текущего термина на странице
+        size_t offset_;  // позиция следующей записи в данных страницы
+        std::string term_;
+    };
+
+    // Строит словарь; термины сортируются и избавляются от повторов
+    void build(std::vector<std::string> terms);
+
+    // Добавляет термины added и удаляет removed; страницы без изменений
+    // остаются общими с копиями словаря
+    void update(std::vector<std::string> added, std::vector<std::string> removed);
+
+    void clear();
+
+    size_t size() const { return size_; }
+
+    bool contains(const std::string& term) const;
+
+    // Итератор на первый термин >= lower
+    Iterator seek(const std::string& lower) const;
+    Iterator begin() const { return Iterator(this, 0, 0); }
+
+    // Термины с данным префиксом (не более limit)
+    std::vector<std::string> expandPrefix(const std::string& prefix, size_t limit) const;
+
+    // Термины из диапазона [from, to] (не более limit)
+    std::vector<std::string> expandRange(const std::string& from, const std::string& to,
+                                         size_t limit) const;
+
+    // Термины по шаблону с '*' (любая последовательность) и '?' (один символ), не более limit
+    std::vector<std::string> expandWildcard(const std::string& pattern, size_t limit) const;
+
+    // Термины на расстоянии Левенштейна (в символах UTF-8) не больше max_edits от word.
+    // Автомат Левенштейна (строки динамики по префиксу) обходится вместе со
+    // словарём: общие префиксы соседних терминов не пересчитываются, а ветки,
+    // где расстояние уже превысило max_edits, пропускаются через seek.
+    // Возвращает пары (термин, расстояние), ближайшие первыми, не более limit.
+    std::vector<std::pair<std::string, uint32_t>> expandFuzzy(const std::string& word,
+                                                              uint32_t max_edits,
+                                                              size_t limit) const;
+
+    size_t memoryBytes() const;
+
+private:
+    struct Page {
+        std::string data;
+        std::vector<uint32_t> block_offsets;
+        size_t size = 0;  // число терминов
+    };
+
+    // Кодирует термины [begin, end) отсортированного массива в страницу
+    static std::shared_ptr<const Page> EncodePage(const std::vector<std::string>& terms, size_t begin, size_t end);
+
+    std::string blockFirstTerm(size_t page, size_t block) const;
+    std::vector<std::string> pageTerms(size_t page) const;
+
+    std::vector<std::shared_ptr<const Page>> pages_;
+    size_t size_ = 0;
+};
+
+// Проверяет соответствие строки шаблону с '*' и '?'; '?' — один символ UTF-8
+bool WildcardMatch(const std::string& pattern, const std::string& text);
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Stemmer.h"
+
+// Этап обработки слова после токенизатора: изменяет слово на месте,
+// false — слово выбрасывается. Фильтры вызываются из нескольких потоков.
+class TokenFilter {
+public:
+    virtual ~TokenFilter() = default;
+    virtual bool apply(std::string& word) const = 0;
+};
+
+// Приведение слова к основе (StemEnglish / StemRussian)
+class StemFilter : public TokenFilter {
+public:
+    explicit StemFilter(StemLanguage language) : language_(language) {}
+    bool apply(std::string& word) const override;
+
+private:
+    StemLanguage language_;
+};
+
+// Запоминает результаты вложенного фильтра: повторяющиеся слова не
+// обрабатываются заново. Таблица разбита на сегменты со своими мьютексами;
+// заполненный сегмент очищается целиком.
+class CachedTokenFilter : public TokenFilter {
+public:
+    explicit CachedTokenFilter(std::shared_ptr<const TokenFilter> inner, size_t capacity = 1 << 16);
+    bool apply(std::string& word) const override;
+
+private:
+    static constexpr size_t kSegments = 16;
+
+    struct Segment {
+        std::mutex mutex;
+        std::unordered_map<std::string, std::pair<bool, std::string>> results;
+    };
+
+    std::shared_ptr<const TokenFilter> inner_;
+    size_t segment_capacity_;
+    mutable std::array<Segment, kSegments> segments_;
+};
+
+// Последовательность фильтров; слово проходит их по порядку
+class TokenFilterPipeline {
+public:
+    void add(std::shared_ptr<const TokenFilter> filter) { filters_.push_back(std::move(filter)); }
+    bool empty() const { return filters_.empty(); }
+
+    bool apply(std::string& word) const {
+        for (const auto& filter : filters_) {
+            if (!filter->apply(word)) return false;
+        }
+        return true;
+    }
+
+private:
+    std::vector<std::shared_ptr<const TokenFilter>> filters_;
+};
+
+// Конвейер стеммеров для языков (каждый — с кешем результатов)
+std::shared_ptr<const TokenFilterPipeline> MakeStemmingPipeline(const std::vector<StemLanguage>& languages);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "CpuFeatures.h"
+#include "TokenFilter.h"
+
+using StopWordSet = std::unordered_set<std::string>;
+
+// Настройки разбора текста на слова
+struct TokenizerOptions {
+    bool lowercase = false;     // приводить латинские буквы к нижнему регистру
+    bool utf8_letters = false;  // оставлять в словах буквы UTF-8 (кириллица, греческий, латиница с диакритикой)
+    // Стоп-слова: не попадают в результат. Сравниваются со словом после
+    // приведения регистра. Набор общий для копий настроек.
+    std::shared_ptr<const StopWordSet> stop_words;
+
+    // Фильтры (стемминг), применяемые к словам после проверки стоп-слов
+    std::shared_ptr<const TokenFilterPipeline> filters;
+
+    bool isStopWord(const std::string& word) const {
+        return stop_words && stop_words->count(word) > 0;
+    }
+
+    // Проверка стоп-слов и фильтры; false — слово выбрасывается
+    bool filter(std::string& word) const {
+        return !isStopWord(word) && (!filters || filters->apply(word));
+    }
+};
+
+// Разбивает текст на слова индекса: текст делится по пробельным символам,
+// из слова удаляются символы кроме букв и цифр; остаётся только слово из
+// латинских букв (с utf8_letters — и букв UTF-8) длиной от 1 до 100 байт.
+// Байты классифицируются блоками по 64 векторными инструкциями (SSE2/AVX2,
+// выбор по процессору), без обращения к locale.
+std::vector<std::string> Tokenize(const std::string& text, const TokenizerOptions& options = {});
+
+// То же с явно заданным уровнем инструкций (для тестов и сравнения)
+std::vector<std::string> Tokenize(const std::string& text, const TokenizerOptions& options, SimdLevel level);
+
+// Приводит латинские буквы к нижнему регистру на месте
+void AsciiLowercase(std::string& text);
+void AsciiLowercase(std::string& text, SimdLevel level);
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "DocumentLoader.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Чтение множества файлов через io_uring (Linux, сборка с SEARCH_ENGINE_IO_URING).
+// Открытие, чтение и закрытие файлов ставятся в кольцо пакетами: одновременно
+// обрабатывается до queue_depth файлов, каждый читается блоками в свой
+// зарегистрированный буфер (READ_FIXED). Системный вызов нужен один на пакет
+// операций, а не по несколько на файл. Буферы выровнены по странице; с direct
+// файлы открываются с O_DIRECT (размер буфера округляется до kAlignment).
+// Если кольцо создать не удалось, ok() == false и нужно читать обычным способом.
+class UringReader {
+public:
+    // mtime — время изменения файла (секунды Unix) из fstat сразу после открытия
+    using FileHandler = std::function<void(size_t index, std::string& text, int64_t mtime)>;
+    using ErrorHandler = std::function<void(size_t index, const std::string& error)>;
+
+    explicit UringReader(size_t queue_depth = 32, size_t buffer_size = size_t{64} << 10, bool direct = false);
+    ~UringReader();
+
+    UringReader(const UringReader&) = delete;
+    UringReader& operator=(const UringReader&) = delete;
+
+    bool ok() const { return ring_fd_ >= 0; }
+
+    // Читает файлы paths[i] для i, выдаваемых счётчиком next_path (его можно
+    // разделять между несколькими читателями). on_file вызывается для каждого
+    // прочитанного файла, on_error — для файлов, которые прочитать не удалось.
+    void run(const std::vector<std::string>& paths, std::atomic<size_t>& next_path,
+             const FileHandler& on_file, const ErrorHandler& on_error);
+
+private:
+    struct Ring;
+
+    void closeRing();
+
+    int ring_fd_ = -1;
+    Ring* ring_ = nullptr;
+    size_t depth_;
+    size_t buffer_size_;
+    bool direct_;
+    AlignedBuffer buffers_;      // depth_ буферов по buffer_size_ байт
+    bool fixed_buffers_ = false; // буферы зарегистрированы в ядре
+};
@@ -1,5 +1,5 @@
 #include "ConfigManager.h"
-#include "json.hpp"
+#include "ConfigReader.h"
 #include <fstream>
 #include <exception>
 
@@ -8,28 +8,29 @@ using json = nlohmann::json;
 const std::string APP_VERSION = "1.0";
 
 std::optional<ConfigData> ConfigManager::LoadConfig(const std::string& filename, std::string& error) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        error = "config file is missing";
-        return std::nullopt;
-    }
-
-    json j;
-    try {
-        file >> j;
-    } catch (const std::exception& e) {
-        error = std::string("config file is invalid JSON: ") + e.what();
-        return std::nullopt;
+    ConfigDocument document;
+    switch (ReadConfigDocument(filename, document, error)) {
+        case ConfigReadStatus::Ok:
+            break;
+        case ConfigReadStatus::NotFound:
+            error = "config file is missing";
+            return std::nullopt;
+        case ConfigReadStatus::ParseError:
+            error = "config file is invalid JSON: " + error;
+            return std::nullopt;
+        case ConfigReadStatus::InvalidStructure:
+            error = "config file has invalid structure: " + error;
+            return std::nullopt;
     }
 
-    if (!j.contains("config")) {
+    if (document.config.is_null()) {
         error = "config file is empty";
         return std::nullopt;
     }
 
     ConfigData data;
     try {
-        auto& cfg = j["config"];
+        const json& cfg = document.config;
         data.config.name = cfg.at("name").get<std::string>();
         data.config.version = cfg.at("version").get<std::string>();
         if (cfg.contains("max_responses")) {
@@ -41,17 +42,23 @@ std::optional<ConfigData> ConfigManager::LoadConfig(const std::string& filename,
             error = "config.json has incorrect file version";
             return std::nullopt;
         }
-
-        if (!j.contains("files") || !j["files"].is_array()) {
-            error = "config file missing or invalid 'files' array";
-            return std::nullopt;
-        }
-        data.files = j.at("files").get<std::vector<std::string>>();
     } catch (const std::exception& e) {
         error = std::string("config file has invalid structure: ") + e.what();
         return std::nullopt;
     }
 
+    if (!document.has_files) {
+        error = "config file missing or invalid 'files' array";
+        return std::nullopt;
+    }
+    // Элемент files — путь или объект {"path": ..., "fields": {...}}
+    for (auto& file : document.files) {
+        if (!file.valid) {
+            error = "config file has invalid structure: 'files' entries must be strings or objects";
+            return std::nullopt;
+        }
+        data.files.push_back(std::move(file.path));
+    }
     return data;
 }
 
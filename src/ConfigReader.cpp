@@ -0,0 +1,190 @@
+#include "ConfigReader.h"
+#include "DocumentLoader.h"
+#include "Stats.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// Обработчик событий разбора: строки files и requests забираются сразу,
+// значение config и объекты files собираются в дерево, прочее пропускается
+class ConfigSaxHandler : public json::json_sax_t {
+public:
+    explicit ConfigSaxHandler(ConfigDocument& document) : document_(document) {}
+
+    bool null() override { return value(json()); }
+    bool boolean(bool val) override { return value(json(val)); }
+    bool number_integer(number_integer_t val) override { return value(json(val)); }
+    bool number_unsigned(number_unsigned_t val) override { return value(json(val)); }
+    bool number_float(number_float_t val, const string_t&) override { return value(json(val)); }
+    bool binary(binary_t&) override { return value(json()); }
+
+    bool string(string_t& val) override {
+        if (stack_.empty() && depth_ == 2 && section_ == Section::Requests) {
+            document_.requests.push_back(std::move(val));
+            return true;
+        }
+        if (stack_.empty() && depth_ == 2 && section_ == Section::Files) {
+            ConfigFileEntry entry;
+            entry.path = std::move(val);
+            document_.files.push_back(std::move(entry));
+            return true;
+        }
+        return value(json(std::move(val)));
+    }
+
+    bool start_object(std::size_t) override { return start(json::object()); }
+    bool start_array(std::size_t) override { return start(json::array()); }
+    bool end_object() override { return end(); }
+    bool end_array() override { return end(); }
+
+    bool key(string_t& val) override {
+        if (!stack_.empty()) {
+            key_ = std::move(val);
+        } else if (depth_ == 1) {
+            member_ = std::move(val);
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        status_ = ConfigReadStatus::ParseError;
+        error_ = ex.what();
+        return false;
+    }
+
+    ConfigReadStatus status() const { return status_; }
+    const std::string& error() const { return error_; }
+
+private:
+    enum class Section { None, Files, Requests };
+
+    // Значение ключа верхнего уровня собирается в дерево только для config
+    bool captureMember() const { return depth_ == 1 && member_ == "config"; }
+    // Элемент массива files или requests, который не строка
+    bool captureElement() const { return depth_ == 2 && section_ != Section::None; }
+
+    bool value(json&& val) {
+        if (!stack_.empty()) {
+            insert(std::move(val));
+        } else if (captureMember()) {
+            document_.config = std::move(val);
+        } else if (captureElement()) {
+            finishElement(std::move(val));
+        }
+        return status_ == ConfigReadStatus::Ok;
+    }
+
+    bool start(json&& container) {
+        if (!stack_.empty()) {
+            stack_.push_back(insert(std::move(container)));
+        } else if (depth_ == 1 && container.is_array() && (member_ == "files" || member_ == "requests")) {
+            section_ = member_ == "files" ? Section::Files : Section::Requests;
+            if (section_ == Section::Files) {
+                document_.has_files = true;
+                document_.files.clear();
+            } else {
+                document_.has_requests = true;
+                document_.requests.clear();
+                document_.skipped_requests = 0;
+            }
+        } else if (captureMember() || captureElement()) {
+            captured_ = std::move(container);
+            stack_.push_back(&captured_);
+        }
+        ++depth_;
+        return true;
+    }
+
+    bool end() {
+        --depth_;
+        if (!stack_.empty()) {
+            stack_.pop_back();
+            if (stack_.empty()) {
+                if (captureMember()) {
+                    document_.config = std::move(captured_);
+                } else {
+                    finishElement(std::move(captured_));
+                }
+            }
+        } else if (depth_ == 1) {
+            section_ = Section::None;
+        }
+        return status_ == ConfigReadStatus::Ok;
+    }
+
+    // Добавляет значение в собираемое дерево и возвращает указатель на него.
+    // Указатели на открытые контейнеры остаются верными: в контейнер, у
+    // которого открыт вложенный, ничего не добавляется.
+    json* insert(json&& val) {
+        json& parent = *stack_.back();
+        if (parent.is_array()) {
+            parent.push_back(std::move(val));
+            return &parent.back();
+        }
+        json& slot = parent[key_];
+        slot = std::move(val);
+        return &slot;
+    }
+
+    void finishElement(json&& element) {
+        if (section_ == Section::Requests) {
+            ++document_.skipped_requests;
+            return;
+        }
+        ConfigFileEntry entry;
+        if (!element.is_object()) {
+            entry.valid = false;
+        } else {
+            auto path = element.find("path");
+            if (path == element.end() || !path->is_string()) {
+                fail("Config 'files' object must have a string 'path'");
+                return;
+            }
+            entry.path = path->get<std::string>();
+            auto fields = element.find("fields");
+            if (fields != element.end()) {
+                if (!fields->is_object()) {
+                    fail("Config 'fields' of a file must be an object");
+                    return;
+                }
+                entry.fields = std::move(*fields);
+            }
+        }
+        document_.files.push_back(std::move(entry));
+    }
+
+    void fail(const std::string& message) {
+        status_ = ConfigReadStatus::InvalidStructure;
+        error_ = message;
+    }
+
+    ConfigDocument& document_;
+    ConfigReadStatus status_ = ConfigReadStatus::Ok;
+    std::string error_;
+    size_t depth_ = 0;         // число открытых контейнеров
+    std::string member_;       // текущий ключ верхнего уровня
+    Section section_ = Section::None;
+    json captured_;            // собираемое дерево
+    std::vector<json*> stack_; // открытые контейнеры собираемого дерева
+    std::string key_;          // текущий ключ в собираемом дереве
+};
+
+} // namespace
+
+ConfigReadStatus ReadConfigDocument(const std::string& filename, ConfigDocument& document, std::string& error) {
+    SE_SCOPED_TIMER("config_read");
+    std::string text;
+    if (!ReadWholeFile(filename, text, error)) return ConfigReadStatus::NotFound;
+
+    ConfigDocument parsed;
+    ConfigSaxHandler handler(parsed);
+    // Как и operator>>: текст после значения верхнего уровня не проверяется
+    json::sax_parse(text, &handler, json::input_format_t::json, false);
+    if (handler.status() != ConfigReadStatus::Ok) {
+        error = handler.error();
+        return handler.status();
+    }
+    document = std::move(parsed);
+    return ConfigReadStatus::Ok;
+}
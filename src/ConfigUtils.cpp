@@ -1,22 +1,195 @@
 #include "../include/ConfigUtils.h"
+#include "../include/ConfigReader.h"
+#include "../include/CpuFeatures.h"
 #include "../external/json.hpp"
 #include <cwctype>
-#include <codecvt>
 #include <locale>
 #include <fstream>
 #include <iostream>
 #include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define SE_X86_KERNELS
+#if defined(__GNUC__) || defined(__clang__)
+#define SE_AVX2_KERNELS
+#define SE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
 
 using json = nlohmann::json;
 
+namespace {
+
+size_t AsciiPrefixScalar(const unsigned char* p, size_t n) {
+    size_t i = 0;
+    while (i < n && p[i] < 0x80) ++i;
+    return i;
+}
+
+#ifdef SE_X86_KERNELS
+
+size_t AsciiPrefixSse2(const unsigned char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+        if (mask != 0) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    return i + AsciiPrefixScalar(p + i, n - i);
+}
+
+#endif
+
+#ifdef SE_AVX2_KERNELS
+
+SE_TARGET_AVX2 size_t AsciiPrefixAvx2(const unsigned char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        int mask = _mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+        if (mask != 0) return i + static_cast<size_t>(std::countr_zero(static_cast<unsigned>(mask)));
+    }
+    return i + AsciiPrefixScalar(p + i, n - i);
+}
+
+#endif
+
+using AsciiPrefixFn = size_t (*)(const unsigned char*, size_t);
+
+AsciiPrefixFn SelectAsciiPrefix() {
+    const SimdLevel level = DetectSimdLevel();
+#ifdef SE_AVX2_KERNELS
+    if (level == SimdLevel::Avx2) return AsciiPrefixAvx2;
+#endif
+#ifdef SE_X86_KERNELS
+    if (level != SimdLevel::Scalar) return AsciiPrefixSse2;
+#endif
+    (void)level;
+    return AsciiPrefixScalar;
+}
+
+size_t AsciiPrefix(const unsigned char* p, size_t n) {
+    static const AsciiPrefixFn prefix = SelectAsciiPrefix();
+    return prefix(p, n);
+}
+
+// Разбирает символ из байтов p[0..n) (p[0] >= 0x80). Возвращает длину
+// последовательности или 0, если она некорректна (таблица 3-7 стандарта Unicode)
+size_t DecodeUtf8(const unsigned char* p, size_t n, char32_t& code) {
+    const unsigned char b0 = p[0];
+    size_t length;
+    unsigned char lo = 0x80, hi = 0xBF;  // допустимый диапазон второго байта
+    if (b0 >= 0xC2 && b0 <= 0xDF) {
+        length = 2;
+        code = b0 & 0x1F;
+    } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+        length = 3;
+        code = b0 & 0x0F;
+        if (b0 == 0xE0) lo = 0xA0;  // избыточная форма
+        if (b0 == 0xED) hi = 0x9F;  // суррогаты
+    } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+        length = 4;
+        code = b0 & 0x07;
+        if (b0 == 0xF0) lo = 0x90;  // избыточная форма
+        if (b0 == 0xF4) hi = 0x8F;  // больше U+10FFFF
+    } else {
+        return 0;
+    }
+    if (n < length || p[1] < lo || p[1] > hi) return 0;
+    for (size_t k = 1; k < length; ++k) {
+        if ((p[k] & 0xC0) != 0x80) return 0;
+        code = (code << 6) | (p[k] & 0x3F);
+    }
+    return length;
+}
+
+void EncodeUtf8(char32_t code, std::string& out) {
+    if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    }
+    out += static_cast<char>(0x80 | (code & 0x3F));
+}
+
+} // namespace
+
+size_t utf8_ascii_prefix(std::string_view text) {
+    return AsciiPrefix(reinterpret_cast<const unsigned char*>(text.data()), text.size());
+}
+
+bool is_valid_utf8(std::string_view text) {
+    const auto* p = reinterpret_cast<const unsigned char*>(text.data());
+    const size_t n = text.size();
+    for (size_t i = AsciiPrefix(p, n); i < n; i += AsciiPrefix(p + i, n - i)) {
+        char32_t code;
+        size_t length = DecodeUtf8(p + i, n - i, code);
+        if (length == 0) return false;
+        i += length;
+    }
+    return true;
+}
+
 std::string wstring_to_utf8(const std::wstring& wstr) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> conv;
-    return conv.to_bytes(wstr);
+    std::string out;
+    out.reserve(wstr.size());
+    for (size_t i = 0; i < wstr.size(); ++i) {
+        char32_t code = static_cast<char32_t>(wstr[i]);
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+            continue;
+        }
+        if constexpr (sizeof(wchar_t) == 2) {
+            // Суррогатная пара UTF-16
+            if (code >= 0xD800 && code <= 0xDBFF && i + 1 < wstr.size()) {
+                char32_t low = static_cast<char32_t>(wstr[i + 1]);
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    ++i;
+                }
+            }
+        }
+        if ((code >= 0xD800 && code <= 0xDFFF) || code > 0x10FFFF) {
+            throw std::range_error("wstring_to_utf8: invalid code point");
+        }
+        EncodeUtf8(code, out);
+    }
+    return out;
 }
 
 std::wstring utf8_to_wstring(const std::string& str) {
-    std::wstring_convert<std::codecvt_utf8<wchar_t>> conv;
-    return conv.from_bytes(str);
+    const auto* p = reinterpret_cast<const unsigned char*>(str.data());
+    const size_t n = str.size();
+    // Символов не больше, чем байтов (и пара UTF-16 короче своих 4 байт)
+    std::wstring out(n, L'\0');
+    size_t size = 0;
+    for (size_t i = 0; i < n;) {
+        const size_t ascii = AsciiPrefix(p + i, n - i);
+        for (size_t k = 0; k < ascii; ++k) out[size + k] = static_cast<wchar_t>(p[i + k]);
+        size += ascii;
+        i += ascii;
+        if (i == n) break;
+
+        char32_t code;
+        size_t length = DecodeUtf8(p + i, n - i, code);
+        if (length == 0) throw std::range_error("utf8_to_wstring: invalid UTF-8 sequence");
+        i += length;
+        if (sizeof(wchar_t) == 2 && code >= 0x10000) {
+            code -= 0x10000;
+            out[size++] = static_cast<wchar_t>(0xD800 + (code >> 10));
+            out[size++] = static_cast<wchar_t>(0xDC00 + (code & 0x3FF));
+        } else {
+            out[size++] = static_cast<wchar_t>(code);
+        }
+    }
+    out.resize(size);
+    return out;
 }
 
 std::wstring normalize_dash(const std::wstring& input) {
@@ -26,6 +199,23 @@ std::wstring normalize_dash(const std::wstring& input) {
     return result;
 }
 
+std::string normalize_dash(std::string_view input) {
+    // U+2013 и U+2014 в UTF-8: E2 80 93 и E2 80 94
+    std::string result;
+    result.reserve(input.size());
+    size_t done = 0;
+    for (size_t i = input.find('\xE2'); i != std::string_view::npos; i = input.find('\xE2', i + 1)) {
+        if (i + 2 < input.size() && input[i + 1] == '\x80' && (input[i + 2] == '\x93' || input[i + 2] == '\x94')) {
+            result.append(input, done, i - done);
+            result += '-';
+            done = i + 3;
+            i += 2;
+        }
+    }
+    result.append(input, done);
+    return result;
+}
+
 std::wstring to_lower(const std::wstring& input) {
     std::wstring result = input;
     std::locale loc;
@@ -49,36 +239,44 @@ bool is_valid_word(const std::wstring& word) {
 bool load_config(const std::string& filename,
                  std::vector<std::wstring>& out_files,
                  std::vector<std::wstring>& out_queries) {
-    std::ifstream ifs(filename);
-    if (!ifs.is_open()) {
-        std::wcerr << L"Cannot open config file: " << utf8_to_wstring(filename) << L"\n";
+    ConfigDocument document;
+    std::string error;
+    switch (ReadConfigDocument(filename, document, error)) {
+        case ConfigReadStatus::Ok:
+            break;
+        case ConfigReadStatus::NotFound:
+            std::wcerr << L"Cannot open config file: " << utf8_to_wstring(filename) << L"\n";
+            return false;
+        case ConfigReadStatus::ParseError:
+        case ConfigReadStatus::InvalidStructure:
+            std::wcerr << L"Error parsing config.json: " << utf8_to_wstring(error) << L"\n";
+            return false;
+    }
+    bool invalid_files = std::any_of(document.files.begin(), document.files.end(),
+                                     [](const ConfigFileEntry& file) { return !file.valid; });
+    if (invalid_files || document.skipped_requests > 0) {
+        std::wcerr << L"Error parsing config.json: 'files' must contain paths and 'requests' strings\n";
         return false;
     }
 
-    json j;
     try {
-        ifs >> j;
-        if (j.contains("files") && j["files"].is_array()) {
-            for (auto& f : j["files"]) {
-                std::wstring w = utf8_to_wstring(f.get<std::string>());
-                w = to_lower(normalize_dash(w));
-                if (is_valid_word(w)) {
-                    out_files.push_back(w);
-                } else {
-                    // Можно логировать или просто игнорировать
-                    std::wcerr << L"Ignored invalid file word: " << w << L"\n";
-                }
+        for (const auto& f : document.files) {
+            std::wstring w = utf8_to_wstring(f.path);
+            w = to_lower(normalize_dash(w));
+            if (is_valid_word(w)) {
+                out_files.push_back(w);
+            } else {
+                // Можно логировать или просто игнорировать
+                std::wcerr << L"Ignored invalid file word: " << w << L"\n";
             }
         }
-        if (j.contains("requests") && j["requests"].is_array()) {
-            for (auto& q : j["requests"]) {
-                std::wstring w = utf8_to_wstring(q.get<std::string>());
-                w = to_lower(normalize_dash(w));
-                if (is_valid_word(w)) {
-                    out_queries.push_back(w);
-                } else {
-                    std::wcerr << L"Ignored invalid request word: " << w << L"\n";
-                }
+        for (const auto& q : document.requests) {
+            std::wstring w = utf8_to_wstring(q);
+            w = to_lower(normalize_dash(w));
+            if (is_valid_word(w)) {
+                out_queries.push_back(w);
+            } else {
+                std::wcerr << L"Ignored invalid request word: " << w << L"\n";
             }
         }
     } catch (const std::exception& e) {
@@ -1,40 +1,74 @@
 #include "ConverterJSON.h"
+#include "ConfigReader.h"
+#include "DocumentLoader.h"
+#include "Stats.h"
 #include "json.hpp"
 #include <fstream>
-#include <sstream>
 #include <filesystem>
 #include <cstdio>
+#include <map>
+#include <algorithm>
 
 using json = nlohmann::json;
 namespace fs = std::filesystem;
 
-bool ConverterJSON::LoadConfig(const std::string& filename, std::string& error) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        error = "Config file not found: " + filename;
+// Разбирает объект полей документа {имя: число или строка} и добавляет их в fields.
+// field_numeric — типы уже встреченных полей: тип поля должен совпадать во всех документах
+static bool ParseDocumentFields(const json& fields_json, DocumentFields& fields,
+                                std::map<std::string, bool>& field_numeric, std::string& error) {
+    if (!fields_json.is_object()) {
+        error = "Config 'fields' of a file must be an object";
         return false;
     }
+    for (const auto& [name, value] : fields_json.items()) {
+        if (!value.is_number() && !value.is_string()) {
+            error = "Config field '" + name + "' must be a number or a string";
+            return false;
+        }
+        auto [it, inserted] = field_numeric.try_emplace(name, value.is_number());
+        if (it->second != value.is_number()) {
+            error = "Config field '" + name + "' must have the same type in all files";
+            return false;
+        }
+        std::erase_if(fields, [&name](const auto& field) { return field.first == name; });
+        if (value.is_number()) {
+            fields.emplace_back(name, value.get<double>());
+        } else {
+            fields.emplace_back(name, value.get<std::string>());
+        }
+    }
+    return true;
+}
 
-    json j;
-    try {
-        file >> j;
-    } catch (const std::exception& e) {
-        error = std::string("Config file parse error: ") + e.what();
-        return false;
+bool ConverterJSON::LoadConfig(const std::string& filename, std::string& error, bool read_documents) {
+    SE_SCOPED_TIMER("load_config");
+
+    ConfigDocument document;
+    switch (ReadConfigDocument(filename, document, error)) {
+        case ConfigReadStatus::Ok:
+            break;
+        case ConfigReadStatus::InvalidStructure:
+            return false;
+        case ConfigReadStatus::NotFound:
+            error = "Config file not found: " + filename;
+            return false;
+        case ConfigReadStatus::ParseError:
+            error = "Config file parse error: " + error;
+            return false;
     }
 
-    if (!j.contains("config") || !j["config"].is_object()) {
+    if (!document.config.is_object()) {
         error = "Config file missing 'config' object";
         return false;
     }
 
-    if (!j.contains("files") || !j["files"].is_array()) {
+    if (!document.has_files) {
         error = "Config missing 'files' array";
         return false;
     }
 
     try {
-        auto& cfg = j["config"];
+        const json& cfg = document.config;
         if (!cfg.contains("version") || !cfg["version"].is_string()) {
             error = "Config 'version' field missing or invalid";
             return false;
@@ -47,71 +81,246 @@ bool ConverterJSON::LoadConfig(const std::string& filename, std::string& error)
             max_responses_ = 5; // default
         }
 
+        document_store_policy_ = DocumentStorePolicy::None;
+        if (cfg.contains("document_store")) {
+            std::optional<DocumentStorePolicy> policy;
+            if (cfg["document_store"].is_string()) {
+                policy = ParseDocumentStorePolicy(cfg["document_store"].get<std::string>());
+            }
+            if (!policy) {
+                error = "Config 'document_store' must be one of: none, mapped, compressed";
+                return false;
+            }
+            document_store_policy_ = *policy;
+        }
+
+        positional_index_ = cfg.contains("positional_index") && cfg["positional_index"].is_boolean()
+                            && cfg["positional_index"].get<bool>();
+
+        lowercase_ = cfg.contains("lowercase") && cfg["lowercase"].is_boolean() && cfg["lowercase"].get<bool>();
+
+        stop_words_.clear();
+        if (cfg.contains("stop_words")) {
+            if (!cfg["stop_words"].is_array()) {
+                error = "Config 'stop_words' must be an array of strings";
+                return false;
+            }
+            for (const auto& word : cfg["stop_words"]) {
+                if (!word.is_string()) {
+                    error = "Config 'stop_words' must be an array of strings";
+                    return false;
+                }
+                stop_words_.push_back(word.get<std::string>());
+            }
+        }
+
+        stem_languages_.clear();
+        if (cfg.contains("stemming")) {
+            const std::string stemming_error = "Config 'stemming' must be an array of: english, russian";
+            if (!cfg["stemming"].is_array()) {
+                error = stemming_error;
+                return false;
+            }
+            for (const auto& name : cfg["stemming"]) {
+                std::optional<StemLanguage> language;
+                if (name.is_string()) language = ParseStemLanguage(name.get<std::string>());
+                if (!language) {
+                    error = stemming_error;
+                    return false;
+                }
+                stem_languages_.push_back(*language);
+            }
+        }
+
+        pair_index_terms_ = 0;
+        if (cfg.contains("pair_index_terms")) {
+            if (!cfg["pair_index_terms"].is_number_integer() || cfg["pair_index_terms"].get<int>() < 0) {
+                error = "Config 'pair_index_terms' must be a non-negative integer";
+                return false;
+            }
+            pair_index_terms_ = cfg["pair_index_terms"].get<size_t>();
+        }
+
+        snippets_ = cfg.contains("snippets") && cfg["snippets"].is_boolean() && cfg["snippets"].get<bool>();
+
+        snippet_options_ = SnippetOptions{};
+        if (cfg.contains("snippet_words")) {
+            if (!cfg["snippet_words"].is_number_integer() || cfg["snippet_words"].get<int>() < 1) {
+                error = "Config 'snippet_words' must be a positive integer";
+                return false;
+            }
+            snippet_options_.window_words = cfg["snippet_words"].get<size_t>();
+        }
+
+        fuzzy_max_edits_ = 0;
+        if (cfg.contains("fuzzy")) {
+            if (!cfg["fuzzy"].is_number_integer() || cfg["fuzzy"].get<int>() < 0 || cfg["fuzzy"].get<int>() > 2) {
+                error = "Config 'fuzzy' must be an integer from 0 to 2";
+                return false;
+            }
+            fuzzy_max_edits_ = cfg["fuzzy"].get<int>();
+        }
+
+        shard_count_ = 1;
+        if (cfg.contains("shards")) {
+            if (!cfg["shards"].is_number_integer() || cfg["shards"].get<int>() < 1) {
+                error = "Config 'shards' must be a positive integer";
+                return false;
+            }
+            shard_count_ = cfg["shards"].get<size_t>();
+        }
+
+        index_memory_budget_ = 0;
+        if (cfg.contains("index_memory_budget_mb")) {
+            if (!cfg["index_memory_budget_mb"].is_number_integer() || cfg["index_memory_budget_mb"].get<int>() < 0) {
+                error = "Config 'index_memory_budget_mb' must be a non-negative integer";
+                return false;
+            }
+            index_memory_budget_ = cfg["index_memory_budget_mb"].get<size_t>() << 20;
+        }
+
+        watch_options_ = WatchOptions{};
+        for (const char* key : {"watch_debounce_ms", "watch_poll_ms"}) {
+            if (!cfg.contains(key)) continue;
+            if (!cfg[key].is_number_integer() || cfg[key].get<int>() < 1) {
+                error = std::string("Config '") + key + "' must be a positive integer";
+                return false;
+            }
+        }
+        if (cfg.contains("watch_debounce_ms")) {
+            watch_options_.debounce = std::chrono::milliseconds(cfg["watch_debounce_ms"].get<int>());
+            watch_options_.max_delay = std::max(watch_options_.max_delay, watch_options_.debounce * 10);
+        }
+        if (cfg.contains("watch_poll_ms")) {
+            watch_options_.poll_interval = std::chrono::milliseconds(cfg["watch_poll_ms"].get<int>());
+        }
+        watch_options_.force_polling = cfg.contains("watch_polling") && cfg["watch_polling"].is_boolean()
+                                       && cfg["watch_polling"].get<bool>();
+
         text_documents_.clear();
+        document_paths_.clear();
+        document_fields_.clear();
         fs::path config_path = filename;
         fs::path config_dir = config_path.parent_path();
 
-        for (auto& file_name_json : j["files"]) {
-            if (!file_name_json.is_string()) continue;
+        index_path_.clear();
+        if (cfg.contains("index_path")) {
+            if (!cfg["index_path"].is_string() || cfg["index_path"].get<std::string>().empty()) {
+                error = "Config 'index_path' must be a non-empty string";
+                return false;
+            }
+            fs::path index_path = cfg["index_path"].get<std::string>();
+            if (!index_path.is_absolute()) index_path = config_dir / index_path;
+            index_path_ = index_path.lexically_normal().string();
+        }
+        std::map<std::string, bool> field_numeric;  // тип поля задаёт первое значение
+        std::vector<std::string> listed_paths;     // пути в том виде, как они записаны в files
+
+        for (auto& file_entry : document.files) {
+            if (!file_entry.valid) continue;
+            DocumentFields fields;
+            if (!file_entry.fields.is_null()
+                && !ParseDocumentFields(file_entry.fields, fields, field_numeric, error)) {
+                return false;
+            }
 
-            fs::path relative_doc_path = file_name_json.get<std::string>();
+            fs::path relative_doc_path = file_entry.path;
+            listed_paths.push_back(std::move(file_entry.path));
 
             fs::path doc_path = relative_doc_path.is_absolute() ? relative_doc_path : (config_dir / relative_doc_path);
             doc_path = doc_path.lexically_normal(); // Убирает лишние ../ и ./ из пути
+            document_paths_.push_back(doc_path.string());
+            document_fields_.push_back(std::move(fields));
+        }
 
-            std::ifstream doc_file(doc_path);
-            if (!doc_file.is_open()) {
-                error = "Failed to open document file: " + doc_path.string();
+        // Поля из отдельного файла: {путь из files: {имя: значение}}
+        if (cfg.contains("fields_file")) {
+            if (!cfg["fields_file"].is_string()) {
+                error = "Config 'fields_file' must be a string";
                 return false;
             }
-
-            std::stringstream buffer;
-            buffer << doc_file.rdbuf();
-            std::string content = buffer.str();
-
-            if (content.empty()) {
-                error = "Empty document file: " + doc_path.string();
+            fs::path fields_path = cfg["fields_file"].get<std::string>();
+            if (!fields_path.is_absolute()) fields_path = config_dir / fields_path;
+            std::ifstream fields_file(fields_path);
+            if (!fields_file.is_open()) {
+                error = "Fields file not found: " + fields_path.string();
                 return false;
             }
-
-            text_documents_.push_back(content);
+            json sidecar;
+            try {
+                fields_file >> sidecar;
+            } catch (const std::exception& e) {
+                error = std::string("Fields file parse error: ") + e.what();
+                return false;
+            }
+            if (!sidecar.is_object()) {
+                error = "Fields file must be an object of file paths";
+                return false;
+            }
+            for (size_t i = 0; i < listed_paths.size(); ++i) {
+                auto it = sidecar.find(listed_paths[i]);
+                if (it != sidecar.end() && !ParseDocumentFields(*it, document_fields_[i], field_numeric, error)) {
+                    return false;
+                }
+            }
         }
     } catch (const std::exception& e) {
         error = std::string("Config file structure error: ") + e.what();
         return false;
     }
 
+    return !read_documents || ReadDocuments(error);
+}
+
+bool ConverterJSON::ReadDocuments(std::string& error) {
+    std::vector<std::string> texts(document_paths_.size());
+    std::vector<std::string> errors(document_paths_.size());
+
+    // Тексты только сохраняются, поэтому хватает одного потока обработки
+    DocumentLoader::Options options;
+    options.io_threads = 4;
+    options.worker_threads = 1;
+    DocumentLoader(options).run(
+        document_paths_,
+        [&texts](size_t i, std::string& text) { texts[i] = std::move(text); },
+        [&errors](size_t i, const std::string& message) { errors[i] = message; });
+
+    // Сообщаем о первом по порядку файле, который не удалось прочитать
+    for (const auto& message : errors) {
+        if (!message.empty()) {
+            error = message;
+            return false;
+        }
+    }
+    text_documents_ = std::move(texts);
     return true;
 }
 
 
 bool ConverterJSON::LoadRequests(const std::string& filename, std::string& error) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        error = "Requests file not found: " + filename;
-        return false;
-    }
+    SE_SCOPED_TIMER("load_requests");
 
-    json j;
-    try {
-        file >> j;
-    } catch (const std::exception& e) {
-        error = std::string("Requests file parse error: ") + e.what();
-        return false;
+    ConfigDocument document;
+    switch (ReadConfigDocument(filename, document, error)) {
+        case ConfigReadStatus::Ok:
+            break;
+        case ConfigReadStatus::InvalidStructure:
+            return false;
+        case ConfigReadStatus::NotFound:
+            error = "Requests file not found: " + filename;
+            return false;
+        case ConfigReadStatus::ParseError:
+            error = "Requests file parse error: " + error;
+            return false;
     }
 
-    if (!j.contains("requests") || !j["requests"].is_array()) {
+    if (!document.has_requests) {
         error = "Requests file missing 'requests' array";
         return false;
     }
 
-    requests_.clear();
-    for (auto& req : j["requests"]) {
-        if (req.is_string()) {
-            requests_.push_back(req.get<std::string>());
-        }
-    }
-
+    // Элементы, которые не строки, пропускаются
+    requests_ = std::move(document.requests);
     return true;
 }
 
@@ -119,6 +328,70 @@ const std::vector<std::string>& ConverterJSON::GetTextDocuments() const {
     return text_documents_;
 }
 
+const std::vector<std::string>& ConverterJSON::GetDocumentPaths() const {
+    return document_paths_;
+}
+
+const std::vector<DocumentFields>& ConverterJSON::GetDocumentFields() const {
+    return document_fields_;
+}
+
+void ConverterJSON::ReleaseTextDocuments() {
+    std::vector<std::string>().swap(text_documents_);
+}
+
+DocumentStorePolicy ConverterJSON::GetDocumentStorePolicy() const {
+    return document_store_policy_;
+}
+
+bool ConverterJSON::IsPositionalIndexEnabled() const {
+    return positional_index_;
+}
+
+int ConverterJSON::GetFuzzyMaxEdits() const {
+    return fuzzy_max_edits_;
+}
+
+bool ConverterJSON::IsLowercaseEnabled() const {
+    return lowercase_;
+}
+
+const std::vector<std::string>& ConverterJSON::GetStopWords() const {
+    return stop_words_;
+}
+
+const std::vector<StemLanguage>& ConverterJSON::GetStemLanguages() const {
+    return stem_languages_;
+}
+
+size_t ConverterJSON::GetPairIndexTerms() const {
+    return pair_index_terms_;
+}
+
+bool ConverterJSON::IsSnippetsEnabled() const {
+    return snippets_;
+}
+
+const SnippetOptions& ConverterJSON::GetSnippetOptions() const {
+    return snippet_options_;
+}
+
+size_t ConverterJSON::GetShardCount() const {
+    return shard_count_;
+}
+
+size_t ConverterJSON::GetIndexMemoryBudget() const {
+    return index_memory_budget_;
+}
+
+const std::string& ConverterJSON::GetIndexPath() const {
+    return index_path_;
+}
+
+const WatchOptions& ConverterJSON::GetWatchOptions() const {
+    return watch_options_;
+}
+
 const std::vector<std::string>& ConverterJSON::GetRequests() const {
     return requests_;
 }
@@ -131,9 +404,27 @@ bool ConverterJSON::CheckConfigVersion(const std::string& app_version) const {
     return config_version_ == app_version;
 }
 
+// Сведения о документе для answers.json; хеш — 16 шестнадцатеричных цифр,
+// чтобы 64-битное значение не теряло точность в JSON-парсерах с double
+static json DocumentInfoToJson(const DocumentInfo& info) {
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(info.hash));
+    json fields = json::object();
+    for (const auto& [name, value] : info.fields) {
+        if (std::holds_alternative<double>(value)) {
+            fields[name] = std::get<double>(value);
+        } else {
+            fields[name] = std::get<std::string>(value);
+        }
+    }
+    return {{"path", info.path}, {"size", info.size}, {"mtime", info.mtime}, {"hash", hash}, {"fields", fields}};
+}
+
 bool ConverterJSON::SaveAnswers(const std::string& filename,
                                const std::vector<std::string>& requests,
-                               const std::vector<std::vector<RelativeIndex>>& answers) const {
+                               const std::vector<std::vector<RelativeIndex>>& answers,
+                               const std::vector<std::vector<Snippet>>& snippets,
+                               const std::vector<std::vector<DocumentInfo>>& documents) const {
     json output_json;
     json answers_array = json::array();
 
@@ -145,11 +436,22 @@ bool ConverterJSON::SaveAnswers(const std::string& filename,
         } else {
             answer_item["result"] = true;
             json relevance_array = json::array();
-            for (const auto& rel : answers[i]) {
-                relevance_array.push_back({
+            for (size_t j = 0; j < answers[i].size(); ++j) {
+                const auto& rel = answers[i][j];
+                json item = {
                     {"doc_id", rel.doc_id},
                     {"rank", rel.rank}
-                });
+                };
+                if (i < snippets.size() && j < snippets[i].size() && !snippets[i][j].text.empty()) {
+                    const Snippet& snippet = snippets[i][j];
+                    json highlights = json::array();
+                    for (const auto& [offset, length] : snippet.highlights) highlights.push_back({offset, length});
+                    item["snippet"] = {{"text", snippet.text}, {"highlights", highlights}};
+                }
+                if (i < documents.size() && j < documents[i].size()) {
+                    item["document"] = DocumentInfoToJson(documents[i][j]);
+                }
+                relevance_array.push_back(item);
             }
             answer_item["relevance"] = relevance_array;
         }
@@ -169,8 +471,10 @@ bool ConverterJSON::SaveAnswers(const std::string& filename,
 }
 
 bool ConverterJSON::putAnswers(const std::vector<std::string>& requests,
-                               const std::vector<std::vector<RelativeIndex>>& answers) const {
-    return SaveAnswers("answers.json", requests, answers);
+                               const std::vector<std::vector<RelativeIndex>>& answers,
+                               const std::vector<std::vector<Snippet>>& snippets,
+                               const std::vector<std::vector<DocumentInfo>>& documents) const {
+    return SaveAnswers("answers.json", requests, answers, snippets, documents);
 }
 
 bool ConverterJSON::SaveRequests(const std::string& filename) const {
@@ -0,0 +1,26 @@
+#include "CpuFeatures.h"
+
+static SimdLevel Detect() {
+#if (defined(__x86_64__) || defined(_M_X64)) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+    return SimdLevel::Sse2;  // входит в базовый набор x86-64
+#elif defined(__x86_64__) || defined(_M_X64)
+    return SimdLevel::Sse2;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+SimdLevel DetectSimdLevel() {
+    static const SimdLevel level = Detect();
+    return level;
+}
+
+const char* SimdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::Avx2: return "avx2";
+        case SimdLevel::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
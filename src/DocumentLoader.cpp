@@ -0,0 +1,183 @@
+#include "DocumentLoader.h"
+#include "BoundedQueue.h"
+#include "DocumentTable.h"
+#include "Stats.h"
+#include "UringReader.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t kReadChunk = size_t{1} << 20;
+
+} // namespace
+
+AlignedBuffer::AlignedBuffer(size_t size)
+    : size_((size + kAlignment - 1) / kAlignment * kAlignment) {
+    if (size_ > 0) data_.reset(static_cast<char*>(::operator new[](size_, std::align_val_t{kAlignment})));
+}
+
+void AlignedBuffer::Free::operator()(char* p) const {
+    ::operator delete[](p, std::align_val_t{kAlignment});
+}
+
+bool ReadWholeFile(const std::string& path, std::string& text, std::string& error, int64_t* mtime, bool direct) {
+#ifndef _WIN32
+    int fd = -1;
+#ifdef O_DIRECT
+    if (direct) fd = ::open(path.c_str(), O_RDONLY | O_DIRECT);
+#endif
+    if (fd < 0) {
+        direct = false;  // файловая система (например, tmpfs) не поддерживает O_DIRECT
+        fd = ::open(path.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+        error = "Failed to open document file: " + path;
+        return false;
+    }
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        error = "Failed to read document file: " + path;
+        return false;
+    }
+    if (mtime) *mtime = st.st_mtime;
+
+#ifdef O_DIRECT
+    if (direct) {
+        // O_DIRECT требует выровненных адреса, длины и смещения: читаем
+        // блоками в буфер потока и дописываем в строку
+        thread_local AlignedBuffer buffer(kReadChunk);
+        text.clear();
+        text.reserve(static_cast<size_t>(st.st_size));
+        for (;;) {
+            ssize_t n = ::read(fd, buffer.data(), buffer.size());
+            if (n < 0 && errno == EINVAL) {
+                direct = false;  // O_DIRECT отклонён при чтении: читаем заново обычным способом
+                break;
+            }
+            if (n < 0) {
+                ::close(fd);
+                error = "Failed to read document file: " + path;
+                return false;
+            }
+            text.append(buffer.data(), static_cast<size_t>(n));
+            if (static_cast<size_t>(n) < buffer.size()) break;  // конец файла
+        }
+        // Смещение после конца файла не выровнено: хвост дочитывается без O_DIRECT
+        ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) & ~O_DIRECT);
+        if (!direct) ::lseek(fd, 0, SEEK_SET);
+    }
+#endif
+    if (!direct) {
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+        // Размер известен заранее: читаем блоками сразу в итоговую строку.
+        // Через кеш страниц выравнивание не нужно, а промежуточный буфер
+        // добавил бы лишнее копирование.
+        text.resize(static_cast<size_t>(st.st_size));
+        size_t done = 0;
+        while (done < text.size()) {
+            ssize_t n = ::read(fd, text.data() + done, std::min(kReadChunk, text.size() - done));
+            if (n < 0) {
+                ::close(fd);
+                error = "Failed to read document file: " + path;
+                return false;
+            }
+            if (n == 0) break;  // файл укоротился во время чтения
+            done += static_cast<size_t>(n);
+        }
+        text.resize(done);
+    }
+
+    // Файл мог вырасти после fstat (или размер неизвестен, как у /proc)
+    char tail[4096];
+    for (ssize_t n; (n = ::read(fd, tail, sizeof(tail))) > 0;) {
+        text.append(tail, static_cast<size_t>(n));
+    }
+    ::close(fd);
+#else
+    (void)direct;
+    if (mtime) *mtime = FileModificationTime(path);
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        error = "Failed to open document file: " + path;
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    text = buffer.str();
+#endif
+    SE_COUNTER_ADD("files_read", 1);
+    SE_COUNTER_ADD("bytes_read", text.size());
+    return true;
+}
+
+void DocumentLoader::run(const std::vector<std::string>& paths, const Consumer& consume,
+                         const ErrorHandler& on_error, std::vector<int64_t>* mtimes) const {
+    SE_SCOPED_TIMER("load_documents");
+
+    BoundedQueue<std::pair<size_t, std::string>> queue(options.queue_capacity);
+    std::atomic<size_t> next_path{0};
+
+    size_t io_count = std::max<size_t>(1, std::min(options.io_threads, paths.size()));
+    size_t worker_count = options.worker_threads > 0
+                        ? options.worker_threads
+                        : std::max<unsigned>(1, std::thread::hardware_concurrency());
+
+    std::vector<std::thread> readers;
+    for (size_t t = 0; t < io_count; ++t) {
+        readers.emplace_back([&]() {
+            if (options.use_io_uring) {
+                UringReader uring(32, size_t{64} << 10, options.direct_io);
+                if (uring.ok()) {
+                    uring.run(paths, next_path,
+                              [&queue, mtimes](size_t i, std::string& text, int64_t mtime) {
+                                  if (mtimes) (*mtimes)[i] = mtime;
+                                  queue.push({i, std::move(text)});
+                              },
+                              [&on_error](size_t i, const std::string& error) { if (on_error) on_error(i, error); });
+                    return;
+                }
+            }
+            for (size_t i; (i = next_path.fetch_add(1)) < paths.size();) {
+                std::string text, error;
+                int64_t mtime = 0;
+                if (!ReadWholeFile(paths[i], text, error, &mtime, options.direct_io)) {
+                    if (on_error) on_error(i, error);
+                    continue;
+                }
+                if (mtimes) (*mtimes)[i] = mtime;
+                queue.push({i, std::move(text)});
+            }
+        });
+    }
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < worker_count; ++t) {
+        workers.emplace_back([&]() {
+            while (auto item = queue.pop()) {
+                consume(item->first, item->second);
+            }
+        });
+    }
+
+    for (auto& t : readers) t.join();
+    queue.close();
+    for (auto& t : workers) t.join();
+}
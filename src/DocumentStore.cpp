@@ -0,0 +1,212 @@
+#include "DocumentStore.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+std::optional<DocumentStorePolicy> ParseDocumentStorePolicy(const std::string& name) {
+    if (name == "none") return DocumentStorePolicy::None;
+    if (name == "mapped") return DocumentStorePolicy::Mapped;
+    if (name == "compressed") return DocumentStorePolicy::Compressed;
+    return std::nullopt;
+}
+
+void DocumentStore::setPolicy(DocumentStorePolicy policy) {
+    policy_ = policy;
+    slots_.clear();
+}
+
+void DocumentStore::reset(size_t count) {
+    slots_.assign(count);
+}
+
+void DocumentStore::set(size_t doc_id, const std::string& text, const std::string& source_path) {
+    if (doc_id >= slots_.size() || policy_ == DocumentStorePolicy::None) return;
+
+    Slot& slot = slots_.mutableAt(doc_id);
+    slot.raw_size = text.size();
+    slot.stored = true;
+    if (policy_ == DocumentStorePolicy::Mapped && !source_path.empty()) {
+        slot.path = source_path;
+    } else {
+        slot.compressed = std::make_shared<const std::string>(LzCompress(text));
+    }
+}
+
+// Читает начало файла (max_bytes) через mmap (или ifstream, где mmap недоступен)
+static std::optional<std::string> ReadMapped(const std::string& path, size_t expected_size, size_t max_bytes) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return std::nullopt;
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != expected_size) {
+        ::close(fd);
+        return std::nullopt;
+    }
+    if (expected_size == 0) {
+        ::close(fd);
+        return std::string();
+    }
+
+    void* data = ::mmap(nullptr, expected_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return std::nullopt;
+
+    std::string text(static_cast<const char*>(data), std::min(expected_size, max_bytes));
+    ::munmap(data, expected_size);
+    return text;
+#else
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return std::nullopt;
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    if (text.size() != expected_size) return std::nullopt;
+    if (text.size() > max_bytes) text.resize(max_bytes);
+    return text;
+#endif
+}
+
+std::optional<std::string> DocumentStore::get(size_t doc_id, size_t max_bytes) const {
+    if (doc_id >= slots_.size() || !slots_[doc_id].stored) return std::nullopt;
+
+    const Slot& slot = slots_[doc_id];
+    if (!slot.path.empty()) {
+        return ReadMapped(slot.path, slot.raw_size, max_bytes);
+    }
+    return LzDecompress(*slot.compressed, slot.raw_size, max_bytes);
+}
+
+size_t DocumentStore::memoryBytes() const {
+    const size_t sso_capacity = std::string().capacity();
+    size_t bytes = slots_.memoryBytes();
+    for (size_t i = 0; i < slots_.size(); ++i) {
+        const Slot& slot = slots_[i];
+        if (slot.compressed) bytes += sizeof(std::string) + slot.compressed->capacity() + 1;
+        if (slot.path.capacity() > sso_capacity) bytes += slot.path.capacity() + 1;
+    }
+    return bytes;
+}
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 65535;
+constexpr int kHashBits = 14;
+
+uint32_t Read32(const char* p) {
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+void PutLength(std::string& out, size_t len) {
+    while (len >= 255) {
+        out.push_back(static_cast<char>(255));
+        len -= 255;
+    }
+    out.push_back(static_cast<char>(len));
+}
+
+bool GetLength(const std::string& in, size_t& pos, size_t& len) {
+    for (;;) {
+        if (pos >= in.size()) return false;
+        auto b = static_cast<unsigned char>(in[pos++]);
+        len += b;
+        if (b != 255) return true;
+    }
+}
+
+} // namespace
+
+std::string LzCompress(const std::string& input) {
+    std::string out;
+    const size_t n = input.size();
+    const char* src = input.data();
+    out.reserve(n / 2 + 16);
+
+    std::vector<int64_t> table(size_t{1} << kHashBits, -1);
+    size_t anchor = 0;
+    size_t i = 0;
+
+    while (i + kMinMatch <= n) {
+        uint32_t h = (Read32(src + i) * 2654435761u) >> (32 - kHashBits);
+        int64_t candidate = table[h];
+        table[h] = static_cast<int64_t>(i);
+
+        if (candidate < 0 || i - candidate > kMaxOffset ||
+            Read32(src + candidate) != Read32(src + i)) {
+            ++i;
+            continue;
+        }
+
+        size_t match = kMinMatch;
+        while (i + match < n && src[candidate + match] == src[i + match]) ++match;
+
+        size_t literals = i - anchor;
+        size_t extra = match - kMinMatch;
+        out.push_back(static_cast<char>((std::min<size_t>(literals, 15) << 4) |
+                                        std::min<size_t>(extra, 15)));
+        if (literals >= 15) PutLength(out, literals - 15);
+        out.append(src + anchor, literals);
+
+        size_t offset = i - static_cast<size_t>(candidate);
+        out.push_back(static_cast<char>(offset & 0xFF));
+        out.push_back(static_cast<char>(offset >> 8));
+        if (extra >= 15) PutLength(out, extra - 15);
+
+        i += match;
+        anchor = i;
+    }
+
+    // Последняя последовательность содержит только литералы
+    size_t literals = n - anchor;
+    out.push_back(static_cast<char>(std::min<size_t>(literals, 15) << 4));
+    if (literals >= 15) PutLength(out, literals - 15);
+    out.append(src + anchor, literals);
+    return out;
+}
+
+std::string LzDecompress(const std::string& input, size_t raw_size, size_t max_output) {
+    std::string out;
+    out.reserve(std::min(raw_size, max_output));
+    size_t pos = 0;
+
+    while (pos < input.size() && out.size() < max_output) {
+        auto token = static_cast<unsigned char>(input[pos++]);
+
+        size_t literals = token >> 4;
+        if (literals == 15 && !GetLength(input, pos, literals)) break;
+        if (pos + literals > input.size()) break;
+        out.append(input, pos, literals);
+        pos += literals;
+
+        if (pos >= input.size()) break;
+        if (pos + 2 > input.size()) break;
+        size_t offset = static_cast<unsigned char>(input[pos]) |
+                        (static_cast<size_t>(static_cast<unsigned char>(input[pos + 1])) << 8);
+        pos += 2;
+
+        size_t match = token & 0x0F;
+        if (match == 15 && !GetLength(input, pos, match)) break;
+        match += kMinMatch;
+
+        if (offset == 0 || offset > out.size()) break;
+        size_t from = out.size() - offset;
+        for (size_t k = 0; k < match; ++k) {
+            char c = out[from + k];
+            out.push_back(c);
+        }
+    }
+    if (out.size() > max_output) out.resize(max_output);
+    return out;
+}
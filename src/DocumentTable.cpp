@@ -0,0 +1,127 @@
+#include "DocumentTable.h"
+#include "Hash.h"
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <limits>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+std::optional<FieldValue> FieldColumn::get(size_t doc_id) const {
+    if (numeric_) {
+        if (doc_id >= numbers_.size() || std::isnan(numbers_[doc_id])) return std::nullopt;
+        return numbers_[doc_id];
+    }
+    if (doc_id >= string_ids_.size() || string_ids_[doc_id] == kMissing) return std::nullopt;
+    return dictionary_[string_ids_[doc_id]];
+}
+
+double FieldColumn::number(size_t doc_id) const {
+    if (!numeric_ || doc_id >= numbers_.size()) return std::numeric_limits<double>::quiet_NaN();
+    return numbers_[doc_id];
+}
+
+size_t FieldColumn::memoryBytes() const {
+    size_t bytes = numbers_.capacity() * sizeof(double) + string_ids_.capacity() * sizeof(uint32_t)
+                 + dictionary_.capacity() * sizeof(std::string);
+    for (const auto& value : dictionary_) bytes += value.capacity();
+    return bytes;
+}
+
+void DocumentTable::reset(size_t count) {
+    paths_.assign(count);
+    sizes_.assign(count, 0);
+    mtimes_.assign(count, 0);
+    hashes_.assign(count, 0);
+}
+
+void DocumentTable::set(size_t doc_id, const std::string& path, const std::string& text, int64_t mtime) {
+    paths_.mutableAt(doc_id) = path;
+    sizes_.mutableAt(doc_id) = text.size();
+    mtimes_.mutableAt(doc_id) = mtime;
+    hashes_.mutableAt(doc_id) = XXH64(text);
+}
+
+void DocumentTable::setFingerprint(size_t doc_id, const FileFingerprint& file) {
+    paths_.mutableAt(doc_id) = file.path;
+    sizes_.mutableAt(doc_id) = file.size;
+    mtimes_.mutableAt(doc_id) = file.mtime;
+    hashes_.mutableAt(doc_id) = file.hash;
+}
+
+FileFingerprint DocumentTable::fingerprint(size_t doc_id) const {
+    return {paths_[doc_id], sizes_[doc_id], mtimes_[doc_id], hashes_[doc_id]};
+}
+
+void DocumentTable::add(const std::string& path, const std::string& text, int64_t mtime) {
+    paths_.push_back({});
+    sizes_.push_back(0);
+    mtimes_.push_back(0);
+    hashes_.push_back(0);
+    set(paths_.size() - 1, path, text, mtime);
+}
+
+void DocumentTable::setFields(const std::vector<DocumentFields>& fields) {
+    fields_.reset();
+    if (fields.empty()) return;
+    auto columns = std::make_shared<std::map<std::string, FieldColumn>>();
+    // Повторяющиеся строки хранятся один раз: номера значений по столбцам
+    std::map<std::string, std::unordered_map<std::string, uint32_t>> string_ids;
+    for (size_t doc_id = 0; doc_id < fields.size(); ++doc_id) {
+        for (const auto& [name, value] : fields[doc_id]) {
+            auto [it, inserted] = columns->try_emplace(name);
+            FieldColumn& column = it->second;
+            if (inserted) column.numeric_ = std::holds_alternative<double>(value);
+            if (column.numeric_ != std::holds_alternative<double>(value)) continue;
+
+            if (column.numeric_) {
+                if (column.numbers_.size() <= doc_id) {
+                    column.numbers_.resize(doc_id + 1, std::numeric_limits<double>::quiet_NaN());
+                }
+                column.numbers_[doc_id] = std::get<double>(value);
+            } else {
+                const auto& text = std::get<std::string>(value);
+                auto [id_it, added] = string_ids[name].try_emplace(text, static_cast<uint32_t>(column.dictionary_.size()));
+                if (added) column.dictionary_.push_back(text);
+                uint32_t id = id_it->second;
+                if (column.string_ids_.size() <= doc_id) column.string_ids_.resize(doc_id + 1, FieldColumn::kMissing);
+                column.string_ids_[doc_id] = id;
+            }
+        }
+    }
+    fields_ = std::move(columns);
+}
+
+DocumentInfo DocumentTable::get(size_t doc_id) const {
+    DocumentInfo info{paths_[doc_id], sizes_[doc_id], mtimes_[doc_id], hashes_[doc_id], {}};
+    if (!fields_) return info;
+    for (const auto& [name, column] : *fields_) {
+        if (auto value = column.get(doc_id)) info.fields.emplace_back(name, std::move(*value));
+    }
+    return info;
+}
+
+const FieldColumn* DocumentTable::field(const std::string& name) const {
+    if (!fields_) return nullptr;
+    auto it = fields_->find(name);
+    return it == fields_->end() ? nullptr : &it->second;
+}
+
+size_t DocumentTable::memoryBytes() const {
+    size_t bytes = paths_.memoryBytes() + sizes_.memoryBytes() + mtimes_.memoryBytes() + hashes_.memoryBytes();
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        if (paths_[i].capacity() > std::string().capacity()) bytes += paths_[i].capacity() + 1;
+    }
+    if (!fields_) return bytes;
+    for (const auto& [name, column] : *fields_) bytes += name.capacity() + column.memoryBytes();
+    return bytes;
+}
+
+int64_t FileModificationTime(const std::string& path) {
+    std::error_code ec;
+    auto time = fs::last_write_time(path, ec);
+    if (ec) return 0;
+    auto system_time = std::chrono::file_clock::to_sys(time);
+    return std::chrono::duration_cast<std::chrono::seconds>(system_time.time_since_epoch()).count();
+}
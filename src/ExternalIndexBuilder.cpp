@@ -0,0 +1,156 @@
+#include "ExternalIndexBuilder.h"
+#include "DocumentLoader.h"
+#include "IndexFile.h"
+#include "Stats.h"
+#include "Tokenizer.h"
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <queue>
+#include <random>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Оценка памяти узла словаря: указатель, ключ, вектор, хеш
+constexpr size_t kNodeBytes = sizeof(void*) + sizeof(std::string) + sizeof(std::vector<Entry>) + sizeof(size_t);
+
+} // namespace
+
+ExternalIndexBuilder::ExternalIndexBuilder(std::string temp_dir, size_t memory_budget, TokenizerOptions options)
+    : temp_dir_(std::move(temp_dir)), memory_budget_(memory_budget), options_(options) {}
+
+ExternalIndexBuilder::~ExternalIndexBuilder() {
+    RemoveRuns();
+}
+
+bool ExternalIndexBuilder::addDocument(const std::string& text, std::string& error) {
+    return AddText(text, {}, 0, error);
+}
+
+bool ExternalIndexBuilder::AddText(const std::string& text, const std::string& path, int64_t mtime,
+                                   std::string& error) {
+    const auto doc_id = static_cast<DocId>(doc_count_++);
+    documents_.add(path, text, mtime);
+
+    std::unordered_map<std::string, TermCount> word_count;
+    for (auto& word : Tokenize(text, options_)) {
+        word_count[std::move(word)]++;
+    }
+    SE_COUNTER_ADD("documents_indexed", 1);
+
+    for (auto& [word, count] : word_count) {
+        auto [it, inserted] = block_.try_emplace(word);
+        if (inserted) block_bytes_ += kNodeBytes + word.capacity();
+        it->second.push_back({doc_id, count});
+        block_bytes_ += sizeof(Entry);
+    }
+
+    if (block_bytes_ >= memory_budget_) return FlushRun(error);
+    return true;
+}
+
+bool ExternalIndexBuilder::addFile(const std::string& path, std::string& error) {
+    std::string text;
+    int64_t mtime = 0;
+    if (!ReadWholeFile(path, text, error, &mtime)) return false;
+    return AddText(text, path, mtime, error);
+}
+
+bool ExternalIndexBuilder::FlushRun(std::string& error) {
+    if (block_.empty()) return true;
+    SE_SCOPED_TIMER("index_flush");
+
+    std::error_code ec;
+    fs::create_directories(temp_dir_, ec);
+    std::string path = (fs::path(temp_dir_) / ("run_" + std::to_string(run_paths_.size()) + ".tmp")).string();
+
+    std::vector<std::pair<const std::string, std::vector<Entry>>*> sorted;
+    sorted.reserve(block_.size());
+    for (auto& item : block_) sorted.push_back(&item);
+    std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+
+    PostingFileWriter writer;
+    if (!writer.open(path, doc_count_, error)) return false;
+    run_paths_.push_back(path);
+    for (const auto* item : sorted) writer.write(item->first, item->second);
+    if (!writer.close(error)) return false;
+
+    block_.clear();
+    block_.rehash(0);
+    block_bytes_ = 0;
+    SE_COUNTER_ADD("index_runs", 1);
+    return true;
+}
+
+bool ExternalIndexBuilder::finish(const std::string& index_path, std::string& error) {
+    if (!FlushRun(error)) return false;
+    SE_SCOPED_TIMER("index_merge");
+
+    std::vector<std::unique_ptr<PostingFileReader>> readers;
+    for (const auto& path : run_paths_) {
+        readers.push_back(std::make_unique<PostingFileReader>());
+        if (!readers.back()->open(path, error)) return false;
+    }
+
+    // Куча по (слово, номер прогона): прогоны идут по возрастанию doc_id,
+    // поэтому списки одного слова склеиваются в порядке прогонов
+    using Head = std::pair<std::string, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+    auto advance = [&](size_t run) {
+        if (readers[run]->next()) {
+            heap.emplace(readers[run]->word(), run);
+            return true;
+        }
+        if (readers[run]->failed()) {
+            error = "Corrupted index run: " + run_paths_[run];
+            return false;
+        }
+        return true;
+    };
+    for (size_t run = 0; run < readers.size(); ++run) {
+        if (!advance(run)) return false;
+    }
+
+    PostingFileWriter writer;
+    if (!writer.open(index_path, doc_count_, error)) return false;
+
+    std::vector<Entry> merged;
+    while (!heap.empty()) {
+        std::string word = heap.top().first;
+        merged.clear();
+        while (!heap.empty() && heap.top().first == word) {
+            size_t run = heap.top().second;
+            heap.pop();
+            const auto& entries = readers[run]->entries();
+            merged.insert(merged.end(), entries.begin(), entries.end());
+            if (!advance(run)) return false;
+        }
+        writer.write(word, merged);
+    }
+    if (!writer.close(error)) return false;
+
+    readers.clear();
+    RemoveRuns();
+    return true;
+}
+
+void ExternalIndexBuilder::RemoveRuns() {
+    std::error_code ec;
+    for (const auto& path : run_paths_) fs::remove(path, ec);
+}
+
+std::optional<std::string> CreateUniqueTempDirectory(const std::string& prefix) {
+    std::error_code ec;
+    fs::path base = fs::temp_directory_path(ec);
+    if (ec) return std::nullopt;
+    std::mt19937_64 random(std::random_device{}());
+    for (int attempt = 0; attempt < 100; ++attempt) {
+        fs::path dir = base / (prefix + std::to_string(random()));
+        // create_directory возвращает false, если каталог уже существует
+        if (fs::create_directory(dir, ec)) return dir.string();
+        if (ec) return std::nullopt;
+    }
+    return std::nullopt;
+}
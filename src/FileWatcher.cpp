@@ -0,0 +1,209 @@
+#include "FileWatcher.h"
+#include "Stats.h"
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+#ifdef SEARCH_ENGINE_INOTIFY
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+FileWatcher::FileWatcher(std::vector<std::string> paths, WatchOptions options)
+    : paths_(std::move(paths)), options_(options) {}
+
+FileWatcher::~FileWatcher() {
+    stop();
+}
+
+bool FileWatcher::start(ChangeHandler on_change, std::string& error) {
+    if (thread_.joinable()) {
+        error = "File watcher is already running";
+        return false;
+    }
+    on_change_ = std::move(on_change);
+    stop_.store(false);
+    pending_.assign(paths_.size(), false);
+    pending_count_ = 0;
+
+    // Без inotify — опрос; ошибка inotify тоже не мешает наблюдению
+    std::string ignored;
+    if (options_.force_polling || !openInotify(ignored)) {
+        states_.clear();
+        for (const auto& path : paths_) states_.push_back(ReadState(path));
+        next_poll_ = Clock::now() + options_.poll_interval;
+    }
+    thread_ = std::thread([this]() { run(); });
+    return true;
+}
+
+void FileWatcher::stop() {
+    if (!thread_.joinable()) return;
+    stop_.store(true);
+#ifdef SEARCH_ENGINE_INOTIFY
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = ::write(wake_fd_, &one, sizeof(one));
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex_);
+        stop_cv_.notify_all();
+    }
+    thread_.join();
+    closeInotify();
+}
+
+void FileWatcher::run() {
+    for (;;) {
+        Clock::duration timeout = std::chrono::hours(1);
+        if (pending_count_ > 0) {
+            const auto now = Clock::now();
+            const auto deadline = std::min(last_event_ + options_.debounce, first_event_ + options_.max_delay);
+            if (now >= deadline) {
+                std::vector<size_t> changed;
+                changed.reserve(pending_count_);
+                for (size_t i = 0; i < pending_.size(); ++i) {
+                    if (pending_[i]) changed.push_back(i);
+                }
+                pending_.assign(paths_.size(), false);
+                pending_count_ = 0;
+                SE_COUNTER_ADD("watch_batches", 1);
+                on_change_(changed);
+                continue;
+            }
+            timeout = deadline - now;
+        }
+        if (!(usesInotify() ? waitInotify(timeout) : waitPolling(timeout))) return;
+    }
+}
+
+void FileWatcher::markChanged(size_t index) {
+    const auto now = Clock::now();
+    if (!pending_[index]) {
+        pending_[index] = true;
+        if (pending_count_++ == 0) first_event_ = now;
+    }
+    last_event_ = now;
+}
+
+bool FileWatcher::waitPolling(Clock::duration timeout) {
+    {
+        std::unique_lock<std::mutex> lock(stop_mutex_);
+        const auto until = std::min(Clock::now() + timeout, next_poll_);
+        if (stop_cv_.wait_until(lock, until, [this]() { return stop_.load(); })) return false;
+    }
+    if (Clock::now() < next_poll_) return true;
+
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        FileState state = ReadState(paths_[i]);
+        if (state == states_[i]) continue;
+        states_[i] = state;
+        markChanged(i);
+    }
+    next_poll_ = Clock::now() + options_.poll_interval;
+    return true;
+}
+
+FileWatcher::FileState FileWatcher::ReadState(const std::string& path) {
+    FileState state;
+    std::error_code ec;
+    const auto size = fs::file_size(path, ec);
+    if (ec) return state;
+    const auto mtime = fs::last_write_time(path, ec);
+    if (ec) return state;
+    state.size = static_cast<int64_t>(size);
+    state.mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+    return state;
+}
+
+#ifdef SEARCH_ENGINE_INOTIFY
+
+bool FileWatcher::openInotify(std::string& error) {
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotify_fd_ < 0 || wake_fd_ < 0) {
+        error = "inotify is not available";
+        closeInotify();
+        return false;
+    }
+
+    // Каталоги, а не сами файлы: редакторы сохраняют файл через новый inode
+    constexpr uint32_t kMask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE | IN_DELETE
+                             | IN_MOVED_FROM | IN_MOVED_TO;
+    std::unordered_map<std::string, int> directories;
+    for (size_t i = 0; i < paths_.size(); ++i) {
+        std::error_code ec;
+        fs::path path = fs::absolute(paths_[i], ec).lexically_normal();
+        const std::string directory = path.parent_path().string();
+        auto it = directories.find(directory);
+        if (it == directories.end()) {
+            int wd = inotify_add_watch(inotify_fd_, directory.c_str(), kMask);
+            if (wd < 0) {
+                error = "Cannot watch directory: " + directory;
+                closeInotify();
+                return false;
+            }
+            it = directories.emplace(directory, wd).first;
+        }
+        watched_[it->second][path.filename().string()].push_back(i);
+    }
+    return true;
+}
+
+void FileWatcher::closeInotify() {
+    if (inotify_fd_ >= 0) ::close(inotify_fd_);
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    inotify_fd_ = wake_fd_ = -1;
+    watched_.clear();
+}
+
+bool FileWatcher::waitInotify(Clock::duration timeout) {
+    pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    const auto ms = std::chrono::ceil<std::chrono::milliseconds>(timeout).count();
+    int ready = ::poll(fds, 2, static_cast<int>(std::min<int64_t>(ms, INT32_MAX)));
+    if (stop_.load() || (ready > 0 && (fds[1].revents & POLLIN))) return false;
+    if (ready <= 0 || !(fds[0].revents & POLLIN)) return true;
+
+    alignas(inotify_event) char buffer[16 << 10];
+    for (;;) {
+        ssize_t length = ::read(inotify_fd_, buffer, sizeof(buffer));
+        if (length <= 0) break;
+        for (char* p = buffer; p < buffer + length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+            SE_COUNTER_ADD("watch_events", 1);
+            if (event->mask & IN_Q_OVERFLOW) {
+                // События потеряны: проверяются все файлы
+                for (size_t i = 0; i < paths_.size(); ++i) markChanged(i);
+                continue;
+            }
+            if (event->len == 0) continue;
+            auto dir = watched_.find(event->wd);
+            if (dir == watched_.end()) continue;
+            auto file = dir->second.find(event->name);
+            if (file == dir->second.end()) continue;
+            for (size_t i : file->second) markChanged(i);
+        }
+    }
+    return true;
+}
+
+#else
+
+bool FileWatcher::openInotify(std::string& error) {
+    error = "Built without inotify support";
+    return false;
+}
+
+void FileWatcher::closeInotify() {}
+
+bool FileWatcher::waitInotify(Clock::duration) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#include "IndexFile.h"
+
+namespace {
+
+constexpr char kMagic[4] = {'S', 'E', 'P', 'L'};
+constexpr uint64_t kVersion = 1;
+
+} // namespace
+
+bool PostingFileWriter::open(const std::string& path, size_t doc_count, std::string& error) {
+    out_.open(path, std::ios::binary | std::ios::trunc);
+    if (!out_.is_open()) {
+        error = "Cannot create index file: " + path;
+        return false;
+    }
+    path_ = path;
+    out_.write(kMagic, sizeof(kMagic));
+    putVarint(kVersion);
+    putVarint(doc_count);
+    return true;
+}
+
+void PostingFileWriter::putVarint(uint64_t value) {
+    while (value >= 0x80) {
+        out_.put(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out_.put(static_cast<char>(value));
+}
+
+void PostingFileWriter::write(const std::string& word, const std::vector<Entry>& entries) {
+    putVarint(word.size());
+    out_.write(word.data(), static_cast<std::streamsize>(word.size()));
+    putVarint(entries.size());
+    size_t prev = 0;
+    for (const auto& e : entries) {
+        putVarint(e.doc_id - prev);
+        putVarint(e.count);
+        prev = e.doc_id;
+    }
+}
+
+bool PostingFileWriter::close(std::string& error) {
+    out_.close();
+    if (out_.fail()) {
+        error = "Failed to write index file: " + path_;
+        return false;
+    }
+    return true;
+}
+
+bool PostingFileReader::open(const std::string& path, std::string& error) {
+    in_.open(path, std::ios::binary);
+    if (!in_.is_open()) {
+        error = "Index file not found: " + path;
+        return false;
+    }
+
+    char magic[sizeof(kMagic)];
+    uint64_t version = 0, doc_count = 0;
+    if (!in_.read(magic, sizeof(magic)) || std::string(magic, sizeof(magic)) != std::string(kMagic, sizeof(kMagic))
+        || !getVarint(version) || version != kVersion || !getVarint(doc_count)) {
+        error = "Invalid index file: " + path;
+        return false;
+    }
+    doc_count_ = static_cast<size_t>(doc_count);
+    return true;
+}
+
+bool PostingFileReader::getVarint(uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = in_.get();
+        if (c == std::char_traits<char>::eof()) return false;
+        value |= static_cast<uint64_t>(c & 0x7F) << shift;
+        if (!(c & 0x80)) return true;
+    }
+    return false;
+}
+
+bool PostingFileReader::next() {
+    // Конец файла допустим только на границе записи
+    if (in_.peek() == std::char_traits<char>::eof()) return false;
+
+    uint64_t len = 0, count = 0;
+    if (!getVarint(len)) {
+        failed_ = true;
+        return false;
+    }
+    word_.resize(static_cast<size_t>(len));
+    if (!in_.read(word_.data(), static_cast<std::streamsize>(len)) || !getVarint(count)) {
+        failed_ = true;
+        return false;
+    }
+
+    entries_.clear();
+    entries_.reserve(static_cast<size_t>(count));
+    DocId doc_id = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t delta = 0, freq = 0;
+        if (!getVarint(delta) || !getVarint(freq)) {
+            failed_ = true;
+            return false;
+        }
+        doc_id += static_cast<DocId>(delta);
+        entries_.push_back({doc_id, static_cast<TermCount>(freq)});
+    }
+    return true;
+}
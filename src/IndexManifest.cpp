@@ -0,0 +1,159 @@
+#include "IndexManifest.h"
+#include "DocumentLoader.h"
+#include "Hash.h"
+#include "Stats.h"
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr int kManifestVersion = 1;
+
+} // namespace
+
+bool SaveManifest(const std::string& path, const IndexManifest& manifest, std::string& error) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        error = "Cannot create manifest file: " + path;
+        return false;
+    }
+    char line[64];
+    std::snprintf(line, sizeof(line), "SEMF %d %016" PRIx64 " %" PRId64 "\n", kManifestVersion, manifest.settings,
+                  manifest.saved_at);
+    out << line;
+    // Путь — в конце строки: может содержать пробелы
+    for (const auto& file : manifest.files) {
+        std::snprintf(line, sizeof(line), "%" PRIu64 " %" PRId64 " %016" PRIx64 " ", file.size, file.mtime, file.hash);
+        out << line << file.path << '\n';
+    }
+    out.close();
+    if (out.fail()) {
+        error = "Failed to write manifest file: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool LoadManifest(const std::string& path, IndexManifest& manifest, std::string& error) {
+    std::ifstream in(path);
+    if (!in.is_open()) {
+        error = "Manifest file not found: " + path;
+        return false;
+    }
+
+    std::string line;
+    int version = 0;
+    unsigned long long settings = 0;
+    long long saved_at = 0;
+    if (!std::getline(in, line) || std::sscanf(line.c_str(), "SEMF %d %llx %lld", &version, &settings, &saved_at) != 3
+        || version != kManifestVersion) {
+        error = "Unsupported manifest file: " + path;
+        return false;
+    }
+
+    IndexManifest loaded;
+    loaded.settings = settings;
+    loaded.saved_at = saved_at;
+    while (std::getline(in, line)) {
+        FileFingerprint file;
+        unsigned long long size = 0, hash = 0;
+        long long mtime = 0;
+        int consumed = 0;
+        if (std::sscanf(line.c_str(), "%llu %lld %llx %n", &size, &mtime, &hash, &consumed) != 3) {
+            error = "Corrupted manifest file: " + path;
+            return false;
+        }
+        file.size = size;
+        file.mtime = mtime;
+        file.hash = hash;
+        file.path = line.substr(static_cast<size_t>(consumed));
+        loaded.files.push_back(std::move(file));
+    }
+    manifest = std::move(loaded);
+    return true;
+}
+
+bool ReloadIndex(InvertedIndex& index, const std::vector<std::string>& paths, const std::string& index_path,
+                 ReloadStats& stats, std::string& error) {
+    SE_SCOPED_TIMER("index_reload");
+    stats = ReloadStats{};
+    const std::string manifest_path = index_path + ".manifest";
+    // Время — до первого обращения к файлам: всё, что изменено в эту секунду
+    // или позже, при следующей проверке будет перечитано. Ядро ставит mtime по
+    // грубым часам, которые отстают от system_clock, поэтому секунда — с запасом
+    const int64_t started_at = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() - 1;
+
+    // Позиции и тексты документов в файле индекса не сохраняются
+    if (index.hasPositions() || index.documentStorePolicy() != DocumentStorePolicy::None) {
+        stats.full_rebuild = true;
+        stats.files_read = stats.files_changed = paths.size();
+        index.updateDocumentBase(paths);
+        return true;
+    }
+
+    IndexManifest previous;
+    std::string ignored;
+    bool usable = LoadManifest(manifest_path, previous, ignored) && previous.settings == index.settingsFingerprint()
+               && previous.files.size() == paths.size();
+    for (size_t i = 0; usable && i < paths.size(); ++i) usable = previous.files[i].path == paths[i];
+    usable = usable && index.loadFromFile(index_path, ignored) && index.documentCount() == paths.size();
+
+    if (!usable) {
+        stats.full_rebuild = true;
+        stats.files_read = stats.files_changed = paths.size();
+        index.updateDocumentBase(paths);
+    } else {
+        // Сначала отпечатки всех файлов, затем переиндексация изменившихся
+        DocumentTable table;
+        table.reset(paths.size());
+        std::vector<size_t> changed;
+        std::vector<std::string> texts;
+        std::vector<std::string> changed_paths;
+        std::vector<int64_t> changed_mtimes;
+        for (size_t i = 0; i < paths.size(); ++i) {
+            FileFingerprint file = previous.files[i];
+            std::error_code ec;
+            const uint64_t size = fs::file_size(paths[i], ec);
+            int64_t mtime = FileModificationTime(paths[i]);
+            if (ec || size != file.size || mtime != file.mtime || mtime == 0 || mtime >= previous.saved_at) {
+                std::string text, read_error;
+                if (ReadWholeFile(paths[i], text, read_error, &mtime)) {
+                    ++stats.files_read;
+                } else {
+                    // Как при полном построении: документ индексируется пустым
+                    std::cerr << read_error << "\n";
+                    text.clear();
+                    mtime = 0;
+                }
+                const uint64_t hash = XXH64(text);
+                file.mtime = mtime;
+                if (hash != file.hash || text.size() != file.size) {
+                    file.size = text.size();
+                    file.hash = hash;
+                    changed.push_back(i);
+                    texts.push_back(std::move(text));
+                    changed_paths.push_back(paths[i]);
+                    changed_mtimes.push_back(mtime);
+                }
+            }
+            table.setFingerprint(i, file);
+        }
+        index.setDocumentTable(std::move(table));
+        index.reindexDocuments(changed, texts, changed_paths, changed_mtimes);
+        stats.files_changed = changed.size();
+    }
+
+    IndexManifest manifest;
+    manifest.settings = index.settingsFingerprint();
+    manifest.saved_at = started_at;
+    const DocumentTable& table = index.documentTable();
+    for (size_t i = 0; i < table.size(); ++i) manifest.files.push_back(table.fingerprint(i));
+    return index.saveToFile(index_path, error) && SaveManifest(manifest_path, manifest, error);
+}
@@ -0,0 +1,24 @@
+#include "IndexSnapshots.h"
+#include <utility>
+
+IndexSnapshots::IndexSnapshots(std::shared_ptr<const InvertedIndex> initial)
+    : current(std::move(initial)) {}
+
+void IndexSnapshots::publish(std::shared_ptr<const InvertedIndex> next) {
+    current.store(std::move(next), std::memory_order_release);
+    published.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void IndexSnapshots::rebuild(const std::function<void(InvertedIndex&)>& build) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    auto next = std::make_shared<InvertedIndex>();
+    build(*next);
+    publish(std::move(next));
+}
+
+void IndexSnapshots::update(const std::function<void(InvertedIndex&)>& change) {
+    std::lock_guard<std::mutex> lock(writer_mutex);
+    auto next = std::make_shared<InvertedIndex>(*acquire());
+    change(*next);
+    publish(std::move(next));
+}
@@ -0,0 +1,56 @@
+#include "IndexWatcher.h"
+#include "DocumentLoader.h"
+#include "Hash.h"
+#include "Stats.h"
+
+IndexWatcher::IndexWatcher(std::shared_ptr<IndexSnapshots> snapshots, WatchOptions options)
+    : snapshots_(std::move(snapshots)), watcher_(DocumentPaths(*snapshots_->acquire()), options) {}
+
+std::vector<std::string> IndexWatcher::DocumentPaths(const InvertedIndex& index) {
+    const DocumentTable& table = index.documentTable();
+    std::vector<std::string> paths(table.size());
+    for (size_t i = 0; i < table.size(); ++i) paths[i] = table.path(i);
+    return paths;
+}
+
+bool IndexWatcher::start(std::string& error, UpdateHandler on_update) {
+    return watcher_.start([this, on_update = std::move(on_update)](const std::vector<size_t>& changed) {
+        ReloadStats stats = apply(changed);
+        if (on_update) on_update(stats);
+    }, error);
+}
+
+ReloadStats IndexWatcher::apply(const std::vector<size_t>& changed) {
+    SE_SCOPED_TIMER("watch_update");
+    ReloadStats stats;
+    // Версию меняет только этот поток, поэтому сравнивать можно с текущей
+    std::shared_ptr<const InvertedIndex> current = snapshots_->acquire();
+    const DocumentTable& table = current->documentTable();
+
+    std::vector<size_t> doc_ids;
+    std::vector<std::string> texts;
+    std::vector<std::string> paths;
+    std::vector<int64_t> mtimes;
+    for (size_t doc_id : changed) {
+        if (doc_id >= table.size() || table.path(doc_id).empty()) continue;
+        const std::string& path = table.path(doc_id);
+        std::string text, error;
+        int64_t mtime = 0;
+        if (ReadWholeFile(path, text, error, &mtime)) {
+            ++stats.files_read;
+        } else {
+            text.clear();
+        }
+        const FileFingerprint before = table.fingerprint(doc_id);
+        if (text.size() == before.size && XXH64(text) == before.hash) continue;
+        doc_ids.push_back(doc_id);
+        texts.push_back(std::move(text));
+        paths.push_back(path);
+        mtimes.push_back(mtime);
+    }
+    stats.files_changed = doc_ids.size();
+    if (doc_ids.empty()) return stats;
+
+    snapshots_->update([&](InvertedIndex& index) { index.reindexDocuments(doc_ids, texts, paths, mtimes); });
+    return stats;
+}
@@ -1,120 +1,627 @@
 #include "InvertedIndex.h"
 #include "ThreadPool.h"
+#include "DocumentLoader.h"
+#include "Hash.h"
+#include "IndexFile.h"
+#include "Stats.h"
+#include "Tokenizer.h"
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <algorithm>
 #include <future>
 #include <mutex>
+#include <numeric>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
-#include <cctype>
 
-bool is_valid_word(const std::string& word) {
-    if (word.empty() || word.size() > 100) {
-        return false;
-    }
-    for (char c : word) {
-        if (!std::isalpha(static_cast<unsigned char>(c))) {
-            return false;
-        }
-    }
-    return true;
-}
+void InvertedIndex::updateDocumentBaseFromStrings(const std::vector<std::string>& docs_input,
+                                                  const std::vector<std::string>& source_paths) {
+    SE_SCOPED_TIMER("index_build");
 
-void InvertedIndex::updateDocumentBaseFromStrings(const std::vector<std::string>& docs_input) {
-    documents = docs_input;
+    auto& memory = MemoryCounterFor<IndexMemoryTag>();
     freq_dictionary.clear();
+    position_dictionary.clear();
+    doc_count = docs_input.size();
+    forward = ForwardIndex{};
+    documents.reset(doc_count);
+    document_table.reset(doc_count);
+    document_table.setFields(*document_fields);
+    size_t baseline = memory.current();
+    memory.resetPeak();
 
-    for (size_t i = 0; i < documents.size(); ++i) {
-        auto index = BuildIndexForDocument(documents[i], i);
-        for (auto& [word, entries] : index) {
-            freq_dictionary[word].insert(freq_dictionary[word].end(), entries.begin(), entries.end());
+    TermPostings building;
+    std::unordered_map<std::string, PositionList> building_positions;
+    for (size_t i = 0; i < docs_input.size(); ++i) {
+        const std::string& source_path = i < source_paths.size() ? source_paths[i] : std::string();
+        documents.set(i, docs_input[i], source_path);
+        // Текст прочитан вызывающим: время изменения берётся как есть сейчас
+        document_table.set(i, source_path, docs_input[i], source_path.empty() ? 0 : FileModificationTime(source_path));
+        auto index = BuildIndexForDocument(docs_input[i], i);
+        for (auto& [word, entries] : index.postings) {
+            building[word].append(entries);
+        }
+        for (auto& [word, encoded] : index.positions) {
+            building_positions[word].appendEncoded(encoded);
         }
     }
+    freq_dictionary.reserve(building.size());
+    for (auto it = building.begin(); it != building.end(); it = building.erase(it)) {
+        freq_dictionary.assign(it->first, std::make_shared<const CompressedPostings>(it->second));
+    }
+    position_dictionary.reserve(building_positions.size());
+    for (auto& [word, list] : building_positions) {
+        position_dictionary.assign(word, std::make_shared<const PositionList>(std::move(list)));
+    }
+    BuildTermDictionary();
+    BuildPairIndex();
+    peak_build_bytes = memory.peak() - baseline;
 }
 
 void InvertedIndex::updateDocumentBase(const std::vector<std::string>& file_paths) {
-    documents.clear();
-    freq_dictionary.clear();
-    documents.resize(file_paths.size());
+    SE_SCOPED_TIMER("index_build");
 
-    std::vector<std::unordered_map<std::string, std::vector<Entry>>> partial_indices(file_paths.size());
+    auto& memory = MemoryCounterFor<IndexMemoryTag>();
+    freq_dictionary.clear();
+    position_dictionary.clear();
+    doc_count = file_paths.size();
+    forward = ForwardIndex{};
+    documents.reset(doc_count);
+    document_table.reset(doc_count);
+    document_table.setFields(*document_fields);
+    size_t baseline = memory.current();
+    memory.resetPeak();
 
-    ThreadPool pool(std::thread::hardware_concurrency());
-    std::vector<std::future<void>> futures;
-
-    for (size_t i = 0; i < file_paths.size(); ++i) {
-        futures.emplace_back(pool.enqueue([this, &file_paths, i, &partial_indices]() {
-            std::ifstream file(file_paths[i]);
-            if (!file.is_open()) {
-                std::cerr << "Failed to open file: " << file_paths[i] << "\n";
-                return;
-            }
+    std::vector<PartialIndex> partial_indices(file_paths.size());
+    std::vector<int64_t> mtimes(file_paths.size(), 0);
 
-            std::stringstream buffer;
-            buffer << file.rdbuf();
-            documents[i] = buffer.str();
+    // Чтение файлов идёт параллельно с их разбором
+    DocumentLoader loader;
+    loader.run(file_paths,
+               [this, &file_paths, &partial_indices, &mtimes](size_t i, std::string& text) {
+                   partial_indices[i] = BuildIndexForDocument(text, i);
+                   document_table.set(i, file_paths[i], text, mtimes[i]);
+                   documents.set(i, text, file_paths[i]);
+               },
+               [this, &file_paths](size_t i, const std::string& error) {
+                   // Непрочитанный файл остаётся в таблице пустым: путь нужен
+                   // манифесту и наблюдению, чтобы заметить его появление
+                   std::cerr << error << "\n";
+                   document_table.set(i, file_paths[i], {}, 0);
+               },
+               &mtimes);
 
-            partial_indices[i] = BuildIndexForDocument(documents[i], i);
-        }));
-    }
+    ThreadPool pool(std::thread::hardware_concurrency());
 
-    for (auto& f : futures) f.get();
+    SE_SCOPED_TIMER("index_merge");
 
     std::unordered_set<std::string> all_words;
     for (const auto& partial : partial_indices) {
-        for (const auto& [word, _] : partial) {
+        for (const auto& [word, _] : partial.postings) {
             all_words.insert(word);
         }
     }
 
     std::mutex dict_mutex;
     std::vector<std::future<void>> merge_futures;
+    freq_dictionary.reserve(all_words.size());
+    if (positional) position_dictionary.reserve(all_words.size());
 
     for (const auto& word : all_words) {
         merge_futures.emplace_back(pool.enqueue([&partial_indices, &word, this, &dict_mutex]() {
-            std::vector<Entry> combined_entries;
+            PostingList combined_entries;
+            PositionList combined_positions;
             for (const auto& partial : partial_indices) {
-                auto it = partial.find(word);
-                if (it != partial.end()) {
-                    combined_entries.insert(combined_entries.end(), it->second.begin(), it->second.end());
+                auto it = partial.postings.find(word);
+                if (it != partial.postings.end()) {
+                    combined_entries.append(it->second);
+                }
+                auto pos_it = partial.positions.find(word);
+                if (pos_it != partial.positions.end()) {
+                    combined_positions.appendEncoded(pos_it->second);
                 }
             }
 
+            CompressedPostings compressed(combined_entries);
+            combined_entries = PostingList();
+
             std::lock_guard<std::mutex> lock(dict_mutex);
-            freq_dictionary[word] = std::move(combined_entries);
+            freq_dictionary.assign(word, std::make_shared<const CompressedPostings>(std::move(compressed)));
+            if (positional) {
+                position_dictionary.assign(word, std::make_shared<const PositionList>(std::move(combined_positions)));
+            }
         }));
     }
 
     for (auto& f : merge_futures) f.get();
+
+    partial_indices.clear();
+    BuildTermDictionary();
+    BuildPairIndex();
+    peak_build_bytes = memory.peak() - baseline;
+}
+
+bool InvertedIndex::loadFromFile(const std::string& path, std::string& error) {
+    SE_SCOPED_TIMER("index_load");
+
+    PostingFileReader reader;
+    if (!reader.open(path, error)) return false;
+
+    ShardedMap<CompressedTermPostings> loaded;
+    Postings postings;
+    bool corrupted = false;
+    while (!corrupted && reader.next()) {
+        postings.doc_ids.clear();
+        postings.counts.clear();
+        for (const auto& e : reader.entries()) {
+            if (e.doc_id >= reader.documentCount()) {
+                corrupted = true;
+                break;
+            }
+            postings.push_back(e.doc_id, e.count);
+        }
+        loaded.assign(reader.word(), std::make_shared<const CompressedPostings>(postings));
+    }
+    if (corrupted || reader.failed()) {
+        error = "Corrupted index file: " + path;
+        return false;
+    }
+
+    freq_dictionary = std::move(loaded);
+    forward = ForwardIndex{};
+    position_dictionary.clear();
+    positional = false;
+    doc_count = reader.documentCount();
+    documents.reset(doc_count);
+    document_table.reset(doc_count);
+    document_table.setFields(*document_fields);
+    BuildTermDictionary();
+    BuildPairIndex();
+    peak_build_bytes = 0;
+    return true;
+}
+
+void InvertedIndex::reindexDocuments(const std::vector<size_t>& doc_ids, const std::vector<std::string>& texts,
+                                     const std::vector<std::string>& source_paths,
+                                     const std::vector<int64_t>& mtimes) {
+    SE_SCOPED_TIMER("index_update");
+    if (doc_ids.empty()) return;
+    if (!forward.built) BuildForwardIndex();
+
+    std::vector<size_t> changed = doc_ids;
+    std::sort(changed.begin(), changed.end());
+    auto is_changed = [&changed](size_t doc_id) { return std::binary_search(changed.begin(), changed.end(), doc_id); };
+
+    // Списки новых текстов; документы обходятся по возрастанию doc_id,
+    // поэтому списки и позиции слов сразу упорядочены
+    std::vector<size_t> order(doc_ids.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&doc_ids](size_t a, size_t b) { return doc_ids[a] < doc_ids[b]; });
+
+    // Слова, чьи списки меняются: прежние слова изменённых документов и новые
+    std::unordered_set<std::string> touched;
+    TermPostings added;
+    std::unordered_map<std::string, std::vector<std::string>> added_positions;
+    // Пары частых слов, бывших или ставших соседями по документу
+    std::set<std::pair<uint32_t, uint32_t>> affected_pairs;
+    std::vector<std::pair<size_t, FrequentCounts>> fresh_frequent;
+    std::vector<uint32_t> frequent;
+    for (size_t k : order) {
+        const size_t doc_id = doc_ids[k];
+        frequent.clear();
+        if (const auto& old_ids = forward.documents[doc_id]) {
+            for (uint32_t term_id : *old_ids) {
+                const IndexString& name = forward.names[term_id];
+                const std::string& word = *touched.emplace(name.data(), name.size()).first;
+                if (uint32_t id = PairWordId(word); id != UINT32_MAX) frequent.push_back(id);
+            }
+        }
+
+        const std::string& source_path = k < source_paths.size() ? source_paths[k] : std::string();
+        documents.set(doc_id, texts[k], source_path);
+        const int64_t mtime = k < mtimes.size() ? mtimes[k]
+                            : source_path.empty() ? 0 : FileModificationTime(source_path);
+        document_table.set(doc_id, source_path, texts[k], mtime);
+        auto index = BuildIndexForDocument(texts[k], doc_id);
+        TermIdList term_ids;
+        term_ids.reserve(index.postings.size());
+        FrequentCounts counts;
+        for (auto& [word, entries] : index.postings) {
+            term_ids.push_back(ForwardTermId(word));
+            touched.insert(word);
+            if (uint32_t id = PairWordId(word); id != UINT32_MAX) {
+                frequent.push_back(id);
+                counts.emplace_back(id, entries.counts.front());
+            }
+            added[word].append(entries);
+        }
+        forward.documents.mutableAt(doc_id) =
+            term_ids.empty() ? nullptr
+                             : std::allocate_shared<const TermIdList>(IndexAllocator<TermIdList>(), std::move(term_ids));
+        for (auto& [word, encoded] : index.positions) added_positions[word].push_back(std::move(encoded));
+
+        std::sort(frequent.begin(), frequent.end());
+        frequent.erase(std::unique(frequent.begin(), frequent.end()), frequent.end());
+        for (size_t a = 0; a < frequent.size(); ++a) {
+            for (size_t b = a + 1; b < frequent.size(); ++b) affected_pairs.emplace(frequent[a], frequent[b]);
+        }
+        std::sort(counts.begin(), counts.end());
+        if (!counts.empty()) fresh_frequent.emplace_back(doc_id, std::move(counts));
+    }
+
+    // Перекодируются только списки, которых касаются изменения
+    std::vector<std::string> new_words, removed_words;
+    Postings old;
+    for (const std::string& word : touched) {
+        const SharedPostings* current = freq_dictionary.find(word);
+        auto added_it = added.find(word);
+        if (!current) continue;  // новое слово — ниже
+        old.doc_ids.clear();
+        old.counts.clear();
+        (*current)->decode(old);
+        SE_COUNTER_ADD("postings_reencoded", 1);
+
+        const PositionList* old_positions = positional ? getPositionList(word) : nullptr;
+        static const PostingList kNone;
+        const PostingList& fresh = added_it != added.end() ? added_it->second : kNone;
+        const std::vector<std::string>* fresh_positions = nullptr;
+        if (positional && added_it != added.end()) fresh_positions = &added_positions[word];
+
+        PostingList merged;
+        PositionList merged_positions;
+        std::string encoded;
+        size_t i = 0, j = 0;
+        while (i < old.size() || j < fresh.size()) {
+            if (i < old.size() && is_changed(old.doc_ids[i])) {
+                ++i;
+            } else if (j == fresh.size() || (i < old.size() && old.doc_ids[i] < fresh.doc_ids[j])) {
+                merged.push_back(old.doc_ids[i], old.counts[i]);
+                if (old_positions) {
+                    encoded.clear();
+                    EncodePositions(old_positions->decode(i), encoded);
+                    merged_positions.appendEncoded(encoded);
+                }
+                ++i;
+            } else {
+                merged.push_back(fresh.doc_ids[j], fresh.counts[j]);
+                if (fresh_positions) merged_positions.appendEncoded((*fresh_positions)[j]);
+                ++j;
+            }
+        }
+        if (added_it != added.end()) added.erase(added_it);
+
+        if (merged.empty()) {
+            // Слово исчезло из всех документов: его номер освобождается
+            const uint32_t term_id = *forward.ids.find(word);
+            forward.ids.erase(word);
+            forward.names.mutableAt(term_id).clear();
+            forward.free_ids.push_back(term_id);
+            position_dictionary.erase(word);
+            freq_dictionary.erase(word);
+            removed_words.push_back(word);
+            continue;
+        }
+        // Новые списки вместо изменения старых: их ещё читают прежние версии индекса
+        if (positional) position_dictionary.assign(word, std::make_shared<const PositionList>(std::move(merged_positions)));
+        freq_dictionary.assign(word, std::make_shared<const CompressedPostings>(merged));
+    }
+
+    // Слова, которых в индексе ещё не было
+    for (auto& [word, entries] : added) {
+        freq_dictionary.assign(word, std::make_shared<const CompressedPostings>(entries));
+        new_words.push_back(word);
+        if (!positional) continue;
+        PositionList list;
+        for (const auto& encoded_positions : added_positions[word]) list.appendEncoded(encoded_positions);
+        position_dictionary.assign(word, std::make_shared<const PositionList>(std::move(list)));
+    }
+
+    term_dictionary.update(std::move(new_words), std::move(removed_words));
+    UpdatePairIndex(changed, {affected_pairs.begin(), affected_pairs.end()}, fresh_frequent);
+}
+
+bool InvertedIndex::saveToFile(const std::string& path, std::string& error) const {
+    SE_SCOPED_TIMER("index_save");
+
+    PostingFileWriter writer;
+    if (!writer.open(path, doc_count, error)) return false;
+    std::vector<std::string> words;
+    words.reserve(freq_dictionary.size());
+    freq_dictionary.forEach([&words](const std::string& word, const SharedPostings&) { words.push_back(word); });
+    std::sort(words.begin(), words.end());
+    for (const auto& word : words) writer.write(word, getWordCount(word));
+    return writer.close(error);
 }
 
 std::vector<Entry> InvertedIndex::getWordCount(const std::string& word) const {
-    auto it = freq_dictionary.find(word);
-    return (it != freq_dictionary.end()) ? it->second : std::vector<Entry>{};
+    return getPostings(word).entries();
+}
+
+Postings InvertedIndex::getPostings(const std::string& word) const {
+    Postings postings;
+    if (const SharedPostings* list = freq_dictionary.find(word)) (*list)->decode(postings);
+    return postings;
+}
+
+const CompressedPostings* InvertedIndex::findPostings(const std::string& word) const {
+    const SharedPostings* list = freq_dictionary.find(word);
+    return list ? list->get() : nullptr;
+}
+
+size_t InvertedIndex::documentFrequency(const std::string& word) const {
+    const SharedPostings* list = freq_dictionary.find(word);
+    return list ? (*list)->size() : 0;
 }
 
-std::unordered_map<std::string, std::vector<Entry>>
-InvertedIndex::BuildIndexForDocument(const std::string& document, size_t doc_id) {
-    std::unordered_map<std::string, size_t> word_count;
-    std::stringstream ss(document);
-    std::string word;
+IndexMemoryUsage InvertedIndex::memoryUsage() const {
+    IndexMemoryUsage usage;
+    const size_t sso_capacity = std::string().capacity();
 
-    while (ss >> word) {
-        // Очистка слова от пунктуации
-        word.erase(std::remove_if(word.begin(), word.end(),
-                    [](char c) { return !std::isalnum(static_cast<unsigned char>(c)); }),
-                    word.end());
+    freq_dictionary.forEach([&usage, sso_capacity](const std::string& word, const SharedPostings& postings) {
+        if (word.capacity() > sso_capacity) {
+            usage.term_bytes += word.capacity() + 1;
+        }
+        usage.posting_bytes += postings->memoryBytes();
+    });
+
+    // Узел: указатель на следующий, пара ключ-значение и закешированный хеш
+    const size_t node_bytes = sizeof(void*) + sizeof(CompressedTermPostings::value_type) + sizeof(size_t);
+    usage.hash_table_bytes = freq_dictionary.tableBytes() + freq_dictionary.size() * node_bytes;
+
+    usage.position_bytes = position_dictionary.tableBytes();
+    position_dictionary.forEach([&usage, node_bytes](const std::string&, const SharedPositions& positions) {
+        usage.position_bytes += node_bytes + positions->memoryBytes();
+    });
+
+    usage.pair_bytes = pair_dictionary.tableBytes();
+    pair_dictionary.forEach([&usage, node_bytes](const std::string& key, const SharedPostings& postings) {
+        usage.pair_bytes += node_bytes + key.capacity() + postings->memoryBytes();
+    });
+
+    usage.dictionary_bytes = term_dictionary.memoryBytes();
+    usage.document_bytes = documents.memoryBytes();
+    usage.table_bytes = document_table.memoryBytes();
+    // Список номеров: управляющий блок shared_ptr, вектор и его элементы
+    usage.forward_bytes = forward.documents.memoryBytes() + forward.names.memoryBytes()
+                        + forward.ids.tableBytes() + forward.ids.size() * node_bytes
+                        + forward.free_ids.capacity() * sizeof(uint32_t);
+    for (size_t i = 0; i < forward.documents.size(); ++i) {
+        const auto& term_ids = forward.documents[i];
+        if (term_ids) usage.forward_bytes += 2 * sizeof(void*) + sizeof(TermIdList) + term_ids->capacity() * sizeof(uint32_t);
+    }
+    for (size_t i = 0; i < forward.names.size(); ++i) {
+        const IndexString& name = forward.names[i];
+        if (name.capacity() > sso_capacity) usage.forward_bytes += name.capacity() + 1;
+    }
+    forward.ids.forEach([&usage, sso_capacity](const std::string& word, uint32_t) {
+        if (word.capacity() > sso_capacity) usage.forward_bytes += word.capacity() + 1;
+    });
+
+    usage.peak_build_bytes = peak_build_bytes;
+    return usage;
+}
+
+void InvertedIndex::setDocumentStorePolicy(DocumentStorePolicy policy) {
+    documents.setPolicy(policy);
+}
+
+void InvertedIndex::setDocumentTable(DocumentTable table) {
+    document_table = std::move(table);
+    document_table.setFields(*document_fields);
+}
+
+std::optional<std::string> InvertedIndex::getDocument(size_t doc_id, size_t max_bytes) const {
+    return documents.get(doc_id, max_bytes);
+}
+
+void InvertedIndex::BuildTermDictionary() {
+    std::vector<std::string> words;
+    words.reserve(freq_dictionary.size());
+    freq_dictionary.forEach([&words](const std::string& word, const SharedPostings&) { words.push_back(word); });
+    term_dictionary.build(std::move(words));
+}
 
-        if (is_valid_word(word)) {
-            word_count[word]++;
+void InvertedIndex::setStopWords(const std::vector<std::string>& words) {
+    if (words.empty()) {
+        tokenizer_options.stop_words.reset();
+    } else {
+        tokenizer_options.stop_words = std::make_shared<const StopWordSet>(words.begin(), words.end());
+    }
+}
+
+void InvertedIndex::setStemming(const std::vector<StemLanguage>& languages) {
+    stem_languages = languages;
+    tokenizer_options.filters = languages.empty() ? nullptr : MakeStemmingPipeline(languages);
+    tokenizer_options.utf8_letters =
+        std::find(languages.begin(), languages.end(), StemLanguage::Russian) != languages.end();
+}
+
+uint64_t InvertedIndex::settingsFingerprint() const {
+    std::string settings = tokenizer_options.lowercase ? "lower;" : "case;";
+    for (StemLanguage language : stem_languages) settings += std::to_string(static_cast<int>(language)) + ",";
+    settings += ";";
+    if (tokenizer_options.stop_words) {
+        std::vector<std::string> words(tokenizer_options.stop_words->begin(), tokenizer_options.stop_words->end());
+        std::sort(words.begin(), words.end());
+        for (const auto& word : words) settings += word + '\0';
+    }
+    return XXH64(settings);
+}
+
+static std::string PairKey(const std::string& a, const std::string& b) {
+    return a < b ? a + '\0' + b : b + '\0' + a;
+}
+
+void InvertedIndex::BuildPairIndex() {
+    pair_dictionary.clear();
+    pair_words.clear();
+    if (pair_terms < 2) return;
+
+    SE_SCOPED_TIMER("pair_index_build");
+
+    // Самые частые слова (при равной частоте — по алфавиту)
+    std::vector<std::pair<size_t, const std::string*>> frequent;
+    frequent.reserve(freq_dictionary.size());
+    freq_dictionary.forEach([&frequent](const std::string& word, const SharedPostings& postings) {
+        frequent.emplace_back(postings->size(), &word);
+    });
+    const size_t n = std::min(pair_terms, frequent.size());
+    std::partial_sort(frequent.begin(), frequent.begin() + static_cast<std::ptrdiff_t>(n), frequent.end(),
+                      [](const auto& a, const auto& b) {
+                          return a.first > b.first || (a.first == b.first && *a.second < *b.second);
+                      });
+    for (size_t i = 0; i < n; ++i) pair_words.push_back(*frequent[i].second);
+    std::sort(pair_words.begin(), pair_words.end());
+
+    std::vector<Postings> lists(n);
+    for (size_t i = 0; i < n; ++i) (*freq_dictionary.find(*frequent[i].second))->decode(lists[i]);
+
+    Postings both;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = i + 1; j < n; ++j) {
+            const Postings& a = lists[i];
+            const Postings& b = lists[j];
+            both.doc_ids.clear();
+            both.counts.clear();
+            size_t x = 0, y = 0;
+            while (x < a.size() && y < b.size()) {
+                if (a.doc_ids[x] < b.doc_ids[y]) {
+                    ++x;
+                } else if (b.doc_ids[y] < a.doc_ids[x]) {
+                    ++y;
+                } else {
+                    both.push_back(a.doc_ids[x], a.counts[x] + b.counts[y]);
+                    ++x;
+                    ++y;
+                }
+            }
+            if (!both.empty()) {
+                pair_dictionary.assign(PairKey(*frequent[i].second, *frequent[j].second), std::make_shared<const CompressedPostings>(both));
+            }
+        }
+    }
+}
+
+void InvertedIndex::BuildForwardIndex() {
+    SE_SCOPED_TIMER("forward_index_build");
+
+    forward = ForwardIndex{};
+    forward.built = true;
+    forward.ids.reserve(freq_dictionary.size());
+    std::vector<TermIdList> term_ids(doc_count);
+    Postings postings;
+    freq_dictionary.forEach([this, &term_ids, &postings](const std::string& word, const SharedPostings& list) {
+        const auto id = static_cast<uint32_t>(forward.names.size());
+        forward.names.push_back(IndexString(word.data(), word.size()));
+        forward.ids.assign(word, id);
+        postings.doc_ids.clear();
+        postings.counts.clear();
+        list->decode(postings);
+        for (DocId doc_id : postings.doc_ids) term_ids[doc_id].push_back(id);
+    });
+    forward.documents.assign(doc_count);
+    for (size_t i = 0; i < doc_count; ++i) {
+        if (term_ids[i].empty()) continue;
+        term_ids[i].shrink_to_fit();
+        forward.documents.mutableAt(i) =
+            std::allocate_shared<const TermIdList>(IndexAllocator<TermIdList>(), std::move(term_ids[i]));
+    }
+}
+
+uint32_t InvertedIndex::ForwardTermId(const std::string& word) {
+    if (const uint32_t* id = forward.ids.find(word)) return *id;
+    uint32_t id;
+    if (!forward.free_ids.empty()) {
+        id = forward.free_ids.back();
+        forward.free_ids.pop_back();
+        forward.names.mutableAt(id).assign(word.data(), word.size());
+    } else {
+        id = static_cast<uint32_t>(forward.names.size());
+        forward.names.push_back(IndexString(word.data(), word.size()));
+    }
+    forward.ids.assign(word, id);
+    return id;
+}
+
+uint32_t InvertedIndex::PairWordId(const std::string& word) const {
+    auto it = std::lower_bound(pair_words.begin(), pair_words.end(), word);
+    return it != pair_words.end() && *it == word ? static_cast<uint32_t>(it - pair_words.begin()) : UINT32_MAX;
+}
+
+void InvertedIndex::UpdatePairIndex(const std::vector<size_t>& changed,
+                                    const std::vector<std::pair<uint32_t, uint32_t>>& affected,
+                                    const std::vector<std::pair<size_t, FrequentCounts>>& fresh) {
+    if (affected.empty()) return;
+    SE_SCOPED_TIMER("pair_index_update");
+
+    // Прежние записи изменённых документов заменяются записями новых текстов
+    Postings old, merged;
+    for (const auto& [a, b] : affected) {
+        const std::string key = PairKey(pair_words[a], pair_words[b]);
+        old.doc_ids.clear();
+        old.counts.clear();
+        if (const SharedPostings* list = pair_dictionary.find(key)) (*list)->decode(old);
+        merged.doc_ids.clear();
+        merged.counts.clear();
+        size_t i = 0;
+        for (const auto& [doc_id, counts] : fresh) {
+            for (; i < old.size() && old.doc_ids[i] < doc_id; ++i) {
+                if (!std::binary_search(changed.begin(), changed.end(), old.doc_ids[i])) {
+                    merged.push_back(old.doc_ids[i], old.counts[i]);
+                }
+            }
+            auto count_a = std::lower_bound(counts.begin(), counts.end(), std::make_pair(a, TermCount{0}));
+            auto count_b = std::lower_bound(counts.begin(), counts.end(), std::make_pair(b, TermCount{0}));
+            if (count_a != counts.end() && count_a->first == a && count_b != counts.end() && count_b->first == b) {
+                merged.push_back(static_cast<DocId>(doc_id), count_a->second + count_b->second);
+            }
+        }
+        for (; i < old.size(); ++i) {
+            if (!std::binary_search(changed.begin(), changed.end(), old.doc_ids[i])) {
+                merged.push_back(old.doc_ids[i], old.counts[i]);
+            }
+        }
+        if (merged.empty()) {
+            pair_dictionary.erase(key);
+        } else {
+            pair_dictionary.assign(key, std::make_shared<const CompressedPostings>(merged));
+        }
+    }
+}
+
+const CompressedPostings* InvertedIndex::findPairPostings(const std::string& a, const std::string& b) const {
+    if (pair_dictionary.empty()) return nullptr;
+    const SharedPostings* list = pair_dictionary.find(PairKey(a, b));
+    return list ? list->get() : nullptr;
+}
+
+const PositionList* InvertedIndex::getPositionList(const std::string& word) const {
+    const SharedPositions* list = position_dictionary.find(word);
+    return list ? list->get() : nullptr;
+}
+
+InvertedIndex::PartialIndex
+InvertedIndex::BuildIndexForDocument(const std::string& document, size_t doc_id) const {
+    SE_SCOPED_TIMER("tokenize");
+
+    std::unordered_map<std::string, TermCount> word_count;
+    std::unordered_map<std::string, std::vector<uint32_t>> word_positions;
+    uint32_t position = 0;
+
+    for (const auto& word : Tokenize(document, tokenizer_options)) {
+        word_count[word]++;
+        if (positional) {
+            word_positions[word].push_back(position);
         }
+        ++position;
     }
+    SE_COUNTER_ADD("documents_indexed", 1);
 
-    std::unordered_map<std::string, std::vector<Entry>> result;
+    PartialIndex result;
     for (const auto& [word, count] : word_count) {
-        result[word].push_back({doc_id, count});
+        result.postings[word].push_back(static_cast<DocId>(doc_id), count);
+    }
+    for (const auto& [word, positions] : word_positions) {
+        EncodePositions(positions, result.positions[word]);
     }
     return result;
 }
@@ -0,0 +1,41 @@
+#include "PositionList.h"
+
+void EncodePositions(const std::vector<uint32_t>& positions, std::string& out) {
+    uint32_t prev = 0;
+    for (uint32_t pos : positions) {
+        uint32_t delta = pos - prev;
+        prev = pos;
+        while (delta >= 0x80) {
+            out.push_back(static_cast<char>((delta & 0x7F) | 0x80));
+            delta >>= 7;
+        }
+        out.push_back(static_cast<char>(delta));
+    }
+}
+
+void PositionList::appendEncoded(const std::string& encoded) {
+    data_.insert(data_.end(), encoded.begin(), encoded.end());
+    ends_.push_back(static_cast<uint32_t>(data_.size()));
+}
+
+std::vector<uint32_t> PositionList::decode(size_t posting_index) const {
+    std::vector<uint32_t> positions;
+    if (posting_index >= ends_.size()) return positions;
+
+    size_t pos = posting_index == 0 ? 0 : ends_[posting_index - 1];
+    size_t end = ends_[posting_index];
+    uint32_t value = 0;
+    while (pos < end) {
+        uint32_t delta = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = data_[pos++];
+            delta |= static_cast<uint32_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while ((byte & 0x80) && pos < end);
+        value += delta;
+        positions.push_back(value);
+    }
+    return positions;
+}
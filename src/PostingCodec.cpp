@@ -0,0 +1,306 @@
+#include "PostingCodec.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define SE_X86_KERNELS
+#if defined(__GNUC__) || defined(__clang__)
+#define SE_AVX2_KERNELS
+#define SE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+constexpr size_t kHeaderBytes = 8;
+
+template <typename Out>
+void PutU32(Out& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+uint32_t GetU32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+size_t ByteLength(uint32_t value) {
+    if (value < (1u << 8)) return 1;
+    if (value < (1u << 16)) return 2;
+    if (value < (1u << 24)) return 3;
+    return 4;
+}
+
+// Таблицы по управляющему байту: суммарная длина четырёх чисел
+// и маска pshufb, раскладывающая их байты по 32-битным ячейкам
+struct StreamVByteTables {
+    std::array<uint8_t, 256> length{};
+    alignas(16) std::array<std::array<uint8_t, 16>, 256> shuffle{};
+
+    StreamVByteTables() {
+        for (size_t c = 0; c < 256; ++c) {
+            uint8_t offset = 0;
+            for (size_t k = 0; k < 4; ++k) {
+                size_t len = ((c >> (2 * k)) & 3) + 1;
+                for (size_t b = 0; b < 4; ++b) {
+                    shuffle[c][4 * k + b] = b < len ? static_cast<uint8_t>(offset + b) : 0x80;
+                }
+                offset = static_cast<uint8_t>(offset + len);
+            }
+            length[c] = offset;
+        }
+    }
+};
+
+const StreamVByteTables& Tables() {
+    static const StreamVByteTables tables;
+    return tables;
+}
+
+const uint8_t* DecodeScalar(const uint8_t* ctrl, const uint8_t* data, size_t count, uint32_t* out) {
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = ((ctrl[i / 4] >> (2 * (i % 4))) & 3) + 1;
+        uint32_t value = 0;
+        for (size_t b = 0; b < len; ++b) value |= static_cast<uint32_t>(data[b]) << (8 * b);
+        out[i] = value;
+        data += len;
+    }
+    return data;
+}
+
+void PrefixSumScalar(uint32_t* values, size_t count, uint32_t base) {
+    for (size_t i = 0; i < count; ++i) {
+        base += values[i];
+        values[i] = base;
+    }
+}
+
+#ifdef SE_X86_KERNELS
+
+void PrefixSumSse2(uint32_t* values, size_t count, uint32_t base) {
+    __m128i carry = _mm_set1_epi32(static_cast<int>(base));
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, carry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(values + i), x);
+        carry = _mm_shuffle_epi32(x, 0xFF);
+    }
+    PrefixSumScalar(values + i, count - i, static_cast<uint32_t>(_mm_cvtsi128_si32(carry)));
+}
+
+#endif
+
+#ifdef SE_AVX2_KERNELS
+
+SE_TARGET_AVX2 const uint8_t* DecodeAvx2(const uint8_t* ctrl, const uint8_t* data, const uint8_t* end,
+                                         size_t count, uint32_t* out) {
+    const StreamVByteTables& tables = Tables();
+    size_t i = 0;
+    // Загрузка 16 байт допустима, пока они не выходят за конец буфера
+    for (; i + 4 <= count && end - data >= 16; i += 4) {
+        uint8_t c = ctrl[i / 4];
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+        __m128i mask = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.shuffle[c].data()));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_shuffle_epi8(bytes, mask));
+        data += tables.length[c];
+    }
+    // Хвост: управляющие байты выровнены по четвёркам, i кратно 4
+    return DecodeScalar(ctrl + i / 4, data, count - i, out + i);
+}
+
+#endif
+
+} // namespace
+
+void EncodeStreamVByte(const uint32_t* values, size_t count, std::vector<uint8_t>& out) {
+    size_t ctrl_pos = out.size();
+    out.resize(out.size() + (count + 3) / 4, 0);
+    for (size_t i = 0; i < count; ++i) {
+        size_t len = ByteLength(values[i]);
+        out[ctrl_pos + i / 4] |= static_cast<uint8_t>((len - 1) << (2 * (i % 4)));
+        for (size_t b = 0; b < len; ++b) out.push_back(static_cast<uint8_t>(values[i] >> (8 * b)));
+    }
+}
+
+const uint8_t* DecodeStreamVByte(const uint8_t* in, const uint8_t* end, size_t count, uint32_t* out,
+                                 SimdLevel level) {
+    const uint8_t* data = in + (count + 3) / 4;
+#ifdef SE_AVX2_KERNELS
+    if (level == SimdLevel::Avx2) return DecodeAvx2(in, data, end, count, out);
+#endif
+    (void)end;
+    (void)level;
+    return DecodeScalar(in, data, count, out);
+}
+
+void PrefixSum(uint32_t* values, size_t count, uint32_t base, SimdLevel level) {
+#ifdef SE_X86_KERNELS
+    if (level != SimdLevel::Scalar) return PrefixSumSse2(values, count, base);
+#endif
+    (void)level;
+    PrefixSumScalar(values, count, base);
+}
+
+CompressedPostings::CompressedPostings(const DocId* doc_ids, const TermCount* doc_counts, size_t count)
+    : size_(static_cast<uint32_t>(count)) {
+    if (count >= kBitmapMinSize && count * kBitmapDensity > doc_ids[count - 1]) {
+        encodeBitmap(doc_ids, doc_counts, count);
+        return;
+    }
+
+    std::vector<uint8_t> bytes;
+    uint32_t gaps[kBlockSize];
+    uint32_t counts[kBlockSize];
+    uint32_t prev = 0;
+
+    for (size_t start = 0; start < count; start += kBlockSize) {
+        size_t n = std::min(kBlockSize, count - start);
+        for (size_t i = 0; i < n; ++i) {
+            auto doc = static_cast<uint32_t>(doc_ids[start + i]);
+            gaps[i] = doc - prev;
+            counts[i] = static_cast<uint32_t>(doc_counts[start + i]);
+            prev = doc;
+        }
+
+        size_t header = bytes.size();
+        bytes.resize(header + kHeaderBytes);
+        EncodeStreamVByte(gaps, n, bytes);
+        EncodeStreamVByte(counts, n, bytes);
+
+        // Заголовок позволяет пропускать блоки, не декодируя их
+        auto length = static_cast<uint32_t>(bytes.size() - header - kHeaderBytes);
+        std::memcpy(bytes.data() + header, &prev, 4);
+        std::memcpy(bytes.data() + header + 4, &length, 4);
+    }
+    data_.assign(bytes.begin(), bytes.end());
+}
+
+void CompressedPostings::decode(Postings& out, SimdLevel level) const {
+    if (bitmap_) return decodeBitmap(out);
+    size_t offset = out.size();
+    out.doc_ids.resize(offset + size_);
+    out.counts.resize(offset + size_);
+    uint32_t docs[kBlockSize];
+    uint32_t counts[kBlockSize];
+    const uint8_t* p = data_.data();
+    const uint8_t* end = p + data_.size();
+    uint32_t base = 0;
+
+    for (size_t start = 0; start < size_; start += kBlockSize) {
+        size_t n = std::min<size_t>(kBlockSize, size_ - start);
+        uint32_t last_doc = GetU32(p);
+        uint32_t length = GetU32(p + 4);
+        const uint8_t* block = p + kHeaderBytes;
+
+        const uint8_t* next = DecodeStreamVByte(block, end, n, docs, level);
+        DecodeStreamVByte(next, end, n, counts, level);
+        PrefixSum(docs, n, base, level);
+        std::copy(docs, docs + n, out.doc_ids.begin() + static_cast<std::ptrdiff_t>(offset + start));
+        std::copy(counts, counts + n, out.counts.begin() + static_cast<std::ptrdiff_t>(offset + start));
+
+        base = last_doc;
+        p = block + length;
+    }
+}
+
+void CompressedPostings::decode(Postings& out) const {
+    decode(out, DetectSimdLevel());
+}
+
+void CompressedPostings::encodeBitmap(const DocId* doc_ids, const TermCount* counts, size_t count) {
+    bitmap_ = true;
+    const size_t words = doc_ids[count - 1] / 64 + 1;
+    const size_t ranks = (words + kRankWords - 1) / kRankWords;
+
+    uint32_t max_count = 1;
+    for (size_t i = 0; i < count; ++i) max_count = std::max(max_count, static_cast<uint32_t>(counts[i]));
+    const auto width = static_cast<uint8_t>(32 - std::countl_zero(max_count));
+
+    // Частоты упакованы по width бит; 8 байт запаса позволяют читать их одним словом
+    const size_t counts_bytes = (count * width + 7) / 8 + 8;
+    data_.assign(kBitmapHeader + words * 8 + ranks * 4 + counts_bytes, 0);
+    uint8_t* p = data_.data();
+    auto stored_words = static_cast<uint32_t>(words);
+    std::memcpy(p, &stored_words, 4);
+    p[4] = width;
+
+    uint8_t* bits = p + kBitmapHeader;
+    for (size_t i = 0; i < count; ++i) {
+        size_t doc = doc_ids[i];
+        bits[doc / 8] |= static_cast<uint8_t>(1u << (doc % 8));
+    }
+
+    uint8_t* rank = bits + words * 8;
+    uint32_t total = 0;
+    for (size_t w = 0; w < words; ++w) {
+        if (w % kRankWords == 0) std::memcpy(rank + (w / kRankWords) * 4, &total, 4);
+        total += static_cast<uint32_t>(std::popcount(bitmapWord(w)));
+    }
+
+    uint8_t* packed = rank + ranks * 4;
+    for (size_t i = 0; i < count; ++i) {
+        uint64_t value = static_cast<uint64_t>(static_cast<uint32_t>(counts[i])) << ((i * width) % 8);
+        uint8_t* at = packed + (i * width) / 8;
+        uint64_t current;
+        std::memcpy(&current, at, 8);
+        current |= value;
+        std::memcpy(at, &current, 8);
+    }
+}
+
+size_t CompressedPostings::bitmapWords() const {
+    return bitmap_ ? GetU32(data_.data()) : 0;
+}
+
+uint64_t CompressedPostings::bitmapWord(size_t i) const {
+    uint64_t word;
+    std::memcpy(&word, data_.data() + kBitmapHeader + i * 8, 8);
+    return word;
+}
+
+size_t CompressedPostings::rankBefore(size_t word, uint64_t bits_below) const {
+    const size_t words = bitmapWords();
+    const uint8_t* rank = data_.data() + kBitmapHeader + words * 8;
+    size_t result = GetU32(rank + (word / kRankWords) * 4);
+    for (size_t w = word / kRankWords * kRankWords; w < word; ++w) {
+        result += static_cast<size_t>(std::popcount(bitmapWord(w)));
+    }
+    return result + static_cast<size_t>(std::popcount(bitmapWord(word) & bits_below));
+}
+
+uint32_t CompressedPostings::countAt(size_t rank) const {
+    const size_t words = bitmapWords();
+    const uint8_t width = data_[4];
+    const uint8_t* packed = data_.data() + kBitmapHeader + words * 8
+                          + (words + kRankWords - 1) / kRankWords * 4;
+    uint64_t value;
+    std::memcpy(&value, packed + (rank * width) / 8, 8);
+    return static_cast<uint32_t>((value >> ((rank * width) % 8)) & ((uint64_t{1} << width) - 1));
+}
+
+bool CompressedPostings::lookup(size_t doc_id, uint32_t& count) const {
+    const size_t word = doc_id / 64;
+    if (!bitmap_ || word >= bitmapWords()) return false;
+    const uint64_t bit = uint64_t{1} << (doc_id % 64);
+    if (!(bitmapWord(word) & bit)) return false;
+    count = countAt(rankBefore(word, bit - 1));
+    return true;
+}
+
+void CompressedPostings::decodeBitmap(Postings& out) const {
+    out.reserve(out.size() + size_);
+    const size_t words = bitmapWords();
+    size_t rank = 0;
+    for (size_t w = 0; w < words; ++w) {
+        for (uint64_t bits = bitmapWord(w); bits; bits &= bits - 1) {
+            out.push_back(static_cast<DocId>(w * 64 + static_cast<size_t>(std::countr_zero(bits))), countAt(rank++));
+        }
+    }
+}
@@ -0,0 +1,351 @@
+#include "QueryParser.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <sstream>
+#include <string_view>
+
+namespace {
+
+struct Token {
+    enum class Kind { Word, Phrase, Wildcard, Range, Fuzzy, Filter, Sort, LParen, RParen, And, Or, Not };
+
+    Token(Kind kind, std::vector<std::string> words = {}) : kind(kind), words(std::move(words)) {}
+
+    Kind kind;
+    std::vector<std::string> words;
+    size_t slop = 0;
+    FieldCompare compare = FieldCompare::Equal;  // Filter
+    double value = 0;                            // Filter
+    bool descending = false;                     // Sort
+};
+
+bool IsSpace(char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+bool IsWordChar(char c) {
+    return !IsSpace(c) && c != '(' && c != ')' && c != '"' && c != '[';
+}
+
+// Имя поля: латинские буквы, цифры и '_', не с цифры
+bool IsFieldName(const std::string& name) {
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name.front()))) return false;
+    return std::all_of(name.begin(), name.end(), [](char ch) {
+        return std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+    });
+}
+
+// year>=2020 → Filter; слово, не похожее на условие, остаётся словом
+bool ParseFilter(const std::string& word, Token& token) {
+    size_t op = word.find_first_of("<=>");
+    if (op == std::string::npos || !IsFieldName(word.substr(0, op))) return false;
+
+    size_t value_begin = op + 1;
+    if (word[op] == '<' || word[op] == '>') {
+        bool or_equal = value_begin < word.size() && word[value_begin] == '=';
+        if (or_equal) ++value_begin;
+        token.compare = word[op] == '<' ? (or_equal ? FieldCompare::LessEqual : FieldCompare::Less)
+                                        : (or_equal ? FieldCompare::GreaterEqual : FieldCompare::Greater);
+    } else {
+        token.compare = FieldCompare::Equal;
+    }
+
+    const char* begin = word.data() + value_begin;
+    const char* end = word.data() + word.size();
+    auto [ptr, ec] = std::from_chars(begin, end, token.value);
+    if (begin == end || ec != std::errc() || ptr != end) return false;
+
+    token.kind = Token::Kind::Filter;
+    token.words = {word.substr(0, op)};
+    return true;
+}
+
+// Наибольшее расстояние в запросе близости; большие значения к нему приводятся
+constexpr size_t kMaxPhraseSlop = 1000;
+
+// Наибольшая вложенность скобок: разбор рекурсивен, более глубокие скобки не группируют
+constexpr size_t kMaxNesting = 64;
+
+// Число из цифр digits, не больше limit (в том числе при переполнении)
+size_t ParseBounded(std::string_view digits, size_t limit) {
+    size_t value = 0;
+    auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), value);
+    if (ec == std::errc::result_out_of_range) return limit;
+    return std::min(value, limit);
+}
+
+std::vector<Token> Tokenize(const std::string& query) {
+    std::vector<Token> tokens;
+    size_t i = 0;
+    const size_t n = query.size();
+
+    while (i < n) {
+        char c = query[i];
+        if (IsSpace(c)) {
+            ++i;
+        } else if (c == '(') {
+            tokens.push_back({Token::Kind::LParen});
+            ++i;
+        } else if (c == ')') {
+            tokens.push_back({Token::Kind::RParen});
+            ++i;
+        } else if (c == '"') {
+            size_t close = query.find('"', i + 1);
+            if (close == std::string::npos) close = n;
+
+            Token phrase{Token::Kind::Phrase};
+            std::istringstream iss(query.substr(i + 1, close - i - 1));
+            std::string word;
+            while (iss >> word) {
+                phrase.words.push_back(word);
+            }
+
+            i = std::min(close + 1, n);
+            if (i < n && query[i] == '~') {
+                size_t digits_end = i + 1;
+                while (digits_end < n && std::isdigit(static_cast<unsigned char>(query[digits_end]))) {
+                    ++digits_end;
+                }
+                if (digits_end > i + 1) {
+                    phrase.slop = ParseBounded(std::string_view(query).substr(i + 1, digits_end - i - 1),
+                                               kMaxPhraseSlop);
+                }
+                i = digits_end;
+            }
+            tokens.push_back(std::move(phrase));
+        } else if (c == '[') {
+            size_t close = query.find(']', i + 1);
+            if (close == std::string::npos) close = n;
+
+            std::istringstream iss(query.substr(i + 1, close - i - 1));
+            std::vector<std::string> parts;
+            std::string word;
+            while (iss >> word) {
+                parts.push_back(word);
+            }
+            i = std::min(close + 1, n);
+
+            // Некорректный диапазон пропускается
+            if (parts.size() == 3 && parts[1] == "TO") {
+                tokens.push_back({Token::Kind::Range, {parts[0], parts[2]}});
+            }
+        } else if ((c == '-' || c == '+') && (i + 1 >= n || !IsSpace(query[i + 1]))) {
+            // Префикс обязательного (+) или исключённого (-) операнда
+            if (c == '-') tokens.push_back({Token::Kind::Not});
+            ++i;
+        } else {
+            size_t end = i;
+            while (end < n && IsWordChar(query[end])) ++end;
+            std::string word = query.substr(i, end - i);
+            i = end;
+
+            Token filter{Token::Kind::Filter};
+            if (word == "AND") {
+                tokens.push_back({Token::Kind::And});
+            } else if (word == "OR") {
+                tokens.push_back({Token::Kind::Or});
+            } else if (word == "NOT") {
+                tokens.push_back({Token::Kind::Not});
+            } else if (word.starts_with("sort:") && IsFieldName(word.substr(word[5] == '-' ? 6 : 5))) {
+                Token sort{Token::Kind::Sort};
+                sort.descending = word[5] == '-';
+                sort.words = {word.substr(sort.descending ? 6 : 5)};
+                tokens.push_back(std::move(sort));
+            } else if (ParseFilter(word, filter)) {
+                tokens.push_back(std::move(filter));
+            } else if (size_t tilde = word.find('~'); tilde != std::string::npos && tilde > 0) {
+                // word~ или word~N
+                std::string edits = word.substr(tilde + 1);
+                bool digits = std::all_of(edits.begin(), edits.end(),
+                                          [](char ch) { return std::isdigit(static_cast<unsigned char>(ch)); });
+                Token fuzzy{Token::Kind::Fuzzy, {word.substr(0, tilde)}};
+                fuzzy.slop = edits.empty() || !digits ? 2 : ParseBounded(edits, 2);
+                tokens.push_back(std::move(fuzzy));
+            } else if (word.find_first_of("*?") != std::string::npos) {
+                tokens.push_back({Token::Kind::Wildcard, {word}});
+            } else {
+                tokens.push_back({Token::Kind::Word, {word}});
+            }
+        }
+    }
+    return tokens;
+}
+
+QueryNodePtr MakeNode(QueryNode::Type type) {
+    auto node = std::make_unique<QueryNode>();
+    node->type = type;
+    return node;
+}
+
+// Объединяет операнды в узел type, раскрывая вложенные узлы того же типа
+// и убирая повторяющиеся слова
+QueryNodePtr Combine(QueryNode::Type type, std::vector<QueryNodePtr> operands) {
+    if (operands.empty()) return nullptr;
+    if (operands.size() == 1) return std::move(operands.front());
+
+    auto node = MakeNode(type);
+    for (auto& op : operands) {
+        if (op->type == type) {
+            for (auto& child : op->children) node->children.push_back(std::move(child));
+        } else {
+            node->children.push_back(std::move(op));
+        }
+    }
+
+    std::vector<QueryNodePtr> unique;
+    std::vector<std::string> seen_terms;
+    for (auto& child : node->children) {
+        if (child->type == QueryNode::Type::Term) {
+            const auto& word = child->words.front();
+            if (std::find(seen_terms.begin(), seen_terms.end(), word) != seen_terms.end()) continue;
+            seen_terms.push_back(word);
+        }
+        unique.push_back(std::move(child));
+    }
+    node->children = std::move(unique);
+
+    if (node->children.size() == 1) return std::move(node->children.front());
+    return node;
+}
+
+class Parser {
+public:
+    explicit Parser(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
+
+    QueryNodePtr ParseQuery() {
+        std::vector<QueryNodePtr> parts;
+        while (pos_ < tokens_.size()) {
+            if (auto node = ParseOr()) parts.push_back(std::move(node));
+            // Лишняя закрывающая скобка
+            if (pos_ < tokens_.size() && tokens_[pos_].kind == Token::Kind::RParen) ++pos_;
+        }
+        return Combine(QueryNode::Type::And, std::move(parts));
+    }
+
+private:
+    bool AtKind(Token::Kind kind) const {
+        return pos_ < tokens_.size() && tokens_[pos_].kind == kind;
+    }
+
+    QueryNodePtr ParseOr() {
+        std::vector<QueryNodePtr> operands;
+        if (auto left = ParseAnd()) operands.push_back(std::move(left));
+        while (AtKind(Token::Kind::Or)) {
+            ++pos_;
+            if (auto right = ParseAnd()) operands.push_back(std::move(right));
+        }
+        return Combine(QueryNode::Type::Or, std::move(operands));
+    }
+
+    QueryNodePtr ParseAnd() {
+        std::vector<QueryNodePtr> operands;
+        while (pos_ < tokens_.size()) {
+            auto kind = tokens_[pos_].kind;
+            if (kind == Token::Kind::RParen || kind == Token::Kind::Or) break;
+            if (kind == Token::Kind::And) {
+                ++pos_;
+                continue;
+            }
+            if (auto node = ParseUnary()) operands.push_back(std::move(node));
+        }
+        return Combine(QueryNode::Type::And, std::move(operands));
+    }
+
+    QueryNodePtr ParseUnary() {
+        if (!AtKind(Token::Kind::Not)) return ParsePrimary();
+
+        // Цепочка отрицаний разбирается циклом: чётное число снимается
+        bool negate = false;
+        while (AtKind(Token::Kind::Not)) {
+            negate = !negate;
+            ++pos_;
+        }
+        if (pos_ >= tokens_.size()) return nullptr;
+        auto kind = tokens_[pos_].kind;
+        if (kind == Token::Kind::RParen || kind == Token::Kind::Or || kind == Token::Kind::And) {
+            return nullptr;
+        }
+
+        auto operand = ParsePrimary();
+        if (!operand || !negate) return operand;
+        if (operand->type == QueryNode::Type::Not) {
+            return std::move(operand->children.front());
+        }
+        auto node = MakeNode(QueryNode::Type::Not);
+        node->children.push_back(std::move(operand));
+        return node;
+    }
+
+    QueryNodePtr ParsePrimary() {
+        Token& token = tokens_[pos_++];
+        switch (token.kind) {
+            case Token::Kind::Word: {
+                auto node = MakeNode(QueryNode::Type::Term);
+                node->words = std::move(token.words);
+                return node;
+            }
+            case Token::Kind::Wildcard:
+            case Token::Kind::Range: {
+                auto node = MakeNode(token.kind == Token::Kind::Wildcard ? QueryNode::Type::Wildcard
+                                                                         : QueryNode::Type::Range);
+                node->words = std::move(token.words);
+                return node;
+            }
+            case Token::Kind::Filter: {
+                auto node = MakeNode(QueryNode::Type::Filter);
+                node->words = std::move(token.words);
+                node->compare = token.compare;
+                node->value = token.value;
+                return node;
+            }
+            case Token::Kind::Fuzzy: {
+                auto node = MakeNode(QueryNode::Type::Fuzzy);
+                node->words = std::move(token.words);
+                node->slop = token.slop;
+                return node;
+            }
+            case Token::Kind::Phrase: {
+                if (token.words.empty()) return nullptr;
+                auto node = MakeNode(token.words.size() == 1 ? QueryNode::Type::Term
+                                                             : QueryNode::Type::Phrase);
+                node->words = std::move(token.words);
+                node->slop = token.slop;
+                return node;
+            }
+            case Token::Kind::LParen: {
+                // Слишком глубокая скобка пропускается, содержимое остаётся на этом уровне
+                if (depth_ >= kMaxNesting) return nullptr;
+                ++depth_;
+                auto node = ParseOr();
+                --depth_;
+                if (AtKind(Token::Kind::RParen)) ++pos_;
+                return node;
+            }
+            default:
+                return nullptr;
+        }
+    }
+
+    std::vector<Token> tokens_;
+    size_t pos_ = 0;
+    size_t depth_ = 0;  // текущая вложенность скобок
+};
+
+} // namespace
+
+QueryNodePtr QueryParser::Parse(const std::string& query) {
+    SortOrder ignored;
+    return Parse(query, ignored);
+}
+
+QueryNodePtr QueryParser::Parse(const std::string& query, SortOrder& sort) {
+    std::vector<Token> tokens = Tokenize(query);
+    // Порядок не участвует в плане: забираем его из потока токенов
+    std::erase_if(tokens, [&sort](const Token& token) {
+        if (token.kind != Token::Kind::Sort) return false;
+        sort = {token.words.front(), token.descending};
+        return true;
+    });
+    return Parser(std::move(tokens)).ParseQuery();
+}
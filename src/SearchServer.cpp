@@ -1,94 +1,623 @@
 #include "SearchServer.h"
+#include "QueryParser.h"
+#include "Stats.h"
 #include <algorithm>
-#include <unordered_set>
-#include <sstream>
+#include <cmath>
 #include <fstream>
+#include <limits>
+#include <utility>
 #include "json.hpp"
 
+namespace {
+
+// Есть ли позиции слов фразы по возрастанию, где каждое следующее слово
+// стоит не дальше slop слов после предыдущего. Достижимые позиции слова k
+// получаются из достижимых позиций слова k-1 одним слиянием: позиции p
+// достаточно ближайшей достижимой позиции левее неё. Время линейно от
+// числа позиций (перебор вариантов был экспоненциален от длины фразы).
+bool MatchPhrase(const std::vector<std::vector<uint32_t>>& positions, size_t slop) {
+    std::vector<uint32_t> reachable = positions.front();
+    std::vector<uint32_t> next;
+    for (size_t k = 1; k < positions.size() && !reachable.empty(); ++k) {
+        next.clear();
+        size_t i = 0;
+        for (uint32_t p : positions[k]) {
+            while (i < reachable.size() && reachable[i] < p) ++i;
+            if (i > 0 && p - reachable[i - 1] <= slop + 1) next.push_back(p);
+        }
+        reachable.swap(next);
+    }
+    return !reachable.empty();
+}
+
+bool CompareField(double field, FieldCompare compare, double value) {
+    switch (compare) {
+        case FieldCompare::Less: return field < value;
+        case FieldCompare::LessEqual: return field <= value;
+        case FieldCompare::Equal: return field == value;
+        case FieldCompare::GreaterEqual: return field >= value;
+        case FieldCompare::Greater: return field > value;
+    }
+    return false;
+}
+
+// Условие на поле документа; negate — для исключения (-year>=2020).
+// Документ без числового значения поля условию не удовлетворяет.
+struct FieldFilter {
+    const FieldColumn* column;
+    FieldCompare compare;
+    double value;
+    bool negate;
+
+    bool matches(DocId doc_id) const {
+        bool ok = column && CompareField(column->number(doc_id), compare, value);
+        return ok != negate;
+    }
+};
+
+ScoredDocs ToScored(const Postings& postings, float weight) {
+    ScoredDocs docs(postings.size());
+    for (size_t i = 0; i < docs.size(); ++i) {
+        docs[i] = {postings.doc_ids[i], weight * static_cast<float>(postings.counts[i])};
+    }
+    return docs;
+}
+
+// Пересечение с суммированием релевантности. Если один список много
+// короче другого, элементы короткого ищутся в длинном двоичным поиском.
+ScoredDocs Intersect(const ScoredDocs& a, const ScoredDocs& b) {
+    const ScoredDocs& small = a.size() <= b.size() ? a : b;
+    const ScoredDocs& large = a.size() <= b.size() ? b : a;
+    ScoredDocs out;
+
+    auto less = [](const ScoredDoc& d, size_t id) { return d.doc_id < id; };
+    if (large.size() > 8 * small.size()) {
+        auto from = large.begin();
+        for (const auto& d : small) {
+            from = std::lower_bound(from, large.end(), d.doc_id, less);
+            if (from == large.end()) break;
+            if (from->doc_id == d.doc_id) out.push_back({d.doc_id, d.score + from->score});
+        }
+        return out;
+    }
+
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i].doc_id < b[j].doc_id) {
+            ++i;
+        } else if (b[j].doc_id < a[i].doc_id) {
+            ++j;
+        } else {
+            out.push_back({a[i].doc_id, a[i].score + b[j].score});
+            ++i;
+            ++j;
+        }
+    }
+    return out;
+}
+
+// Объединение с суммированием релевантности
+ScoredDocs Unite(const ScoredDocs& a, const ScoredDocs& b) {
+    ScoredDocs out;
+    out.reserve(a.size() + b.size());
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        if (j == b.size() || (i < a.size() && a[i].doc_id < b[j].doc_id)) {
+            out.push_back(a[i++]);
+        } else if (i == a.size() || b[j].doc_id < a[i].doc_id) {
+            out.push_back(b[j++]);
+        } else {
+            out.push_back({a[i].doc_id, a[i].score + b[j].score});
+            ++i;
+            ++j;
+        }
+    }
+    return out;
+}
+
+// Документы из a, которых нет в b
+ScoredDocs Subtract(const ScoredDocs& a, const ScoredDocs& b) {
+    ScoredDocs out;
+    size_t j = 0;
+    for (const auto& d : a) {
+        while (j < b.size() && b[j].doc_id < d.doc_id) ++j;
+        if (j < b.size() && b[j].doc_id == d.doc_id) continue;
+        out.push_back(d);
+    }
+    return out;
+}
+
+} // namespace
+
+SearchServer::SearchServer(InvertedIndex& idx, int max_responses)
+    : _max_responses(max_responses) {
+    // Указатель без владения: индекс удаляет вызывающий
+    std::shared_ptr<const InvertedIndex> borrowed(std::shared_ptr<void>(), &idx);
+    _snapshots = std::make_shared<IndexSnapshots>(std::move(borrowed));
+}
+
+SearchServer::SearchServer(std::shared_ptr<IndexSnapshots> snapshots, int max_responses)
+    : _snapshots(std::move(snapshots)), _max_responses(max_responses) {}
+
 std::vector<std::vector<RelativeIndex>> SearchServer::search(const std::vector<std::string>& queries_input) {
     std::vector<std::vector<RelativeIndex>> results;
+    results.reserve(queries_input.size());
 
+    // Весь пакет выполняется по одной версии индекса
+    std::shared_ptr<const InvertedIndex> snapshot = _snapshots->acquire();
     for (const auto& query : queries_input) {
-        // 1. Разбиваем запрос на слова
-        std::istringstream iss(query);
-        std::vector<std::string> words;
-        std::string word;
-        while (iss >> word) {
-            words.push_back(word);
-        }
+        results.push_back(Normalize(searchScored(*snapshot, query)));
+    }
+    return results;
+}
 
-        // 2. Получаем уникальные слова
-        std::unordered_set<std::string> unique_words(words.begin(), words.end());
+ScoredDocs SearchServer::searchScored(const std::string& query) const {
+    std::shared_ptr<const InvertedIndex> snapshot = _snapshots->acquire();
+    return searchScored(*snapshot, query);
+}
 
-        // 3. Сортируем по частоте в базе (по возрастанию)
-        std::vector<std::string> sorted_words(unique_words.begin(), unique_words.end());
-        std::sort(sorted_words.begin(), sorted_words.end(), [this](const std::string& a, const std::string& b) {
-            return _index.getWordCount(a).size() < _index.getWordCount(b).size();
-        });
+ScoredDocs SearchServer::searchScored(const InvertedIndex& index, const std::string& query) const {
+    SE_SCOPED_TIMER("query");
+    SE_COUNTER_ADD("queries", 1);
+
+    // 1. Строим план запроса
+    SortOrder sort;
+    QueryNodePtr plan = QueryParser::Parse(query, sort);
+    if (!plan || FilterWords(index, *plan)) return {};
+
+    // 2. Раскрываем шаблоны и диапазоны в списки слов
+    ExpandPlan(index, *plan);
+
+    // 3. Выполняем план: документы с суммарной релевантностью
+    ScoredDocs docs = Evaluate(index, *plan);
+
+    // 4. Оставляем max_responses лучших (по релевантности или по полю)
+    const size_t k = static_cast<size_t>(std::max(_max_responses, 0));
+    if (sort.field.empty()) {
+        SelectTop(docs, k);
+    } else {
+        const FieldColumn* column = index.documentTable().field(sort.field);
+        SelectTopByField(docs, k, [column](DocId doc_id) {
+            return column ? column->number(doc_id) : std::numeric_limits<double>::quiet_NaN();
+        }, sort.descending);
+    }
+    return docs;
+}
+
+std::vector<Snippet> SearchServer::snippets(const std::string& query, const std::vector<RelativeIndex>& top,
+                                            const SnippetOptions& limits) const {
+    SE_SCOPED_TIMER("snippets");
+    std::shared_ptr<const InvertedIndex> snapshot = _snapshots->acquire();
+
+    // Слова запроса нормализуются и раскрываются так же, как при поиске
+    std::unordered_set<std::string> terms;
+    QueryNodePtr plan = QueryParser::Parse(query);
+    if (plan && !FilterWords(*snapshot, *plan)) {
+        ExpandPlan(*snapshot, *plan);
+        CollectTerms(*plan, terms);
+    }
+
+    std::vector<Snippet> result(top.size());
+    for (size_t i = 0; i < top.size(); ++i) {
+        std::optional<std::string> text = snapshot->getDocument(top[i].doc_id, limits.max_scan_bytes);
+        if (text) result[i] = MakeSnippet(*text, terms, snapshot->tokenizerOptions(), limits);
+    }
+    return result;
+}
+
+std::vector<DocumentInfo> SearchServer::documents(const std::vector<RelativeIndex>& top) const {
+    std::shared_ptr<const InvertedIndex> snapshot = _snapshots->acquire();
+    const DocumentTable& table = snapshot->documentTable();
+
+    std::vector<DocumentInfo> result(top.size());
+    for (size_t i = 0; i < top.size(); ++i) {
+        if (top[i].doc_id < table.size()) result[i] = table.get(top[i].doc_id);
+    }
+    return result;
+}
+
+void SearchServer::CollectTerms(const QueryNode& node, std::unordered_set<std::string>& terms) {
+    switch (node.type) {
+        case QueryNode::Type::Term:
+        case QueryNode::Type::Phrase:
+            terms.insert(node.words.begin(), node.words.end());
+            break;
+        case QueryNode::Type::Not:
+            break;
+        default:
+            for (const auto& child : node.children) CollectTerms(*child, terms);
+    }
+}
+
+void SearchServer::SelectTop(ScoredDocs& docs, size_t k) {
+    auto better = [](const ScoredDoc& a, const ScoredDoc& b) {
+        return a.score > b.score || (a.score == b.score && a.doc_id < b.doc_id);
+    };
+    if (docs.size() > k) {
+        std::partial_sort(docs.begin(), docs.begin() + static_cast<std::ptrdiff_t>(k), docs.end(), better);
+        docs.resize(k);
+    } else {
+        std::sort(docs.begin(), docs.end(), better);
+    }
+}
+
+void SearchServer::SelectTopByField(ScoredDocs& docs, size_t k, const std::function<double(DocId)>& value,
+                                    bool descending) {
+    // Значения поля читаются один раз на документ
+    std::vector<std::pair<double, ScoredDoc>> keyed;
+    keyed.reserve(docs.size());
+    for (const auto& d : docs) keyed.emplace_back(value(d.doc_id), d);
+
+    auto better = [descending](const auto& a, const auto& b) {
+        bool a_missing = std::isnan(a.first), b_missing = std::isnan(b.first);
+        if (a_missing != b_missing) return b_missing;
+        if (!a_missing && a.first != b.first) return descending ? a.first > b.first : a.first < b.first;
+        return a.second.score > b.second.score || (a.second.score == b.second.score && a.second.doc_id < b.second.doc_id);
+    };
+    if (keyed.size() > k) {
+        std::partial_sort(keyed.begin(), keyed.begin() + static_cast<std::ptrdiff_t>(k), keyed.end(), better);
+        keyed.resize(k);
+    } else {
+        std::sort(keyed.begin(), keyed.end(), better);
+    }
+
+    docs.resize(keyed.size());
+    for (size_t i = 0; i < keyed.size(); ++i) docs[i] = keyed[i].second;
+}
+
+std::vector<RelativeIndex> SearchServer::Normalize(const ScoredDocs& top) {
+    std::vector<RelativeIndex> relative_indices;
+    if (top.empty()) return relative_indices;
 
-        // 4. Получаем документы по первому слову
-        std::vector<Entry> first_word_entries = _index.getWordCount(sorted_words.front());
-        if (first_word_entries.empty()) {
-            results.emplace_back(); // пустой результат
-            continue;
+    // При порядке по полю лучший по релевантности не обязательно первый
+    float max_rel = 0;
+    for (const auto& d : top) max_rel = std::max(max_rel, d.score);
+    relative_indices.reserve(top.size());
+    for (const auto& d : top) {
+        relative_indices.push_back({d.doc_id, max_rel > 0 ? d.score / max_rel : 0.0f});
+    }
+    return relative_indices;
+}
+
+size_t SearchServer::EstimateCost(const InvertedIndex& index, const QueryNode& node) const {
+    switch (node.type) {
+        case QueryNode::Type::Term:
+            return index.documentFrequency(node.words.front());
+        case QueryNode::Type::Phrase: {
+            size_t cost = std::numeric_limits<size_t>::max();
+            for (const auto& w : node.words) cost = std::min(cost, index.documentFrequency(w));
+            return cost;
+        }
+        case QueryNode::Type::And: {
+            size_t cost = std::numeric_limits<size_t>::max();
+            for (const auto& child : node.children) {
+                if (child->type != QueryNode::Type::Not) cost = std::min(cost, EstimateCost(index, *child));
+            }
+            return cost == std::numeric_limits<size_t>::max() ? 0 : cost;
         }
+        case QueryNode::Type::Or: {
+            size_t cost = 0;
+            for (const auto& child : node.children) cost += EstimateCost(index, *child);
+            return cost;
+        }
+        case QueryNode::Type::Not:
+        case QueryNode::Type::Wildcard:
+        case QueryNode::Type::Range:
+        case QueryNode::Type::Fuzzy:
+        case QueryNode::Type::Filter:
+            return 0;
+    }
+    return 0;
+}
+
+bool SearchServer::FilterWords(const InvertedIndex& index, QueryNode& node) const {
+    const TokenizerOptions& options = index.tokenizerOptions();
+    if (!options.stop_words && !options.filters) return false;
 
-        // 5. Инициализируем карту релевантности
-        std::unordered_map<size_t, int> doc_relevance;
-        for (auto& e : first_word_entries) {
-            doc_relevance[e.doc_id] = e.count;
+    // Слово запроса проходит те же этапы, что и слово документа; true — слово выброшено
+    auto drop = [&options](std::string& word) {
+        if (options.lowercase) AsciiLowercase(word);
+        return !options.filter(word);
+    };
+
+    switch (node.type) {
+        case QueryNode::Type::Term:
+            return drop(node.words.front());
+        case QueryNode::Type::Phrase:
+            // Стоп-слова не индексируются, поэтому соседние с ними слова стоят в индексе рядом
+            std::erase_if(node.words, drop);
+            if (node.words.size() == 1) node.type = QueryNode::Type::Term;
+            return node.words.empty();
+        case QueryNode::Type::And:
+        case QueryNode::Type::Or:
+        case QueryNode::Type::Not:
+            std::erase_if(node.children, [&](const QueryNodePtr& child) { return FilterWords(index, *child); });
+            return node.children.empty();
+        default:
+            return false;
+    }
+}
+
+void SearchServer::ExpandPlan(const InvertedIndex& index, QueryNode& node) const {
+    // Слова запроса нормализуются так же, как слова документов (имя поля — нет)
+    if (index.tokenizerOptions().lowercase && node.type != QueryNode::Type::Filter) {
+        for (auto& w : node.words) AsciiLowercase(w);
+    }
+
+    for (auto& child : node.children) {
+        ExpandPlan(index, *child);
+    }
+
+    // В нечётком режиме каждое отдельное слово ищется с опечатками
+    if (node.type == QueryNode::Type::Term && _fuzzy_edits > 0) {
+        node.type = QueryNode::Type::Fuzzy;
+        node.slop = _fuzzy_edits;
+    }
+
+    const TermDictionary& dict = index.terms();
+    std::vector<std::pair<std::string, float>> expanded;
+    switch (node.type) {
+        case QueryNode::Type::Wildcard:
+            for (auto& w : dict.expandWildcard(node.words.front(), _max_expansions)) {
+                expanded.emplace_back(std::move(w), 1.0f);
+            }
+            break;
+        case QueryNode::Type::Range:
+            for (auto& w : dict.expandRange(node.words[0], node.words[1], _max_expansions)) {
+                expanded.emplace_back(std::move(w), 1.0f);
+            }
+            break;
+        case QueryNode::Type::Fuzzy: {
+            auto matches = dict.expandFuzzy(node.words.front(), static_cast<uint32_t>(node.slop),
+                                            _max_expansions);
+            for (auto& [w, distance] : matches) {
+                // Каждая правка снижает вклад слова
+                expanded.emplace_back(std::move(w), std::pow(_fuzzy_penalty, static_cast<float>(distance)));
+            }
+            break;
         }
+        default:
+            return;
+    }
+    SE_COUNTER_ADD("terms_expanded", expanded.size());
 
-        // 6. Обрабатываем остальные слова
-        for (size_t i = 1; i < sorted_words.size(); ++i) {
-            auto entries = _index.getWordCount(sorted_words[i]);
-            std::unordered_map<size_t, int> current_counts;
-            for (auto& e : entries) {
-                current_counts[e.doc_id] = e.count;
+    // Шаблон превращается в ИЛИ по найденным словам (пустое ИЛИ ничего не находит)
+    node.type = QueryNode::Type::Or;
+    node.words.clear();
+    for (auto& [word, weight] : expanded) {
+        auto term = std::make_unique<QueryNode>();
+        term->type = QueryNode::Type::Term;
+        term->words.push_back(std::move(word));
+        term->weight = weight;
+        node.children.push_back(std::move(term));
+    }
+}
+
+ScoredDocs SearchServer::Evaluate(const InvertedIndex& index, const QueryNode& node) const {
+    switch (node.type) {
+        case QueryNode::Type::Term:
+            return EvaluateTerm(index, node.words.front(), node.weight);
+        case QueryNode::Type::Phrase: {
+            ScoredDocs docs = EvaluateWords(index, node.words);
+            FilterByPhrase(index, node.words, node.slop, docs);
+            return docs;
+        }
+        case QueryNode::Type::And:
+            return EvaluateAnd(index, node);
+        case QueryNode::Type::Or: {
+            ScoredDocs docs;
+            for (const auto& child : node.children) {
+                // Исключение внутри ИЛИ не имеет смысла без положительной части
+                if (child->type == QueryNode::Type::Not) continue;
+                docs = Unite(docs, Evaluate(index, *child));
             }
+            return docs;
+        }
+        case QueryNode::Type::Not:
+            // Запрос только из исключений ничего не находит
+        case QueryNode::Type::Filter:
+            // Условие на поле только отбирает документы, найденные словами
+        case QueryNode::Type::Wildcard:
+        case QueryNode::Type::Range:
+        case QueryNode::Type::Fuzzy:
+            // Шаблоны раскрываются до выполнения (ExpandPlan)
+            return {};
+    }
+    return {};
+}
+
+ScoredDocs SearchServer::EvaluateTerm(const InvertedIndex& index, const std::string& word, float weight) const {
+    Postings postings = index.getPostings(word);
+    SE_COUNTER_ADD("postings_scanned", postings.size());
+    return ToScored(postings, weight);
+}
+
+ScoredDocs SearchServer::EvaluateWords(const InvertedIndex& index, const std::vector<std::string>& words) const {
+    std::vector<std::string> sorted_words(words.begin(), words.end());
+    std::sort(sorted_words.begin(), sorted_words.end());
+    sorted_words.erase(std::unique(sorted_words.begin(), sorted_words.end()), sorted_words.end());
+    std::stable_sort(sorted_words.begin(), sorted_words.end(),
+                     [&index](const std::string& a, const std::string& b) {
+                         return index.documentFrequency(a) < index.documentFrequency(b);
+                     });
 
-            for (auto it = doc_relevance.begin(); it != doc_relevance.end();) {
-                auto found = current_counts.find(it->first);
-                if (found == current_counts.end()) {
-                    it = doc_relevance.erase(it);
-                } else {
-                    it->second += found->second;
-                    ++it;
-                }
+    if (sorted_words.size() == 1) return EvaluateTerm(index, sorted_words.front());
+
+    // Начинаем с двух самых редких слов или с пары из индекса пар, если её список короче
+    size_t first = 0, second = 1;
+    size_t shortest = index.documentFrequency(sorted_words[0]);
+    for (size_t i = 0; i < sorted_words.size(); ++i) {
+        for (size_t j = i + 1; j < sorted_words.size(); ++j) {
+            const CompressedPostings* pair = index.findPairPostings(sorted_words[i], sorted_words[j]);
+            if (pair && pair->size() < shortest) {
+                shortest = pair->size();
+                first = i;
+                second = j;
             }
         }
+    }
 
-        if (doc_relevance.empty()) {
-            results.emplace_back();
-            continue;
+    ScoredDocs docs = IntersectTerms(index, sorted_words[first], 1.0f, sorted_words[second], 1.0f);
+    for (size_t i = 0; i < sorted_words.size() && !docs.empty(); ++i) {
+        if (i == first || i == second) continue;
+        docs = IntersectTerm(index, docs, sorted_words[i], 1.0f);
+    }
+    return docs;
+}
+
+ScoredDocs SearchServer::IntersectTerm(const InvertedIndex& index, const ScoredDocs& docs,
+                                       const std::string& word, float weight) const {
+    const CompressedPostings* postings = index.findPostings(word);
+    if (!postings) return {};
+    if (!postings->isBitmap()) return Intersect(docs, EvaluateTerm(index, word, weight));
+
+    SE_COUNTER_ADD("bitmap_probes", docs.size());
+    ScoredDocs out;
+    uint32_t count = 0;
+    for (const auto& d : docs) {
+        if (postings->lookup(d.doc_id, count)) {
+            out.push_back({d.doc_id, d.score + weight * static_cast<float>(count)});
         }
+    }
+    return out;
+}
 
-        // 7. Находим максимум релевантности
-        int max_rel = 0;
-        for (const auto& [_, rel] : doc_relevance) {
-            if (rel > max_rel) max_rel = rel;
+ScoredDocs SearchServer::IntersectTerms(const InvertedIndex& index, const std::string& a, float weight_a,
+                                        const std::string& b, float weight_b) const {
+    if (weight_a == 1.0f && weight_b == 1.0f) {
+        if (const CompressedPostings* pair = index.findPairPostings(a, b)) {
+            SE_COUNTER_ADD("pair_index_hits", 1);
+            Postings postings;
+            pair->decode(postings);
+            return ToScored(postings, 1.0f);
         }
+    }
+
+    const CompressedPostings* pa = index.findPostings(a);
+    const CompressedPostings* pb = index.findPostings(b);
+    if (!pa || !pb) return {};
+    if (!pa->isBitmap() || !pb->isBitmap()) {
+        // Список декодируется у более редкого слова, второе проверяется через IntersectTerm
+        bool a_first = pa->isBitmap() ? false : pb->isBitmap() || pa->size() <= pb->size();
+        return a_first ? IntersectTerm(index, EvaluateTerm(index, a, weight_a), b, weight_b)
+                       : IntersectTerm(index, EvaluateTerm(index, b, weight_b), a, weight_a);
+    }
 
-        // 8. Собираем и нормализуем результаты
-        std::vector<RelativeIndex> relative_indices;
-        for (const auto& [doc_id, rel] : doc_relevance) {
-            relative_indices.push_back({doc_id, static_cast<float>(rel) / max_rel});
+    ScoredDocs out;
+    CompressedPostings::IntersectBitmaps(*pa, *pb, [&](DocId doc_id, uint32_t count_a, uint32_t count_b) {
+        out.push_back({doc_id, weight_a * static_cast<float>(count_a) + weight_b * static_cast<float>(count_b)});
+    });
+    return out;
+}
+
+ScoredDocs SearchServer::EvaluateAnd(const InvertedIndex& index, const QueryNode& node) const {
+    std::vector<const QueryNode*> positives;
+    std::vector<const QueryNode*> negatives;
+    std::vector<const QueryNode*> phrases;
+    std::vector<FieldFilter> filters;
+    const DocumentTable& table = index.documentTable();
+    for (const auto& child : node.children) {
+        const bool negated = child->type == QueryNode::Type::Not;
+        const QueryNode& operand = negated ? *child->children.front() : *child;
+        if (operand.type == QueryNode::Type::Filter) {
+            filters.push_back({table.field(operand.words.front()), operand.compare, operand.value, negated});
+        } else if (negated) {
+            negatives.push_back(&operand);
+        } else {
+            positives.push_back(child.get());
+            if (child->type == QueryNode::Type::Phrase) phrases.push_back(child.get());
         }
+    }
+    if (positives.empty()) return {};
 
-        std::sort(relative_indices.begin(), relative_indices.end(),
-                  [](const RelativeIndex& a, const RelativeIndex& b) {
-                      return a.rank > b.rank;
-                  });
+    // Начинаем с самых редких операндов: промежуточный результат остаётся коротким
+    std::vector<std::pair<size_t, const QueryNode*>> ordered;
+    for (const QueryNode* p : positives) ordered.emplace_back(EstimateCost(index, *p), p);
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
 
-        // 9. Ограничиваем по max_responses
-        if (relative_indices.size() > _max_responses) {
-            relative_indices.resize(_max_responses);
+    auto is_term = [](const QueryNode& n) { return n.type == QueryNode::Type::Term; };
+
+    // Условия на поля проверяются сразу после первого (самого редкого) шага,
+    // до остальных пересечений
+    auto apply_filters = [&filters](ScoredDocs& docs) {
+        if (filters.empty()) return;
+        SE_COUNTER_ADD("field_filter_checks", docs.size());
+        std::erase_if(docs, [&filters](const ScoredDoc& d) {
+            return !std::all_of(filters.begin(), filters.end(),
+                                [&d](const FieldFilter& f) { return f.matches(d.doc_id); });
+        });
+    };
+
+    ScoredDocs docs;
+    size_t i = 0;
+    if (ordered.size() > 1 && is_term(*ordered[0].second) && is_term(*ordered[1].second)) {
+        const QueryNode& a = *ordered[0].second;
+        const QueryNode& b = *ordered[1].second;
+        docs = IntersectTerms(index, a.words.front(), a.weight, b.words.front(), b.weight);
+        apply_filters(docs);
+        if (docs.empty()) return docs;
+        i = 2;
+    }
+    for (; i < ordered.size(); ++i) {
+        const QueryNode& operand = *ordered[i].second;
+        if (i > 0 && is_term(operand)) {
+            docs = IntersectTerm(index, docs, operand.words.front(), operand.weight);
+        } else {
+            // Фразы на этом шаге проверяются только по словам, позиции — в конце
+            ScoredDocs part = operand.type == QueryNode::Type::Phrase ? EvaluateWords(index, operand.words)
+                                                                      : Evaluate(index, operand);
+            if (i == 0) {
+                docs = std::move(part);
+                apply_filters(docs);
+            } else {
+                docs = Intersect(docs, part);
+            }
         }
+        if (docs.empty()) return docs;
+    }
 
-        results.push_back(std::move(relative_indices));
+    for (const QueryNode* neg : negatives) {
+        docs = Subtract(docs, Evaluate(index, *neg));
+        if (docs.empty()) return docs;
     }
 
-    return results;
+    // Позиции декодируются только для документов, прошедших пересечение
+    for (const QueryNode* phrase : phrases) {
+        FilterByPhrase(index, phrase->words, phrase->slop, docs);
+        if (docs.empty()) break;
+    }
+    return docs;
+}
+
+void SearchServer::FilterByPhrase(const InvertedIndex& index, const std::vector<std::string>& phrase, size_t slop,
+                                  ScoredDocs& docs) const {
+    // Без позиционного индекса фраза проверяется как обычное И
+    if (!index.hasPositions()) return;
+
+    std::vector<Postings> postings;
+    std::vector<const PositionList*> lists;
+    for (const auto& w : phrase) {
+        postings.push_back(index.getPostings(w));
+        lists.push_back(index.getPositionList(w));
+        if (lists.back() == nullptr) {
+            docs.clear();
+            return;
+        }
+    }
+
+    std::vector<std::vector<uint32_t>> positions(phrase.size());
+    ScoredDocs matched;
+    for (const auto& d : docs) {
+        for (size_t k = 0; k < phrase.size(); ++k) {
+            const auto& ids = postings[k].doc_ids;
+            auto found = std::lower_bound(ids.begin(), ids.end(), d.doc_id);
+            positions[k] = lists[k]->decode(static_cast<size_t>(found - ids.begin()));
+            SE_COUNTER_ADD("positions_decoded", positions[k].size());
+        }
+        if (MatchPhrase(positions, slop)) matched.push_back(d);
+    }
+    docs = std::move(matched);
 }
 
 // Сохраняет результаты в JSON-файл
@@ -134,3 +663,14 @@ void SearchServer::saveAnswers(
 void SearchServer::setMaxResponses(int max_responses) {
     _max_responses = max_responses;
 }
+
+// Включает поиск с опечатками для всех слов запроса
+void SearchServer::setFuzzy(size_t max_edits, float penalty) {
+    _fuzzy_edits = std::min<size_t>(max_edits, 2);
+    _fuzzy_penalty = penalty;
+}
+
+// Устанавливает максимальное число слов, в которое раскрывается шаблон
+void SearchServer::setMaxExpansions(size_t max_expansions) {
+    _max_expansions = max_expansions;
+}
@@ -0,0 +1,86 @@
+#include "ShardedIndex.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <future>
+
+ShardedIndex::ShardedIndex(size_t shard_count) {
+    shard_count = std::max<size_t>(shard_count, 1);
+    for (size_t i = 0; i < shard_count; ++i) {
+        shards.push_back(std::make_unique<InvertedIndex>());
+    }
+    local_to_global.resize(shard_count);
+}
+
+void ShardedIndex::updateDocumentBaseFromStrings(const std::vector<std::string>& docs_input,
+                                                 const std::vector<std::string>& source_paths) {
+    const size_t n = shards.size();
+    std::vector<std::vector<std::string>> shard_docs(n);
+    std::vector<std::vector<std::string>> shard_paths(n);
+    for (auto& ids : local_to_global) ids.clear();
+
+    for (size_t i = 0; i < docs_input.size(); ++i) {
+        size_t s = i % n;
+        shard_docs[s].push_back(docs_input[i]);
+        if (i < source_paths.size()) shard_paths[s].push_back(source_paths[i]);
+        local_to_global[s].push_back(i);
+    }
+    doc_count = docs_input.size();
+
+    ThreadPool pool(n);
+    std::vector<std::future<void>> futures;
+    for (size_t s = 0; s < n; ++s) {
+        futures.emplace_back(pool.enqueue([this, s, &shard_docs, &shard_paths]() {
+            shards[s]->updateDocumentBaseFromStrings(shard_docs[s], shard_paths[s]);
+        }));
+    }
+    for (auto& f : futures) f.get();
+}
+
+void ShardedIndex::setPositionalIndex(bool enabled) {
+    for (auto& shard : shards) shard->setPositionalIndex(enabled);
+}
+
+void ShardedIndex::setDocumentStorePolicy(DocumentStorePolicy policy) {
+    for (auto& shard : shards) shard->setDocumentStorePolicy(policy);
+}
+
+void ShardedIndex::setLowercase(bool enabled) {
+    for (auto& shard : shards) shard->setLowercase(enabled);
+}
+
+void ShardedIndex::setStopWords(const std::vector<std::string>& words) {
+    for (auto& shard : shards) shard->setStopWords(words);
+}
+
+void ShardedIndex::setStemming(const std::vector<StemLanguage>& languages) {
+    for (auto& shard : shards) shard->setStemming(languages);
+}
+
+void ShardedIndex::setPairIndexTerms(size_t terms) {
+    for (auto& shard : shards) shard->setPairIndexTerms(terms);
+}
+
+void ShardedIndex::setDocumentFields(const std::vector<DocumentFields>& fields) {
+    const size_t n = shards.size();
+    std::vector<std::vector<DocumentFields>> shard_fields(n);
+    for (size_t i = 0; i < fields.size(); ++i) shard_fields[i % n].push_back(fields[i]);
+    for (size_t s = 0; s < n; ++s) shards[s]->setDocumentFields(std::move(shard_fields[s]));
+}
+
+IndexMemoryUsage ShardedIndex::memoryUsage() const {
+    IndexMemoryUsage total;
+    for (const auto& shard : shards) {
+        IndexMemoryUsage usage = shard->memoryUsage();
+        total.term_bytes += usage.term_bytes;
+        total.posting_bytes += usage.posting_bytes;
+        total.hash_table_bytes += usage.hash_table_bytes;
+        total.position_bytes += usage.position_bytes;
+        total.dictionary_bytes += usage.dictionary_bytes;
+        total.document_bytes += usage.document_bytes;
+        total.table_bytes += usage.table_bytes;
+        total.pair_bytes += usage.pair_bytes;
+        total.forward_bytes += usage.forward_bytes;
+        total.peak_build_bytes = std::max(total.peak_build_bytes, usage.peak_build_bytes);
+    }
+    return total;
+}
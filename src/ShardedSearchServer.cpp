@@ -0,0 +1,104 @@
+#include "ShardedSearchServer.h"
+#include "Stats.h"
+#include <future>
+#include <limits>
+
+ShardedSearchServer::ShardedSearchServer(ShardedIndex& index, int max_responses)
+    : _index(index), _max_responses(max_responses), _pool(index.shardCount()) {
+    _servers.reserve(index.shardCount());
+    for (size_t s = 0; s < index.shardCount(); ++s) {
+        _servers.emplace_back(index.shard(s), max_responses);
+    }
+}
+
+std::vector<std::vector<RelativeIndex>>
+ShardedSearchServer::search(const std::vector<std::string>& queries_input) {
+    SE_SCOPED_TIMER("sharded_search");
+
+    // 1. Рассылаем запросы: каждый шард обрабатывает весь пакет
+    std::vector<std::future<std::vector<ScoredDocs>>> futures;
+    for (size_t s = 0; s < _servers.size(); ++s) {
+        futures.emplace_back(_pool.enqueue([this, s, &queries_input]() {
+            std::vector<ScoredDocs> shard_results;
+            shard_results.reserve(queries_input.size());
+            for (const auto& query : queries_input) {
+                ScoredDocs top = _servers[s].searchScored(query);
+                // Переводим локальные номера документов в глобальные
+                for (auto& d : top) d.doc_id = static_cast<DocId>(_index.globalDocId(s, d.doc_id));
+                shard_results.push_back(std::move(top));
+            }
+            return shard_results;
+        }));
+    }
+
+    std::vector<std::vector<ScoredDocs>> per_shard;
+    per_shard.reserve(futures.size());
+    for (auto& f : futures) per_shard.push_back(f.get());
+
+    // 2. Сливаем top-K шардов в том же порядке и нормализуем по общему максимуму
+    const size_t k = static_cast<size_t>(std::max(_max_responses, 0));
+    std::vector<std::vector<RelativeIndex>> results;
+    results.reserve(queries_input.size());
+    for (size_t q = 0; q < queries_input.size(); ++q) {
+        ScoredDocs merged;
+        for (auto& shard_results : per_shard) {
+            merged.insert(merged.end(), shard_results[q].begin(), shard_results[q].end());
+        }
+        SortOrder sort;
+        QueryParser::Parse(queries_input[q], sort);
+        if (sort.field.empty()) {
+            SearchServer::SelectTop(merged, k);
+        } else {
+            SearchServer::SelectTopByField(merged, k, [this, &sort](DocId doc_id) {
+                auto [shard, local_id] = _index.locate(doc_id);
+                const FieldColumn* column = _index.shard(shard).documentTable().field(sort.field);
+                return column ? column->number(local_id) : std::numeric_limits<double>::quiet_NaN();
+            }, sort.descending);
+        }
+        results.push_back(SearchServer::Normalize(merged));
+    }
+    return results;
+}
+
+std::vector<Snippet> ShardedSearchServer::snippets(const std::string& query, const std::vector<RelativeIndex>& top,
+                                                   const SnippetOptions& limits) const {
+    // Документы группируются по шардам, чтобы запрос разбирался один раз на шард
+    std::vector<std::vector<RelativeIndex>> local(_servers.size());
+    std::vector<std::vector<size_t>> slots(_servers.size());
+    for (size_t i = 0; i < top.size(); ++i) {
+        auto [shard, local_id] = _index.locate(top[i].doc_id);
+        local[shard].push_back({static_cast<DocId>(local_id), top[i].rank});
+        slots[shard].push_back(i);
+    }
+
+    std::vector<Snippet> result(top.size());
+    for (size_t s = 0; s < _servers.size(); ++s) {
+        if (local[s].empty()) continue;
+        std::vector<Snippet> shard_snippets = _servers[s].snippets(query, local[s], limits);
+        for (size_t k = 0; k < shard_snippets.size(); ++k) result[slots[s][k]] = std::move(shard_snippets[k]);
+    }
+    return result;
+}
+
+std::vector<DocumentInfo> ShardedSearchServer::documents(const std::vector<RelativeIndex>& top) const {
+    std::vector<DocumentInfo> result(top.size());
+    for (size_t i = 0; i < top.size(); ++i) {
+        auto [shard, local_id] = _index.locate(top[i].doc_id);
+        const DocumentTable& table = _index.shard(shard).documentTable();
+        if (local_id < table.size()) result[i] = table.get(local_id);
+    }
+    return result;
+}
+
+void ShardedSearchServer::setMaxResponses(int max_responses) {
+    _max_responses = max_responses;
+    for (auto& server : _servers) server.setMaxResponses(max_responses);
+}
+
+void ShardedSearchServer::setFuzzy(size_t max_edits, float penalty) {
+    for (auto& server : _servers) server.setFuzzy(max_edits, penalty);
+}
+
+void ShardedSearchServer::setMaxExpansions(size_t max_expansions) {
+    for (auto& server : _servers) server.setMaxExpansions(max_expansions);
+}
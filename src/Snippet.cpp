@@ -0,0 +1,92 @@
+#include "Snippet.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+
+bool IsSpace(char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// Знаки по краям слова («milk,» подсвечивается как «milk»)
+bool IsEdgePunct(char c) {
+    auto b = static_cast<unsigned char>(c);
+    return b < 0x80 && !((b | 0x20) >= 'a' && (b | 0x20) <= 'z') && !(b >= '0' && b <= '9');
+}
+
+struct TextWord {
+    size_t begin;
+    size_t end;
+    int term;  // номер слова запроса или -1
+};
+
+} // namespace
+
+Snippet MakeSnippet(const std::string& text, const std::unordered_set<std::string>& terms,
+                    const TokenizerOptions& options, const SnippetOptions& limits) {
+    Snippet snippet;
+    const size_t window = std::max<size_t>(limits.window_words, 1);
+    const size_t limit = std::min(text.size(), limits.max_scan_bytes);
+
+    std::unordered_map<std::string, int> term_ids;
+    for (const auto& term : terms) term_ids.emplace(term, static_cast<int>(term_ids.size()));
+
+    // Слова текста с границами; каждое нормализуется тем же разбором, что и при индексации
+    std::vector<TextWord> words;
+    for (size_t i = 0; i < limit;) {
+        while (i < limit && IsSpace(text[i])) ++i;
+        if (i == limit) break;
+        size_t begin = i;
+        while (i < limit && !IsSpace(text[i])) ++i;
+
+        int term = -1;
+        if (!term_ids.empty()) {
+            auto normalized = Tokenize(text.substr(begin, i - begin), options);
+            if (!normalized.empty()) {
+                auto it = term_ids.find(normalized.front());
+                if (it != term_ids.end()) term = it->second;
+            }
+        }
+        words.push_back({begin, i, term});
+    }
+    if (words.empty()) return snippet;
+
+    // Скользящее окно: число разных слов запроса, затем число вхождений
+    size_t best = 0, best_distinct = 0, best_hits = 0;
+    if (words.size() > window && !term_ids.empty()) {
+        std::vector<size_t> counts(term_ids.size(), 0);
+        size_t distinct = 0, hits = 0;
+        auto add = [&](const TextWord& w, bool enter) {
+            if (w.term < 0) return;
+            size_t& c = counts[static_cast<size_t>(w.term)];
+            if (enter) {
+                if (c++ == 0) ++distinct;
+                ++hits;
+            } else {
+                if (--c == 0) --distinct;
+                --hits;
+            }
+        };
+        for (size_t k = 0; k < words.size(); ++k) {
+            add(words[k], true);
+            if (k >= window) add(words[k - window], false);
+            if (k + 1 >= window && (distinct > best_distinct || (distinct == best_distinct && hits > best_hits))) {
+                best = k + 1 - window;
+                best_distinct = distinct;
+                best_hits = hits;
+            }
+        }
+    }
+
+    const size_t last = std::min(words.size(), best + window) - 1;
+    const size_t base = words[best].begin;
+    snippet.text = text.substr(base, words[last].end - base);
+    for (size_t k = best; k <= last; ++k) {
+        if (words[k].term < 0) continue;
+        size_t begin = words[k].begin, end = words[k].end;
+        while (begin < end && IsEdgePunct(text[begin])) ++begin;
+        while (end > begin && IsEdgePunct(text[end - 1])) --end;
+        snippet.highlights.emplace_back(static_cast<uint32_t>(begin - base), static_cast<uint32_t>(end - begin));
+    }
+    return snippet;
+}
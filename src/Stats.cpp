@@ -0,0 +1,117 @@
+#include "Stats.h"
+#include "json.hpp"
+#include <algorithm>
+#include <bit>
+#include <fstream>
+
+using json = nlohmann::json;
+
+int LatencyHistogram::BucketIndex(uint64_t value) {
+    if (value < kSubBuckets) {
+        return static_cast<int>(value);
+    }
+    int msb = 63 - std::countl_zero(value);
+    int shift = msb - kSubBits;
+    int sub = static_cast<int>((value >> shift) & (kSubBuckets - 1));
+    return (shift + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(int index) {
+    if (index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = index / kSubBuckets - 1;
+    uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+    uint64_t lower = (kSubBuckets + sub) << shift;
+    return lower + ((uint64_t{1} << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    buckets_[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_.fetch_add(ns, std::memory_order_relaxed);
+
+    uint64_t prev = max_.load(std::memory_order_relaxed);
+    while (prev < ns && !max_.compare_exchange_weak(prev, ns, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::percentile(double p) const {
+    uint64_t total = count();
+    if (total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(p * static_cast<double>(total) + 0.5);
+    if (rank == 0) rank = 1;
+    if (rank > total) rank = total;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) {
+            return std::min(BucketUpperBound(i), max());
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::reset() {
+    for (auto& b : buckets_) b.store(0, std::memory_order_relaxed);
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+Stats& Stats::Instance() {
+    static Stats instance;
+    return instance;
+}
+
+StatCounter& Stats::counter(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = counters_[name];
+    if (!slot) slot = std::make_unique<StatCounter>();
+    return *slot;
+}
+
+LatencyHistogram& Stats::histogram(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = histograms_[name];
+    if (!slot) slot = std::make_unique<LatencyHistogram>();
+    return *slot;
+}
+
+std::string Stats::DumpJSON() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    json j;
+    j["counters"] = json::object();
+    for (const auto& [name, c] : counters_) {
+        j["counters"][name] = c->value();
+    }
+
+    j["timers"] = json::object();
+    for (const auto& [name, h] : histograms_) {
+        j["timers"][name] = {
+            {"count", h->count()},
+            {"total_ns", h->sum()},
+            {"p50_ns", h->percentile(0.50)},
+            {"p99_ns", h->percentile(0.99)},
+            {"p999_ns", h->percentile(0.999)},
+            {"max_ns", h->max()}
+        };
+    }
+    return j.dump(4);
+}
+
+bool Stats::SaveJSON(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) return false;
+    file << DumpJSON();
+    return true;
+}
+
+void Stats::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [_, c] : counters_) c->reset();
+    for (auto& [_, h] : histograms_) h->reset();
+}
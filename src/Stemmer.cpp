@@ -0,0 +1,382 @@
+#include "Stemmer.h"
+#include <algorithm>
+#include <array>
+#include <string_view>
+
+std::optional<StemLanguage> ParseStemLanguage(const std::string& name) {
+    if (name == "english") return StemLanguage::English;
+    if (name == "russian") return StemLanguage::Russian;
+    return std::nullopt;
+}
+
+namespace {
+
+// ---------- Английский (Porter2) ----------
+
+bool IsVowelEn(char c) {
+    return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u' || c == 'y';
+}
+
+bool EndsWith(const std::string& w, std::string_view suffix) {
+    return w.size() >= suffix.size() && w.compare(w.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+void ReplaceSuffix(std::string& w, size_t suffix_size, std::string_view replacement) {
+    w.resize(w.size() - suffix_size);
+    w.append(replacement);
+}
+
+// Позиция после первой не-гласной, следующей за гласной, начиная с from
+size_t RegionAfter(const std::string& w, size_t from) {
+    for (size_t i = from; i + 1 < w.size(); ++i) {
+        if (IsVowelEn(w[i]) && !IsVowelEn(w[i + 1])) return i + 2;
+    }
+    return w.size();
+}
+
+// Короткий слог, заканчивающийся в позиции end (не включая)
+bool EndsWithShortSyllable(const std::string& w, size_t end) {
+    if (end == 2) return IsVowelEn(w[0]) && !IsVowelEn(w[1]);
+    if (end < 3) return false;
+    char last = w[end - 1];
+    return !IsVowelEn(w[end - 3]) && IsVowelEn(w[end - 2]) && !IsVowelEn(last)
+        && last != 'w' && last != 'x' && last != 'Y';
+}
+
+bool HasVowel(const std::string& w, size_t from, size_t to) {
+    for (size_t i = from; i < to; ++i) {
+        if (IsVowelEn(w[i])) return true;
+    }
+    return false;
+}
+
+struct Rule {
+    std::string_view suffix;
+    std::string_view replacement;
+};
+
+// Самый длинный суффикс из rules (правила упорядочены по убыванию длины)
+const Rule* LongestSuffix(const std::string& w, const Rule* begin, const Rule* end) {
+    for (const Rule* r = begin; r != end; ++r) {
+        if (EndsWith(w, r->suffix)) return r;
+    }
+    return nullptr;
+}
+
+bool EnglishException(std::string& w) {
+    static constexpr std::array<Rule, 18> kExceptions = {{
+        {"skis", "ski"}, {"skies", "sky"}, {"dying", "die"}, {"lying", "lie"}, {"tying", "tie"},
+        {"idly", "idl"}, {"gently", "gentl"}, {"ugly", "ugli"}, {"early", "earli"}, {"only", "onli"},
+        {"singly", "singl"}, {"sky", "sky"}, {"news", "news"}, {"howe", "howe"}, {"atlas", "atlas"},
+        {"cosmos", "cosmos"}, {"bias", "bias"}, {"andes", "andes"},
+    }};
+    for (const Rule& r : kExceptions) {
+        if (w == r.suffix) {
+            w = r.replacement;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Step1a(std::string& w) {
+    if (EndsWith(w, "sses")) {
+        ReplaceSuffix(w, 4, "ss");
+    } else if (EndsWith(w, "ied") || EndsWith(w, "ies")) {
+        ReplaceSuffix(w, 3, w.size() > 4 ? "i" : "ie");
+    } else if (EndsWith(w, "us") || EndsWith(w, "ss")) {
+        // без изменений
+    } else if (EndsWith(w, "s") && w.size() >= 2 && HasVowel(w, 0, w.size() - 2)) {
+        w.pop_back();
+    }
+}
+
+void Step1b(std::string& w, size_t r1) {
+    static constexpr std::array<Rule, 6> kRules = {{
+        {"eedly", ""}, {"ingly", ""}, {"edly", ""}, {"eed", ""}, {"ing", ""}, {"ed", ""},
+    }};
+    const Rule* rule = LongestSuffix(w, kRules.data(), kRules.data() + kRules.size());
+    if (!rule) return;
+
+    size_t start = w.size() - rule->suffix.size();
+    if (rule->suffix == "eed" || rule->suffix == "eedly") {
+        if (start >= r1) ReplaceSuffix(w, rule->suffix.size(), "ee");
+        return;
+    }
+    if (!HasVowel(w, 0, start)) return;
+
+    w.resize(start);
+    if (EndsWith(w, "at") || EndsWith(w, "bl") || EndsWith(w, "iz")) {
+        w.push_back('e');
+    } else if (w.size() >= 2 && w.back() == w[w.size() - 2]
+               && std::string_view("bdfgmnprt").find(w.back()) != std::string_view::npos) {
+        w.pop_back();
+    } else if (r1 >= w.size() && EndsWithShortSyllable(w, w.size())) {
+        w.push_back('e');
+    }
+}
+
+void Step1c(std::string& w) {
+    if (w.size() > 2 && (w.back() == 'y' || w.back() == 'Y') && !IsVowelEn(w[w.size() - 2])) {
+        w.back() = 'i';
+    }
+}
+
+void Step2(std::string& w, size_t r1) {
+    static constexpr std::array<Rule, 24> kRules = {{
+        {"ization", "ize"}, {"ational", "ate"}, {"fulness", "ful"}, {"ousness", "ous"}, {"iveness", "ive"},
+        {"tional", "tion"}, {"biliti", "ble"}, {"lessli", "less"},
+        {"entli", "ent"}, {"ation", "ate"}, {"alism", "al"}, {"aliti", "al"}, {"ousli", "ous"},
+        {"iviti", "ive"}, {"fulli", "ful"},
+        {"enci", "ence"}, {"anci", "ance"}, {"abli", "able"}, {"izer", "ize"}, {"ator", "ate"}, {"alli", "al"},
+        {"bli", "ble"}, {"ogi", "og"},
+        {"li", ""},
+    }};
+    const Rule* rule = LongestSuffix(w, kRules.data(), kRules.data() + kRules.size());
+    if (!rule) return;
+    size_t start = w.size() - rule->suffix.size();
+    if (start < r1) return;
+    if (rule->suffix == "ogi" && (start == 0 || w[start - 1] != 'l')) return;
+    if (rule->suffix == "li" && (start == 0 || std::string_view("cdeghkmnrt").find(w[start - 1]) == std::string_view::npos)) {
+        return;
+    }
+    ReplaceSuffix(w, rule->suffix.size(), rule->replacement);
+}
+
+void Step3(std::string& w, size_t r1, size_t r2) {
+    static constexpr std::array<Rule, 9> kRules = {{
+        {"ational", "ate"}, {"tional", "tion"}, {"alize", "al"}, {"icate", "ic"}, {"iciti", "ic"},
+        {"ative", ""}, {"ical", "ic"}, {"ness", ""}, {"ful", ""},
+    }};
+    const Rule* rule = LongestSuffix(w, kRules.data(), kRules.data() + kRules.size());
+    if (!rule) return;
+    size_t start = w.size() - rule->suffix.size();
+    if (start < r1) return;
+    if (rule->suffix == "ative" && start < r2) return;
+    ReplaceSuffix(w, rule->suffix.size(), rule->replacement);
+}
+
+void Step4(std::string& w, size_t r2) {
+    static constexpr std::array<std::string_view, 18> kSuffixes = {
+        "ement", "ance", "ence", "able", "ible", "ment", "ant", "ent", "ism", "ate", "iti", "ous",
+        "ive", "ize", "ion", "al", "er", "ic",
+    };
+    for (std::string_view suffix : kSuffixes) {
+        if (!EndsWith(w, suffix)) continue;
+        size_t start = w.size() - suffix.size();
+        if (start < r2) return;
+        if (suffix == "ion" && (start == 0 || (w[start - 1] != 's' && w[start - 1] != 't'))) return;
+        w.resize(start);
+        return;
+    }
+}
+
+void Step5(std::string& w, size_t r1, size_t r2) {
+    if (w.empty()) return;
+    size_t last = w.size() - 1;
+    if (w.back() == 'e') {
+        if (last >= r2 || (last >= r1 && !EndsWithShortSyllable(w, last))) w.pop_back();
+    } else if (w.back() == 'l') {
+        if (last >= r2 && last > 0 && w[last - 1] == 'l') w.pop_back();
+    }
+}
+
+// ---------- Русский ----------
+
+// Кодовые точки кириллицы
+constexpr char32_t kA = U'а', kYa = U'я';
+
+bool IsVowelRu(char32_t c) {
+    return c == U'а' || c == U'е' || c == U'и' || c == U'о' || c == U'у' || c == U'ы' || c == U'э'
+        || c == U'ю' || c == U'я';
+}
+
+// Декодирует слово из кириллицы (двухбайтовые последовательности UTF-8),
+// приводя к нижнему регистру и заменяя «ё» на «е»
+bool DecodeCyrillic(const std::string& word, std::u32string& out) {
+    out.clear();
+    for (size_t i = 0; i < word.size(); i += 2) {
+        auto b0 = static_cast<unsigned char>(word[i]);
+        if ((b0 != 0xD0 && b0 != 0xD1) || i + 1 >= word.size()) return false;
+        auto b1 = static_cast<unsigned char>(word[i + 1]);
+        if ((b1 & 0xC0) != 0x80) return false;
+        char32_t c = (static_cast<char32_t>(b0 & 0x1F) << 6) | (b1 & 0x3F);
+        if (c >= U'А' && c <= U'Я') c += 0x20;
+        if (c == U'Ё' || c == U'ё') c = U'е';
+        if (c < U'а' || c > U'я') return false;
+        out.push_back(c);
+    }
+    return !out.empty();
+}
+
+void EncodeCyrillic(const std::u32string& w, std::string& out) {
+    out.clear();
+    for (char32_t c : w) {
+        out.push_back(static_cast<char>(0xC0 | (c >> 6)));
+        out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+    }
+}
+
+// Окончание и требование предшествующей «а»/«я» (первая группа Snowball)
+struct Ending {
+    std::u32string_view suffix;
+    bool after_a = false;
+};
+
+class RussianStemmer {
+public:
+    explicit RussianStemmer(std::u32string& w) : w_(w) {
+        size_t i = 0;
+        while (i < w_.size() && !IsVowelRu(w_[i])) ++i;
+        rv_ = std::min(i + 1, w_.size());
+        r1_ = RegionAfter(0);
+        r2_ = RegionAfter(r1_);
+    }
+
+    void run() {
+        if (!removeLongest(kPerfectiveGerund)) {
+            removeLongest(kReflexive);
+            if (!removeAdjectival() && !removeLongest(kVerb)) removeLongest(kNoun);
+        }
+        if (endsInRv(U"и")) w_.pop_back();
+        if (const Ending* e = longest(kDerivational); e && w_.size() - e->suffix.size() >= r2_) {
+            w_.resize(w_.size() - e->suffix.size());
+        }
+        tidyUp();
+    }
+
+private:
+    template <size_t N>
+    using Endings = std::array<Ending, N>;
+
+    static constexpr Endings<9> kPerfectiveGerund = {{
+        {U"в", true}, {U"вши", true}, {U"вшись", true},
+        {U"ив"}, {U"ивши"}, {U"ившись"}, {U"ыв"}, {U"ывши"}, {U"ывшись"},
+    }};
+    static constexpr Endings<26> kAdjective = {{
+        {U"ее"}, {U"ие"}, {U"ые"}, {U"ое"}, {U"ими"}, {U"ыми"}, {U"ей"}, {U"ий"}, {U"ый"}, {U"ой"},
+        {U"ем"}, {U"им"}, {U"ым"}, {U"ом"}, {U"его"}, {U"ого"}, {U"ему"}, {U"ому"}, {U"их"}, {U"ых"},
+        {U"ую"}, {U"юю"}, {U"ая"}, {U"яя"}, {U"ою"}, {U"ею"},
+    }};
+    static constexpr Endings<8> kParticiple = {{
+        {U"ем", true}, {U"нн", true}, {U"вш", true}, {U"ющ", true}, {U"щ", true},
+        {U"ивш"}, {U"ывш"}, {U"ующ"},
+    }};
+    static constexpr Endings<2> kReflexive = {{{U"ся"}, {U"сь"}}};
+    static constexpr Endings<46> kVerb = {{
+        {U"ла", true}, {U"на", true}, {U"ете", true}, {U"йте", true}, {U"ли", true}, {U"й", true},
+        {U"л", true}, {U"ем", true}, {U"н", true}, {U"ло", true}, {U"но", true}, {U"ет", true},
+        {U"ют", true}, {U"ны", true}, {U"ть", true}, {U"ешь", true}, {U"нно", true},
+        {U"ила"}, {U"ыла"}, {U"ена"}, {U"ейте"}, {U"уйте"}, {U"ите"}, {U"или"}, {U"ыли"}, {U"ей"},
+        {U"уй"}, {U"ил"}, {U"ыл"}, {U"им"}, {U"ым"}, {U"ен"}, {U"ило"}, {U"ыло"}, {U"ено"}, {U"ят"},
+        {U"ует"}, {U"уют"}, {U"ит"}, {U"ыт"}, {U"ены"}, {U"ить"}, {U"ыть"}, {U"ишь"}, {U"ую"}, {U"ю"},
+    }};
+    static constexpr Endings<36> kNoun = {{
+        {U"а"}, {U"ев"}, {U"ов"}, {U"ие"}, {U"ье"}, {U"е"}, {U"иями"}, {U"ями"}, {U"ами"}, {U"еи"},
+        {U"ии"}, {U"и"}, {U"ией"}, {U"ей"}, {U"ой"}, {U"ий"}, {U"й"}, {U"иям"}, {U"ям"}, {U"ием"},
+        {U"ем"}, {U"ам"}, {U"ом"}, {U"о"}, {U"у"}, {U"ах"}, {U"иях"}, {U"ях"}, {U"ы"}, {U"ь"},
+        {U"ию"}, {U"ью"}, {U"ю"}, {U"ия"}, {U"ья"}, {U"я"},
+    }};
+    static constexpr Endings<2> kDerivational = {{{U"ост"}, {U"ость"}}};
+
+    size_t RegionAfter(size_t from) const {
+        for (size_t i = from; i + 1 < w_.size(); ++i) {
+            if (IsVowelRu(w_[i]) && !IsVowelRu(w_[i + 1])) return i + 2;
+        }
+        return w_.size();
+    }
+
+    bool endsInRv(std::u32string_view suffix) const {
+        return w_.size() >= rv_ + suffix.size()
+            && std::u32string_view(w_).substr(w_.size() - suffix.size()) == suffix;
+    }
+
+    // Самое длинное окончание из списка в области RV
+    template <size_t N>
+    const Ending* longest(const Endings<N>& endings) const {
+        const Ending* best = nullptr;
+        for (const Ending& e : endings) {
+            if ((!best || e.suffix.size() > best->suffix.size()) && endsInRv(e.suffix)) best = &e;
+        }
+        return best;
+    }
+
+    // Удаляет самое длинное окончание; для первой группы перед ним
+    // должна стоять «а» или «я» из RV (она остаётся)
+    template <size_t N>
+    bool removeLongest(const Endings<N>& endings) {
+        const Ending* e = longest(endings);
+        if (!e) return false;
+        size_t start = w_.size() - e->suffix.size();
+        if (e->after_a && (start <= rv_ || (w_[start - 1] != kA && w_[start - 1] != kYa))) return false;
+        w_.resize(start);
+        return true;
+    }
+
+    bool removeAdjectival() {
+        if (!removeLongest(kAdjective)) return false;
+        removeLongest(kParticiple);
+        return true;
+    }
+
+    void tidyUp() {
+        if (endsInRv(U"ейше")) {
+            w_.resize(w_.size() - 4);
+        } else if (endsInRv(U"ейш")) {
+            w_.resize(w_.size() - 3);
+        } else if (endsInRv(U"ь")) {
+            w_.pop_back();
+            return;
+        }
+        if (endsInRv(U"нн")) w_.pop_back();
+    }
+
+    std::u32string& w_;
+    size_t rv_ = 0;
+    size_t r1_ = 0;
+    size_t r2_ = 0;
+};
+
+} // namespace
+
+void StemEnglish(std::string& word) {
+    for (char& c : word) {
+        if (static_cast<unsigned char>((c | 0x20) - 'a') >= 26) return;
+    }
+    for (char& c : word) c = static_cast<char>(c | 0x20);
+
+    if (EnglishException(word) || word.size() <= 2) return;
+
+    // Согласная «y» помечается как «Y»
+    if (word[0] == 'y') word[0] = 'Y';
+    for (size_t i = 1; i < word.size(); ++i) {
+        if (word[i] == 'y' && IsVowelEn(word[i - 1])) word[i] = 'Y';
+    }
+
+    size_t r1 = RegionAfter(word, 0);
+    for (std::string_view prefix : {"gener", "commun", "arsen"}) {
+        if (word.compare(0, prefix.size(), prefix) == 0) r1 = prefix.size();
+    }
+    size_t r2 = RegionAfter(word, r1);
+
+    Step1a(word);
+    static constexpr std::array<std::string_view, 8> kInvariant = {
+        "inning", "outing", "canning", "herring", "earring", "proceed", "exceed", "succeed",
+    };
+    if (std::find(kInvariant.begin(), kInvariant.end(), word) == kInvariant.end()) {
+        Step1b(word, r1);
+        Step1c(word);
+        Step2(word, r1);
+        Step3(word, r1, r2);
+        Step4(word, r2);
+        Step5(word, r1, r2);
+    }
+    std::replace(word.begin(), word.end(), 'Y', 'y');
+}
+
+void StemRussian(std::string& word) {
+    std::u32string w;
+    if (!DecodeCyrillic(word, w)) return;
+    RussianStemmer(w).run();
+    EncodeCyrillic(w, word);
+}
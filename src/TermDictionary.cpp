@@ -0,0 +1,369 @@
+#include "TermDictionary.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+void PutVarint(std::string& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+uint32_t GetVarint(const std::string& in, size_t& pos) {
+    uint32_t value = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+        byte = static_cast<uint8_t>(in[pos++]);
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+// Длина символа UTF-8, начинающегося с s[i]: ведущий байт и байты
+// продолжения за ним; ASCII и некорректные байты считаются по одному
+size_t CodePointLength(const std::string& s, size_t i) {
+    size_t n = 1;
+    if (static_cast<unsigned char>(s[i]) < 0xC0) return n;
+    while (n < 4 && i + n < s.size() && (static_cast<unsigned char>(s[i + n]) & 0xC0) == 0x80) ++n;
+    return n;
+}
+
+// Разбивает строку на символы UTF-8: codes — байты каждого символа,
+// упакованные в число (для сравнения), offsets — начала символов и конец строки
+void SplitCodePoints(const std::string& s, std::vector<uint32_t>& codes, std::vector<size_t>& offsets) {
+    codes.clear();
+    offsets.clear();
+    for (size_t i = 0; i < s.size();) {
+        const size_t n = CodePointLength(s, i);
+        uint32_t code = 0;
+        for (size_t k = 0; k < n; ++k) code = (code << 8) | static_cast<unsigned char>(s[i + k]);
+        codes.push_back(code);
+        offsets.push_back(i);
+        i += n;
+    }
+    offsets.push_back(s.size());
+}
+
+} // namespace
+
+TermDictionary::Iterator::Iterator(const TermDictionary* dict, size_t page, size_t block)
+    : dict_(dict), page_(page), index_(block * kBlockSize), offset_(0) {
+    if (valid()) {
+        offset_ = dict_->pages_[page_]->block_offsets[block];
+        decodeCurrent();
+    }
+}
+
+void TermDictionary::Iterator::decodeCurrent() {
+    const std::string& data = dict_->pages_[page_]->data;
+    if (index_ % kBlockSize == 0) {
+        uint32_t len = GetVarint(data, offset_);
+        term_.assign(data, offset_, len);
+        offset_ += len;
+    } else {
+        uint32_t shared = GetVarint(data, offset_);
+        uint32_t len = GetVarint(data, offset_);
+        term_.resize(shared);
+        term_.append(data, offset_, len);
+        offset_ += len;
+    }
+}
+
+void TermDictionary::Iterator::next() {
+    if (++index_ == dict_->pages_[page_]->size) {
+        ++page_;
+        index_ = 0;
+        offset_ = 0;
+    }
+    if (valid()) decodeCurrent();
+}
+
+std::shared_ptr<const TermDictionary::Page>
+TermDictionary::EncodePage(const std::vector<std::string>& terms, size_t begin, size_t end) {
+    auto page = std::make_shared<Page>();
+    page->size = end - begin;
+    page->block_offsets.reserve((page->size + kBlockSize - 1) / kBlockSize);
+    std::string& data = page->data;
+    for (size_t i = begin; i < end; ++i) {
+        const std::string& term = terms[i];
+        if ((i - begin) % kBlockSize == 0) {
+            page->block_offsets.push_back(static_cast<uint32_t>(data.size()));
+            PutVarint(data, static_cast<uint32_t>(term.size()));
+            data.append(term);
+        } else {
+            const std::string& prev = terms[i - 1];
+            size_t shared = 0;
+            size_t max_shared = std::min(prev.size(), term.size());
+            while (shared < max_shared && prev[shared] == term[shared]) ++shared;
+            PutVarint(data, static_cast<uint32_t>(shared));
+            PutVarint(data, static_cast<uint32_t>(term.size() - shared));
+            data.append(term, shared, std::string::npos);
+        }
+    }
+    data.shrink_to_fit();
+    return page;
+}
+
+void TermDictionary::build(std::vector<std::string> terms) {
+    clear();
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+
+    size_ = terms.size();
+    pages_.reserve((size_ + kPageSize - 1) / kPageSize);
+    for (size_t begin = 0; begin < terms.size(); begin += kPageSize) {
+        pages_.push_back(EncodePage(terms, begin, std::min(begin + kPageSize, terms.size())));
+    }
+}
+
+void TermDictionary::update(std::vector<std::string> added, std::vector<std::string> removed) {
+    std::sort(added.begin(), added.end());
+    added.erase(std::unique(added.begin(), added.end()), added.end());
+    std::sort(removed.begin(), removed.end());
+    if (pages_.empty()) {
+        build(std::move(added));
+        return;
+    }
+
+    std::vector<std::shared_ptr<const Page>> pages;
+    pages.reserve(pages_.size() + 1);
+    std::vector<std::string> kept, merged;
+    size_t a = 0, r = 0;
+    for (size_t p = 0; p < pages_.size(); ++p) {
+        // Изменения страницы — до первого термина следующей (слова меньше
+        // первого термина словаря достаются первой странице)
+        const bool last = p + 1 == pages_.size();
+        const std::string next_first = last ? std::string() : blockFirstTerm(p + 1, 0);
+        size_t a_end = a, r_end = r;
+        while (a_end < added.size() && (last || added[a_end] < next_first)) ++a_end;
+        while (r_end < removed.size() && (last || removed[r_end] < next_first)) ++r_end;
+        if (a_end == a && r_end == r) {
+            pages.push_back(pages_[p]);
+            continue;
+        }
+
+        const std::vector<std::string> terms = pageTerms(p);
+        kept.clear();
+        merged.clear();
+        std::set_difference(terms.begin(), terms.end(), removed.begin() + static_cast<std::ptrdiff_t>(r),
+                            removed.begin() + static_cast<std::ptrdiff_t>(r_end), std::back_inserter(kept));
+        std::set_union(kept.begin(), kept.end(), added.begin() + static_cast<std::ptrdiff_t>(a),
+                       added.begin() + static_cast<std::ptrdiff_t>(a_end), std::back_inserter(merged));
+        a = a_end;
+        r = r_end;
+
+        // Разросшаяся страница делится поровну, опустевшая исчезает
+        const size_t parts = merged.size() > 2 * kPageSize ? (merged.size() + kPageSize - 1) / kPageSize : 1;
+        for (size_t k = 0; k < parts && !merged.empty(); ++k) {
+            pages.push_back(EncodePage(merged, merged.size() * k / parts, merged.size() * (k + 1) / parts));
+        }
+    }
+
+    pages_ = std::move(pages);
+    size_ = 0;
+    for (const auto& page : pages_) size_ += page->size;
+}
+
+void TermDictionary::clear() {
+    pages_.clear();
+    size_ = 0;
+}
+
+size_t TermDictionary::memoryBytes() const {
+    size_t bytes = pages_.capacity() * sizeof(std::shared_ptr<const Page>);
+    for (const auto& page : pages_) {
+        bytes += sizeof(Page) + page->data.capacity() + page->block_offsets.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+std::string TermDictionary::blockFirstTerm(size_t page, size_t block) const {
+    const std::string& data = pages_[page]->data;
+    size_t pos = pages_[page]->block_offsets[block];
+    uint32_t len = GetVarint(data, pos);
+    return data.substr(pos, len);
+}
+
+std::vector<std::string> TermDictionary::pageTerms(size_t page) const {
+    std::vector<std::string> terms;
+    terms.reserve(pages_[page]->size);
+    for (Iterator it(this, page, 0); terms.size() < pages_[page]->size; it.next()) terms.push_back(it.term());
+    return terms;
+}
+
+TermDictionary::Iterator TermDictionary::seek(const std::string& lower) const {
+    // Последняя страница, а в ней последний блок, первый термин которых <= lower
+    size_t lo = 0, hi = pages_.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (blockFirstTerm(mid, 0) <= lower) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    const size_t page = lo == 0 ? 0 : lo - 1;
+    if (page >= pages_.size()) return Iterator(this, page, 0);
+
+    lo = 0;
+    hi = pages_[page]->block_offsets.size();
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (blockFirstTerm(page, mid) <= lower) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t block = lo == 0 ? 0 : lo - 1;
+
+    Iterator it(this, page, block);
+    while (it.valid() && it.term() < lower) it.next();
+    return it;
+}
+
+bool TermDictionary::contains(const std::string& term) const {
+    Iterator it = seek(term);
+    return it.valid() && it.term() == term;
+}
+
+std::vector<std::string> TermDictionary::expandPrefix(const std::string& prefix, size_t limit) const {
+    std::vector<std::string> out;
+    for (Iterator it = seek(prefix); it.valid() && out.size() < limit; it.next()) {
+        if (it.term().compare(0, prefix.size(), prefix) != 0) break;
+        out.push_back(it.term());
+    }
+    return out;
+}
+
+std::vector<std::string> TermDictionary::expandRange(const std::string& from, const std::string& to,
+                                                     size_t limit) const {
+    std::vector<std::string> out;
+    for (Iterator it = seek(from); it.valid() && out.size() < limit; it.next()) {
+        if (it.term() > to) break;
+        out.push_back(it.term());
+    }
+    return out;
+}
+
+std::vector<std::string> TermDictionary::expandWildcard(const std::string& pattern, size_t limit) const {
+    // Буквальный префикс шаблона ограничивает диапазон просмотра
+    std::string prefix = pattern.substr(0, pattern.find_first_of("*?"));
+    if (prefix.size() == pattern.size()) {
+        return contains(pattern) ? std::vector<std::string>{pattern} : std::vector<std::string>{};
+    }
+
+    std::vector<std::string> out;
+    for (Iterator it = seek(prefix); it.valid() && out.size() < limit; it.next()) {
+        if (it.term().compare(0, prefix.size(), prefix) != 0) break;
+        if (WildcardMatch(pattern, it.term())) out.push_back(it.term());
+    }
+    return out;
+}
+
+// Наименьшая строка, большая всех строк с данным префиксом ("" — такой нет)
+static std::string PrefixSuccessor(std::string prefix) {
+    while (!prefix.empty()) {
+        auto last = static_cast<unsigned char>(prefix.back());
+        if (last != 0xFF) {
+            prefix.back() = static_cast<char>(last + 1);
+            return prefix;
+        }
+        prefix.pop_back();
+    }
+    return prefix;
+}
+
+std::vector<std::pair<std::string, uint32_t>>
+TermDictionary::expandFuzzy(const std::string& word, uint32_t max_edits, size_t limit) const {
+    std::vector<std::pair<std::string, uint32_t>> out;
+    // Расстояние считается в символах UTF-8: замена буквы кириллицы — одна правка
+    std::vector<uint32_t> pattern;
+    std::vector<size_t> offsets;
+    SplitCodePoints(word, pattern, offsets);
+    const size_t m = pattern.size();
+
+    // rows[d] — расстояния между префиксом термина из d символов и префиксами word
+    std::vector<std::vector<uint32_t>> rows(1, std::vector<uint32_t>(m + 1));
+    for (size_t j = 0; j <= m; ++j) rows[0][j] = static_cast<uint32_t>(j);
+
+    std::vector<uint32_t> prev;  // символы термина, для которого посчитаны rows
+    std::vector<uint32_t> codes;
+    Iterator it = begin();
+    while (it.valid()) {
+        const std::string& term = it.term();
+        SplitCodePoints(term, codes, offsets);
+
+        size_t shared = 0;
+        size_t max_shared = std::min({prev.size(), codes.size(), rows.size() - 1});
+        while (shared < max_shared && prev[shared] == codes[shared]) ++shared;
+        rows.resize(shared + 1);
+
+        bool pruned = false;
+        for (size_t d = shared; d < codes.size(); ++d) {
+            const auto& above = rows[d];
+            std::vector<uint32_t> row(m + 1);
+            row[0] = above[0] + 1;
+            uint32_t row_min = row[0];
+            for (size_t j = 1; j <= m; ++j) {
+                uint32_t subst = above[j - 1] + (pattern[j - 1] == codes[d] ? 0 : 1);
+                row[j] = std::min({above[j] + 1, row[j - 1] + 1, subst});
+                row_min = std::min(row_min, row[j]);
+            }
+            rows.push_back(std::move(row));
+
+            if (row_min > max_edits) {
+                // Ни одно продолжение этого префикса не подойдёт
+                std::string next = PrefixSuccessor(term.substr(0, offsets[d + 1]));
+                prev.assign(codes.begin(), codes.begin() + static_cast<std::ptrdiff_t>(d + 1));
+                if (next.empty()) return out;
+                it = seek(next);
+                pruned = true;
+                break;
+            }
+        }
+        if (pruned) continue;
+
+        uint32_t distance = rows.back()[m];
+        if (distance <= max_edits) {
+            out.emplace_back(term, distance);
+        }
+        prev.swap(codes);
+        it.next();
+    }
+
+    std::stable_sort(out.begin(), out.end(),
+                     [](const auto& a, const auto& b) { return a.second < b.second; });
+    if (out.size() > limit) out.resize(limit);
+    return out;
+}
+
+bool WildcardMatch(const std::string& pattern, const std::string& text) {
+    size_t p = 0, t = 0;
+    size_t star = std::string::npos, star_text = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && pattern[p] == '?') {
+            ++p;
+            t += CodePointLength(text, t);
+        } else if (p < pattern.size() && pattern[p] == text[t]) {
+            ++p;
+            ++t;
+        } else if (p < pattern.size() && pattern[p] == '*') {
+            star = p++;
+            star_text = t;
+        } else if (star != std::string::npos) {
+            p = star + 1;
+            star_text += CodePointLength(text, star_text);
+            t = star_text;
+        } else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '*') ++p;
+    return p == pattern.size();
+}
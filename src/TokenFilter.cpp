@@ -0,0 +1,48 @@
+#include "TokenFilter.h"
+#include "Stats.h"
+#include <algorithm>
+#include <functional>
+
+bool StemFilter::apply(std::string& word) const {
+    switch (language_) {
+        case StemLanguage::English:
+            StemEnglish(word);
+            break;
+        case StemLanguage::Russian:
+            StemRussian(word);
+            break;
+    }
+    return true;
+}
+
+CachedTokenFilter::CachedTokenFilter(std::shared_ptr<const TokenFilter> inner, size_t capacity)
+    : inner_(std::move(inner)), segment_capacity_(std::max<size_t>(capacity / kSegments, 1)) {}
+
+bool CachedTokenFilter::apply(std::string& word) const {
+    Segment& segment = segments_[std::hash<std::string>{}(word) % kSegments];
+    {
+        std::lock_guard<std::mutex> lock(segment.mutex);
+        auto it = segment.results.find(word);
+        if (it != segment.results.end()) {
+            SE_COUNTER_ADD("token_filter_cache_hits", 1);
+            word = it->second.second;
+            return it->second.first;
+        }
+    }
+
+    std::string original = word;
+    bool keep = inner_->apply(word);
+
+    std::lock_guard<std::mutex> lock(segment.mutex);
+    if (segment.results.size() >= segment_capacity_) segment.results.clear();
+    segment.results.try_emplace(std::move(original), keep, word);
+    return keep;
+}
+
+std::shared_ptr<const TokenFilterPipeline> MakeStemmingPipeline(const std::vector<StemLanguage>& languages) {
+    auto pipeline = std::make_shared<TokenFilterPipeline>();
+    for (StemLanguage language : languages) {
+        pipeline->add(std::make_shared<CachedTokenFilter>(std::make_shared<StemFilter>(language)));
+    }
+    return pipeline;
+}
@@ -0,0 +1,279 @@
+#include "Tokenizer.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define SE_X86_KERNELS
+#if defined(__GNUC__) || defined(__clang__)
+#define SE_AVX2_KERNELS
+#define SE_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace {
+
+constexpr size_t kBlock = 64;
+constexpr size_t kMaxWordLength = 100;
+
+// Классы байтов блока: бит i соответствует байту i
+struct ByteClasses {
+    uint64_t space = 0;  // ' ', '\t', '\n', '\v', '\f', '\r'
+    uint64_t alpha = 0;  // 'A'..'Z', 'a'..'z'
+    uint64_t digit = 0;  // '0'..'9'
+    uint64_t high = 0;   // байты >= 0x80 (части символов UTF-8)
+};
+
+ByteClasses ClassifyScalar(const unsigned char* p) {
+    ByteClasses c;
+    for (size_t i = 0; i < kBlock; ++i) {
+        unsigned char b = p[i];
+        uint64_t bit = uint64_t{1} << i;
+        if (b == ' ' || (b >= '\t' && b <= '\r')) c.space |= bit;
+        if (static_cast<unsigned char>((b | 0x20) - 'a') < 26) c.alpha |= bit;
+        if (static_cast<unsigned char>(b - '0') < 10) c.digit |= bit;
+        if (b >= 0x80) c.high |= bit;
+    }
+    return c;
+}
+
+void LowercaseScalar(char* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (static_cast<unsigned char>(p[i] - 'A') < 26) p[i] = static_cast<char>(p[i] | 0x20);
+    }
+}
+
+#ifdef SE_X86_KERNELS
+
+// Байты в диапазоне [lo, hi]; байты >= 0x80 отрицательны и в диапазон не попадают
+inline __m128i InRange(__m128i v, char lo, char hi) {
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(static_cast<char>(lo - 1))),
+                         _mm_cmplt_epi8(v, _mm_set1_epi8(static_cast<char>(hi + 1))));
+}
+
+ByteClasses ClassifySse2(const unsigned char* p) {
+    ByteClasses c;
+    for (size_t k = 0; k < kBlock; k += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + k));
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), InRange(v, '\t', '\r'));
+        __m128i alpha = InRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z');
+        __m128i digit = InRange(v, '0', '9');
+        c.space |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(space))) << k;
+        c.alpha |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(alpha))) << k;
+        c.digit |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(digit))) << k;
+        c.high |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(v))) << k;
+    }
+    return c;
+}
+
+void LowercaseSse2(char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        __m128i upper = InRange(v, 'A', 'Z');
+        v = _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), v);
+    }
+    LowercaseScalar(p + i, n - i);
+}
+
+#endif
+
+#ifdef SE_AVX2_KERNELS
+
+SE_TARGET_AVX2 inline __m256i InRange256(__m256i v, char lo, char hi) {
+    return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8(static_cast<char>(lo - 1))),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(hi + 1)), v));
+}
+
+SE_TARGET_AVX2 ByteClasses ClassifyAvx2(const unsigned char* p) {
+    ByteClasses c;
+    for (size_t k = 0; k < kBlock; k += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + k));
+        __m256i space = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), InRange256(v, '\t', '\r'));
+        __m256i alpha = InRange256(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z');
+        __m256i digit = InRange256(v, '0', '9');
+        c.space |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(space))) << k;
+        c.alpha |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(alpha))) << k;
+        c.digit |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(digit))) << k;
+        c.high |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(v))) << k;
+    }
+    return c;
+}
+
+SE_TARGET_AVX2 void LowercaseAvx2(char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        __m256i upper = InRange256(v, 'A', 'Z');
+        v = _mm256_or_si256(v, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), v);
+    }
+    LowercaseSse2(p + i, n - i);
+}
+
+#endif
+
+using ClassifyFn = ByteClasses (*)(const unsigned char*);
+using LowercaseFn = void (*)(char*, size_t);
+
+ClassifyFn SelectClassify(SimdLevel level) {
+#ifdef SE_AVX2_KERNELS
+    if (level == SimdLevel::Avx2) return ClassifyAvx2;
+#endif
+#ifdef SE_X86_KERNELS
+    if (level != SimdLevel::Scalar) return ClassifySse2;
+#endif
+    return ClassifyScalar;
+}
+
+LowercaseFn SelectLowercase(SimdLevel level) {
+#ifdef SE_AVX2_KERNELS
+    if (level == SimdLevel::Avx2) return LowercaseAvx2;
+#endif
+#ifdef SE_X86_KERNELS
+    if (level != SimdLevel::Scalar) return LowercaseSse2;
+#endif
+    return LowercaseScalar;
+}
+
+// Маска битов [from, to)
+inline uint64_t RangeMask(size_t from, size_t to) {
+    uint64_t upto = to >= 64 ? ~uint64_t{0} : (uint64_t{1} << to) - 1;
+    return upto & ~((uint64_t{1} << from) - 1);
+}
+
+inline size_t LowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<size_t>(__builtin_ctzll(mask));
+#else
+    size_t i = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+bool IsUtf8Letter(uint32_t cp) {
+    return (cp >= 0xC0 && cp <= 0x24F && cp != 0xD7 && cp != 0xF7)  // латиница с диакритикой
+        || (cp >= 0x370 && cp <= 0x3FF)                             // греческий
+        || (cp >= 0x400 && cp <= 0x52F);                            // кириллица
+}
+
+// Оставляет в слове ASCII-буквы и буквы UTF-8; знаки препинания
+// (« », —, …) и неверные последовательности удаляются
+void KeepUtf8Letters(std::string& word) {
+    size_t out = 0;
+    for (size_t i = 0; i < word.size();) {
+        auto b = static_cast<unsigned char>(word[i]);
+        size_t len = b < 0x80 ? 1 : (b >> 5) == 0x6 ? 2 : (b >> 4) == 0xE ? 3 : (b >> 3) == 0x1E ? 4 : 0;
+        if (len == 0 || i + len > word.size()) {
+            ++i;
+            continue;
+        }
+        uint32_t cp = len == 1 ? b : b & (0x7F >> len);
+        bool valid = true;
+        for (size_t k = 1; k < len; ++k) {
+            auto next = static_cast<unsigned char>(word[i + k]);
+            valid = valid && (next & 0xC0) == 0x80;
+            cp = (cp << 6) | (next & 0x3F);
+        }
+        if (!valid) {
+            ++i;
+            continue;
+        }
+        if (len == 1 || IsUtf8Letter(cp)) {
+            std::memmove(&word[out], &word[i], len);
+            out += len;
+        }
+        i += len;
+    }
+    word.resize(out);
+}
+
+} // namespace
+
+std::vector<std::string> Tokenize(const std::string& text, const TokenizerOptions& options, SimdLevel level) {
+    const ClassifyFn classify = SelectClassify(level);
+    const LowercaseFn lowercase = SelectLowercase(level);
+    const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+
+    std::vector<std::string> words;
+    std::string word;          // буквы текущего слова
+    bool in_word = false;
+    bool rejected = false;     // в слове есть цифра или оно длиннее 100 букв
+    bool has_utf8 = false;     // в слово попали байты >= 0x80
+
+    auto finish_word = [&]() {
+        if (has_utf8) KeepUtf8Letters(word);
+        if (!rejected && !word.empty()) {
+            if (options.lowercase) lowercase(word.data(), word.size());
+            if (options.filter(word) && !word.empty()) words.push_back(word);
+        }
+        word.clear();
+        in_word = false;
+        rejected = false;
+        has_utf8 = false;
+    };
+
+    unsigned char tail[kBlock];
+    for (size_t base = 0; base < text.size(); base += kBlock) {
+        const unsigned char* block = data + base;
+        size_t valid = std::min(kBlock, text.size() - base);
+        if (valid < kBlock) {
+            // Хвост дополняется пробелами, которые завершают последнее слово
+            std::memcpy(tail, block, valid);
+            std::memset(tail + valid, ' ', kBlock - valid);
+            block = tail;
+        }
+        const ByteClasses c = classify(block);
+
+        size_t pos = 0;
+        while (pos < kBlock) {
+            if (!in_word) {
+                uint64_t starts = ~c.space & RangeMask(pos, kBlock);
+                if (!starts) break;
+                pos = LowestBit(starts);
+                in_word = true;
+            }
+            uint64_t ends = c.space & RangeMask(pos, kBlock);
+            size_t end = ends ? LowestBit(ends) : kBlock;
+
+            uint64_t span = RangeMask(pos, end);
+            if (c.digit & span) rejected = true;
+            if (!rejected) {
+                uint64_t alpha = c.alpha & span;
+                if (options.utf8_letters && (c.high & span)) {
+                    alpha |= c.high & span;
+                    has_utf8 = true;
+                }
+                if (alpha == span) {
+                    word.append(reinterpret_cast<const char*>(block + pos), end - pos);
+                } else {
+                    for (; alpha; alpha &= alpha - 1) word.push_back(static_cast<char>(block[LowestBit(alpha)]));
+                }
+                if (word.size() > kMaxWordLength) rejected = true;
+            }
+
+            if (end < kBlock) finish_word();
+            pos = end;
+        }
+    }
+    if (in_word) finish_word();
+    return words;
+}
+
+std::vector<std::string> Tokenize(const std::string& text, const TokenizerOptions& options) {
+    return Tokenize(text, options, DetectSimdLevel());
+}
+
+void AsciiLowercase(std::string& text, SimdLevel level) {
+    SelectLowercase(level)(text.data(), text.size());
+}
+
+void AsciiLowercase(std::string& text) {
+    AsciiLowercase(text, DetectSimdLevel());
+}
@@ -0,0 +1,297 @@
+#include "UringReader.h"
+#include "DocumentLoader.h"
+#include "Stats.h"
+
+#ifdef SEARCH_ENGINE_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+
+// Отображённые в память очереди кольца
+struct UringReader::Ring {
+    void* sq_ptr = MAP_FAILED;
+    void* cq_ptr = MAP_FAILED;
+    size_t sq_size = 0;
+    size_t cq_size = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqes_size = 0;
+
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* sq_entries;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+
+    unsigned pending = 0;  // заполненные, но не отправленные записи
+};
+
+namespace {
+
+enum Op : uint64_t { kOpen = 0, kRead = 1, kClose = 2 };
+
+uint64_t Tag(size_t slot, Op op) { return (static_cast<uint64_t>(slot) << 2) | op; }
+
+int Enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+} // namespace
+
+UringReader::UringReader(size_t queue_depth, size_t buffer_size, bool direct)
+    : depth_(queue_depth > 0 ? queue_depth : 1),
+      buffer_size_(AlignedBuffer(buffer_size > 0 ? buffer_size : 1).size()),
+      direct_(direct) {
+    io_uring_params params{};
+    // На файл в полёте не больше одной операции плюс закрытия
+    int fd = static_cast<int>(::syscall(__NR_io_uring_setup, static_cast<unsigned>(depth_ * 2), &params));
+    if (fd < 0) return;
+
+    auto ring = new Ring();
+    ring->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->sq_size = ring->cq_size = std::max(ring->sq_size, ring->cq_size);
+    }
+    ring->sq_ptr = ::mmap(nullptr, ring->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          fd, IORING_OFF_SQ_RING);
+    if (ring->sq_ptr != MAP_FAILED) {
+        ring->cq_ptr = (params.features & IORING_FEAT_SINGLE_MMAP)
+                     ? ring->sq_ptr
+                     : ::mmap(nullptr, ring->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              fd, IORING_OFF_CQ_RING);
+    }
+    ring->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    if (ring->cq_ptr != MAP_FAILED) {
+        ring->sqes = static_cast<io_uring_sqe*>(::mmap(nullptr, ring->sqes_size, PROT_READ | PROT_WRITE,
+                                                       MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+    }
+    ring_ = ring;
+    ring_fd_ = fd;
+    if (ring->sqes == MAP_FAILED) {
+        closeRing();
+        return;
+    }
+
+    auto* sq = static_cast<char*>(ring->sq_ptr);
+    auto* cq = static_cast<char*>(ring->cq_ptr);
+    ring->sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    ring->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    ring->sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    ring->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    ring->sq_entries = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_entries);
+    ring->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    ring->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    ring->cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    ring->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Регистрация буферов может не пройти из-за RLIMIT_MEMLOCK — тогда обычный READ
+    buffers_ = AlignedBuffer(depth_ * buffer_size_);
+    std::vector<iovec> iovecs(depth_);
+    for (size_t i = 0; i < depth_; ++i) iovecs[i] = {buffers_.data() + i * buffer_size_, buffer_size_};
+    fixed_buffers_ = ::syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_BUFFERS,
+                               iovecs.data(), static_cast<unsigned>(depth_)) == 0;
+}
+
+UringReader::~UringReader() {
+    closeRing();
+}
+
+void UringReader::closeRing() {
+    if (ring_) {
+        if (ring_->sqes != MAP_FAILED) ::munmap(ring_->sqes, ring_->sqes_size);
+        if (ring_->cq_ptr != MAP_FAILED && ring_->cq_ptr != ring_->sq_ptr) ::munmap(ring_->cq_ptr, ring_->cq_size);
+        if (ring_->sq_ptr != MAP_FAILED) ::munmap(ring_->sq_ptr, ring_->sq_size);
+        delete ring_;
+        ring_ = nullptr;
+    }
+    if (ring_fd_ >= 0) ::close(ring_fd_);
+    ring_fd_ = -1;
+}
+
+void UringReader::run(const std::vector<std::string>& paths, std::atomic<size_t>& next_path,
+                      const FileHandler& on_file, const ErrorHandler& on_error) {
+    if (!ok()) return;
+    Ring& ring = *ring_;
+
+    auto push = [&](uint8_t opcode, int fd, uint64_t addr, unsigned len, uint64_t off, uint64_t tag) {
+        unsigned tail = *ring.sq_tail;
+        if (tail - __atomic_load_n(ring.sq_head, __ATOMIC_ACQUIRE) >= *ring.sq_entries) {
+            // Очередь заполнена: отправляем накопленное
+            int submitted = Enter(ring_fd_, ring.pending, 0, 0);
+            if (submitted > 0) ring.pending -= static_cast<unsigned>(submitted);
+        }
+        unsigned index = tail & *ring.sq_mask;
+        io_uring_sqe& sqe = ring.sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.addr = addr;
+        sqe.len = len;
+        sqe.off = off;
+        sqe.user_data = tag;
+        ring.sq_array[index] = index;
+        __atomic_store_n(ring.sq_tail, tail + 1, __ATOMIC_RELEASE);
+        ++ring.pending;
+    };
+
+    // Состояние файла, занимающего слот (и буфер слота)
+    struct Slot {
+        size_t index = 0;
+        int fd = -1;
+        bool busy = false;
+        int64_t mtime = 0;
+        std::string text;
+    };
+    std::vector<Slot> slots(depth_);
+    std::vector<size_t> free_slots;
+    for (size_t s = depth_; s-- > 0;) free_slots.push_back(s);
+    size_t in_flight = 0;  // операции, чьё завершение ещё не получено
+
+    auto queue_read = [&](size_t s) {
+        char* buffer = buffers_.data() + s * buffer_size_;
+        if (fixed_buffers_) {
+            push(IORING_OP_READ_FIXED, slots[s].fd, reinterpret_cast<uint64_t>(buffer),
+                 static_cast<unsigned>(buffer_size_), slots[s].text.size(), Tag(s, kRead));
+            ring.sqes[(*ring.sq_tail - 1) & *ring.sq_mask].buf_index = static_cast<uint16_t>(s);
+        } else {
+            push(IORING_OP_READ, slots[s].fd, reinterpret_cast<uint64_t>(buffer),
+                 static_cast<unsigned>(buffer_size_), slots[s].text.size(), Tag(s, kRead));
+        }
+        ++in_flight;
+    };
+    auto release = [&](size_t s) {
+        if (slots[s].fd >= 0) {
+            push(IORING_OP_CLOSE, slots[s].fd, 0, 0, 0, Tag(s, kClose));
+            ++in_flight;
+        }
+        slots[s] = Slot{};
+        free_slots.push_back(s);
+    };
+    // Ядро без нужной операции: файл читается обычным способом
+    auto fallback = [&](size_t s) {
+        std::string text, error;
+        int64_t mtime = 0;
+        if (ReadWholeFile(paths[slots[s].index], text, error, &mtime, direct_)) {
+            on_file(slots[s].index, text, mtime);
+        } else {
+            on_error(slots[s].index, error);
+        }
+        release(s);
+    };
+
+    bool exhausted = false;
+    while (true) {
+        // Занимаем свободные слоты следующими файлами
+        while (!exhausted && !free_slots.empty()) {
+            size_t i = next_path.fetch_add(1);
+            if (i >= paths.size()) {
+                exhausted = true;
+                break;
+            }
+            size_t s = free_slots.back();
+            free_slots.pop_back();
+            slots[s].index = i;
+            slots[s].busy = true;
+            push(IORING_OP_OPENAT, AT_FDCWD, reinterpret_cast<uint64_t>(paths[i].c_str()), 0, 0, Tag(s, kOpen));
+            ring.sqes[(*ring.sq_tail - 1) & *ring.sq_mask].open_flags = O_RDONLY | O_CLOEXEC | (direct_ ? O_DIRECT : 0);
+            ++in_flight;
+        }
+        if (in_flight == 0) break;
+
+        int submitted = Enter(ring_fd_, ring.pending, 1, IORING_ENTER_GETEVENTS);
+        if (submitted < 0 && errno != EINTR) {
+            // Кольцо неработоспособно: дочитываем обычным способом
+            for (size_t s = 0; s < slots.size(); ++s) {
+                if (!slots[s].busy) continue;
+                if (slots[s].fd >= 0) ::close(slots[s].fd);
+                slots[s].fd = -1;
+                fallback(s);
+            }
+            for (size_t i; (i = next_path.fetch_add(1)) < paths.size();) {
+                std::string text, error;
+                int64_t mtime = 0;
+                if (ReadWholeFile(paths[i], text, error, &mtime, direct_)) {
+                    on_file(i, text, mtime);
+                } else {
+                    on_error(i, error);
+                }
+            }
+            break;
+        }
+        if (submitted > 0) ring.pending -= static_cast<unsigned>(submitted);
+
+        unsigned head = *ring.cq_head;
+        unsigned tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = ring.cqes[head & *ring.cq_mask];
+            size_t s = static_cast<size_t>(cqe.user_data >> 2);
+            auto op = static_cast<Op>(cqe.user_data & 3);
+            int res = cqe.res;
+            --in_flight;
+
+            if (op == kClose) continue;
+            Slot& slot = slots[s];
+            if (op == kOpen) {
+                if (res == -EINVAL || res == -EOPNOTSUPP) {
+                    fallback(s);
+                } else if (res < 0) {
+                    on_error(slot.index, "Failed to open document file: " + paths[slot.index]);
+                    release(s);
+                } else {
+                    // Время изменения — до первого чтения, как в ReadWholeFile
+                    struct stat st {};
+                    slot.fd = res;
+                    if (::fstat(res, &st) == 0) slot.mtime = st.st_mtime;
+                    queue_read(s);
+                }
+            } else {
+                if (res == -EINVAL || res == -EOPNOTSUPP) {
+                    fallback(s);
+                } else if (res < 0) {
+                    on_error(slot.index, "Failed to read document file: " + paths[slot.index]);
+                    release(s);
+                } else {
+                    slot.text.append(buffers_.data() + s * buffer_size_, static_cast<size_t>(res));
+                    if (static_cast<size_t>(res) == buffer_size_) {
+                        queue_read(s);
+                    } else {
+                        // Короткое чтение обычного файла — конец файла
+                        SE_COUNTER_ADD("files_read", 1);
+                        SE_COUNTER_ADD("bytes_read", slot.text.size());
+                        SE_COUNTER_ADD("uring_files", 1);
+                        on_file(slot.index, slot.text, slot.mtime);
+                        release(s);
+                    }
+                }
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+}
+
+#else
+
+struct UringReader::Ring {};
+
+UringReader::UringReader(size_t queue_depth, size_t buffer_size, bool direct)
+    : depth_(queue_depth), buffer_size_(buffer_size), direct_(direct) {}
+
+UringReader::~UringReader() = default;
+
+void UringReader::closeRing() {}
+
+void UringReader::run(const std::vector<std::string>&, std::atomic<size_t>&,
+                      const FileHandler&, const ErrorHandler&) {}
+
+#endif
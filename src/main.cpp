@@ -4,11 +4,18 @@
 #include <filesystem>
 #include <fstream>
 #include <future>
+#include <limits>
 
+#include "ExternalIndexBuilder.h"
+#include "IndexManifest.h"
+#include "IndexWatcher.h"
 #include "InvertedIndex.h"
 #include "SearchServer.h"
+#include "ShardedIndex.h"
+#include "ShardedSearchServer.h"
 #include "ConfigUtils.h"
 #include "ConverterJSON.h"
+#include "Stats.h"
 
 #ifdef RUN_TESTS
 #include "gtest/gtest.h"
@@ -17,7 +24,7 @@
 // Новая функция сохранения config.json с max_responses
 bool save_config_with_max_responses(
     const std::string& filename,
-    const std::vector<std::wstring>& files,
+    const std::vector<std::string>& files,
     int max_responses,
     const std::string& name = "search_engine",
     const std::string& version = "1.0")
@@ -29,21 +36,82 @@ bool save_config_with_max_responses(
         {"max_responses", max_responses}
     };
 
-    std::vector<std::string> files_utf8;
-    for (const auto& f : files) {
-        files_utf8.push_back(wstring_to_utf8(f));
-    }
-    j["files"] = files_utf8;
+    j["files"] = files;
 
     std::ofstream ofs(filename);
     if (!ofs.is_open()) {
-        std::wcerr << L"Cannot open config file for writing: " << utf8_to_wstring(filename) << L"\n";
+        std::cerr << "Cannot open config file for writing: " << filename << "\n";
         return false;
     }
     ofs << j.dump(4);
     return true;
 }
 
+// Строит индекс во внешней памяти в index_path. Бюджет ограничивает только
+// построение: построитель с его словарём освобождается до загрузки индекса.
+bool BuildExternalIndex(const ConverterJSON& conv, const TokenizerOptions& options, const std::string& temp_dir,
+                        const std::string& index_path, DocumentTable& table, std::string& error) {
+    ExternalIndexBuilder builder(temp_dir, conv.GetIndexMemoryBudget(), options);
+    for (const auto& path : conv.GetDocumentPaths()) {
+        if (!builder.addFile(path, error)) return false;
+    }
+    if (!builder.finish(index_path, error)) return false;
+    table = builder.documentTable();
+    return true;
+}
+
+// Печатает отчёт о памяти индекса
+void PrintMemoryUsage(const IndexMemoryUsage& mem) {
+    std::cout << "Index memory (bytes): terms " << mem.term_bytes
+              << ", postings " << mem.posting_bytes
+              << ", hash table " << mem.hash_table_bytes
+              << ", positions " << mem.position_bytes
+              << ", dictionary " << mem.dictionary_bytes
+              << ", documents " << mem.document_bytes
+              << ", document table " << mem.table_bytes
+              << ", pairs " << mem.pair_bytes
+              << ", forward " << mem.forward_bytes
+              << ", total " << mem.total()
+              << ", build peak " << mem.peak_build_bytes << "\n";
+}
+
+// Режим наблюдения: индекс следует за файлами документов, запросы
+// читаются со стандартного ввода построчно до ":q" или конца ввода
+void RunWatchMode(const std::shared_ptr<IndexSnapshots>& snapshots, const ConverterJSON& conv) {
+    IndexWatcher watcher(snapshots, conv.GetWatchOptions());
+    std::string error;
+    if (!watcher.start(error, [](const ReloadStats& stats) {
+            if (stats.files_changed == 0) return;
+            std::cout << "\nIndex updated: " << stats.files_read << " files read, "
+                      << stats.files_changed << " changed\n";
+        })) {
+        std::cout << "Failed to start watching: " << error << "\n";
+        return;
+    }
+    std::cout << "Watching " << conv.GetDocumentPaths().size() << " files for changes ("
+              << (watcher.usesInotify() ? "inotify" : "polling") << "). Enter queries, :q to exit.\n";
+
+    SearchServer server(snapshots, conv.GetResponsesLimit());
+    server.setFuzzy(conv.GetFuzzyMaxEdits());
+    std::string query;
+    while (std::getline(std::cin, query) && query != ":q") {
+        if (query.empty()) continue;
+        if (!is_valid_utf8(query)) {
+            std::cout << "Query is not valid UTF-8.\n";
+            continue;
+        }
+        auto results = server.search({query});
+        auto documents = server.documents(results[0]);
+        if (results[0].empty()) std::cout << "  No results found.\n";
+        for (size_t k = 0; k < results[0].size(); ++k) {
+            std::cout << "  Document #" << results[0][k].doc_id;
+            if (!documents[k].path.empty()) std::cout << " (" << documents[k].path << ")";
+            std::cout << " - relevance: " << results[0][k].rank << "\n";
+        }
+    }
+    watcher.stop();
+}
+
 int main(int argc, char* argv[]) {
     // Запуск тестов при аргументе --test
     if (argc > 1 && std::string(argv[1]) == "--test") {
@@ -56,6 +124,15 @@ int main(int argc, char* argv[]) {
 #endif
     }
 
+    // --stats: по завершении сохранить метрики производительности в stats.json
+    // --watch: после ответов на запросы следить за файлами и отвечать на запросы с консоли
+    bool dump_stats = false;
+    bool watch_mode = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--stats") dump_stats = true;
+        if (std::string(argv[i]) == "--watch") watch_mode = true;
+    }
+
     std::cout << "Welcome to Simple Search Engine!\n\n";
 
     std::cout << "Choose mode:\n";
@@ -65,17 +142,18 @@ int main(int argc, char* argv[]) {
 
     int choice = 0;
     std::cin >> choice;
-    std::wcin.ignore();
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
-    std::vector<std::wstring> file_paths_w;
-    std::vector<std::wstring> queries_w;
+    // Запросы и пути остаются в UTF-8 от ввода до поиска
+    std::vector<std::string> file_paths;
+    std::vector<std::string> queries_utf8;
 
     ConverterJSON conv;
     std::string error;
 
     if (choice == 1) {
-        // Загрузка config.json (с текстами документов)
-        if (!conv.LoadConfig("config/config.json", error)) {
+        // Загрузка config.json; тексты документов читаются при индексации
+        if (!conv.LoadConfig("config/config.json", error, false)) {
             std::cout << "Failed to load config.json: " << error << "\n";
             return 1;
         }
@@ -92,73 +170,81 @@ int main(int argc, char* argv[]) {
             return 1;
         }
 
-        // Получаем запросы
+        // Получаем запросы; строки с некорректным UTF-8 пропускаются
         for (const auto& q : conv.GetRequests()) {
-            queries_w.push_back(utf8_to_wstring(q));
+            if (!is_valid_utf8(q)) {
+                std::cout << "Skipping request with invalid UTF-8\n";
+                continue;
+            }
+            queries_utf8.push_back(q);
         }
     }
     else if (choice == 2) {
-        std::wcout << L"Enter file paths (one per line, empty line to finish):\n";
+        std::cout << "Enter file paths (one per line, empty line to finish):\n";
         while (true) {
-            std::wcout << L"File path: ";
-            std::wstring path;
-            std::getline(std::wcin, path);
-            if (path.empty()) break;
+            std::cout << "File path: ";
+            std::string path;
+            if (!std::getline(std::cin, path) || path.empty()) break;
+            if (!is_valid_utf8(path)) {
+                std::cout << "Path is not valid UTF-8. Please try again.\n";
+                continue;
+            }
 
             path = normalize_dash(path);
 
             if (!std::filesystem::exists(path)) {
-                std::wcout << L"File not found: " << path << L"\nPlease check the path and try again.\n";
+                std::cout << "File not found: " << path << "\nPlease check the path and try again.\n";
                 continue;
             }
-            file_paths_w.push_back(path);
-            std::wcout << L"Added file: " << path << L"\n";
+            file_paths.push_back(path);
+            std::cout << "Added file: " << path << "\n";
         }
 
-        std::wcout << L"\nEnter search queries (one per line, empty line to finish):\n";
+        std::cout << "\nEnter search queries (one per line, empty line to finish):\n";
         while (true) {
-            std::wcout << L"Query: ";
-            std::wstring query;
-            std::getline(std::wcin, query);
-            if (query.empty()) break;
-            queries_w.push_back(query);
-            std::wcout << L"Added query: " << query << L"\n";
+            std::cout << "Query: ";
+            std::string query;
+            if (!std::getline(std::cin, query) || query.empty()) break;
+            if (!is_valid_utf8(query)) {
+                std::cout << "Query is not valid UTF-8. Please try again.\n";
+                continue;
+            }
+            std::cout << "Added query: " << query << "\n";
+            queries_utf8.push_back(std::move(query));
         }
 
         // Ввод max_responses
         int max_responses = 5; // значение по умолчанию
-        std::wcout << L"\nEnter max number of responses to show (default 5): ";
-        std::wstring max_resp_input;
-        std::getline(std::wcin, max_resp_input);
+        std::cout << "\nEnter max number of responses to show (default 5): ";
+        std::string max_resp_input;
+        std::getline(std::cin, max_resp_input);
         if (!max_resp_input.empty()) {
             try {
-                max_responses = std::stoi(std::string(max_resp_input.begin(), max_resp_input.end()));
+                max_responses = std::stoi(max_resp_input);
                 if (max_responses <= 0) {
-                    std::wcout << L"Invalid number, using default 5.\n";
+                    std::cout << "Invalid number, using default 5.\n";
                     max_responses = 5;
                 }
             } catch (...) {
-                std::wcout << L"Invalid input, using default 5.\n";
+                std::cout << "Invalid input, using default 5.\n";
                 max_responses = 5;
             }
         }
 
         // Сохраняем config.json (пути к файлам + max_responses)
-        if (!save_config_with_max_responses("config.json", file_paths_w, max_responses)) {
-            std::wcerr << L"Failed to save config.json\n";
+        if (!save_config_with_max_responses("config.json", file_paths, max_responses)) {
+            std::cerr << "Failed to save config.json\n";
             return 1;
         }
 
         // Сохраняем requests.json с поисковыми запросами
-        std::vector<std::string> queries_utf8;
-        for (const auto& q : queries_w) queries_utf8.push_back(wstring_to_utf8(q));
         conv.SetRequests(queries_utf8);
         if (!conv.SaveRequests("requests.json")) {
-            std::wcerr << L"Failed to save requests.json\n";
+            std::cerr << "Failed to save requests.json\n";
             return 1;
         }
 
-        std::wcout << L"Data saved to config.json and requests.json\n";
+        std::cout << "Data saved to config.json and requests.json\n";
     }
     else {
         std::cout << "Invalid choice. Exiting.\n";
@@ -166,39 +252,127 @@ int main(int argc, char* argv[]) {
     }
 
     // Проверки на пустые данные
-    if (conv.GetTextDocuments().empty()) {
+    if (conv.GetDocumentPaths().empty()) {
         std::cout << "No documents loaded. Exiting.\n";
         return 0;
     }
-    if (queries_w.empty()) {
+    if (queries_utf8.empty()) {
         std::cout << "No search queries provided. Exiting.\n";
         return 0;
     }
 
-    // Индексация по содержимому документов (из конфига)
-    InvertedIndex index;
-    std::cout << "Starting document indexing...\n";
-    auto indexing_future = std::async(std::launch::async, [&]() {
-        index.updateDocumentBaseFromStrings(conv.GetTextDocuments());
-    });
-    indexing_future.get();
-    std::cout << "Indexing completed.\n";
+    std::vector<std::vector<RelativeIndex>> all_results;
+    std::vector<std::vector<Snippet>> all_snippets;
+    std::vector<std::vector<DocumentInfo>> all_documents;
+    const bool snippets_enabled = conv.IsSnippetsEnabled()
+                                  && conv.GetDocumentStorePolicy() != DocumentStorePolicy::None;
+    if (conv.IsSnippetsEnabled() && !snippets_enabled) {
+        std::cout << "Snippets need config.document_store, skipping them.\n";
+    }
+    const size_t shard_count = conv.GetShardCount();
+    std::shared_ptr<IndexSnapshots> live_index;  // индекс для режима наблюдения
 
-    SearchServer server(index, conv.GetResponsesLimit());
-    // std::cout << "Max responses from config: " << conv.GetResponsesLimit() << "\n";
+    if (shard_count > 1) {
+        // Индекс из нескольких шардов, поиск рассылается по всем шардам
+        ShardedIndex index(shard_count);
+        std::cout << "Starting document indexing (" << shard_count << " shards)...\n";
+        index.setDocumentStorePolicy(conv.GetDocumentStorePolicy());
+        index.setPositionalIndex(conv.IsPositionalIndexEnabled());
+        index.setLowercase(conv.IsLowercaseEnabled());
+        index.setStopWords(conv.GetStopWords());
+        index.setStemming(conv.GetStemLanguages());
+        index.setPairIndexTerms(conv.GetPairIndexTerms());
+        index.setDocumentFields(conv.GetDocumentFields());
+        if (!conv.ReadDocuments(error)) {
+            std::cout << "Failed to read documents: " << error << "\n";
+            return 1;
+        }
+        index.updateDocumentBaseFromStrings(conv.GetTextDocuments(), conv.GetDocumentPaths());
+        conv.ReleaseTextDocuments();
+        std::cout << "Indexing completed.\n";
+        if (dump_stats) PrintMemoryUsage(index.memoryUsage());
 
-    // Поиск запросов (конвертируем в UTF-8)
-    std::vector<std::string> queries_utf8;
-    for (const auto& wquery : queries_w) {
-        queries_utf8.push_back(wstring_to_utf8(wquery));
-    }
+        ShardedSearchServer server(index, conv.GetResponsesLimit());
+        server.setFuzzy(conv.GetFuzzyMaxEdits());
 
-    std::cout << "Starting search for queries...\n";
-    auto search_future = std::async(std::launch::async, [&]() {
-        return server.search(queries_utf8);
-    });
-    auto all_results = search_future.get();
-    std::cout << "Search completed.\n";
+        std::cout << "Starting search for queries...\n";
+        all_results = server.search(queries_utf8);
+        for (const auto& results : all_results) all_documents.push_back(server.documents(results));
+        if (snippets_enabled) {
+            for (size_t i = 0; i < queries_utf8.size(); ++i) {
+                all_snippets.push_back(server.snippets(queries_utf8[i], all_results[i], conv.GetSnippetOptions()));
+            }
+        }
+        std::cout << "Search completed.\n";
+    } else {
+        InvertedIndex index;
+        index.setLowercase(conv.IsLowercaseEnabled());
+        index.setStopWords(conv.GetStopWords());
+        index.setStemming(conv.GetStemLanguages());
+        index.setPairIndexTerms(conv.GetPairIndexTerms());
+        index.setDocumentFields(conv.GetDocumentFields());
+        std::cout << "Starting document indexing...\n";
+        if (conv.GetIndexMemoryBudget() > 0) {
+            // Построение во внешней памяти: файлы читаются по одному,
+            // словарь сбрасывается на диск при достижении бюджета. Прогоны и
+            // файл индекса лежат в своём каталоге запуска, который удаляется
+            // после загрузки; для поиска индекс загружается в память целиком.
+            auto temp_dir = CreateUniqueTempDirectory("search_engine_index_");
+            if (!temp_dir) {
+                std::cout << "Indexing failed: cannot create a temporary directory\n";
+                return 1;
+            }
+            std::string index_path = (std::filesystem::path(*temp_dir) / "index.bin").string();
+            DocumentTable table;
+            bool built = BuildExternalIndex(conv, index.tokenizerOptions(), *temp_dir, index_path, table, error) &&
+                         index.loadFromFile(index_path, error);
+            std::error_code ec;
+            std::filesystem::remove_all(*temp_dir, ec);
+            if (!built) {
+                std::cout << "Indexing failed: " << error << "\n";
+                return 1;
+            }
+            index.setDocumentTable(std::move(table));
+        } else if (!conv.GetIndexPath().empty()) {
+            // Сохранённый индекс: перечитываются только изменившиеся файлы
+            index.setDocumentStorePolicy(conv.GetDocumentStorePolicy());
+            index.setPositionalIndex(conv.IsPositionalIndexEnabled());
+            ReloadStats stats;
+            if (!ReloadIndex(index, conv.GetDocumentPaths(), conv.GetIndexPath(), stats, error)) {
+                std::cout << "Indexing failed: " << error << "\n";
+                return 1;
+            }
+            std::cout << (stats.full_rebuild ? "Full rebuild" : "Incremental update") << ": "
+                      << stats.files_read << " files read, " << stats.files_changed << " changed\n";
+        } else {
+            // Файлы читаются конвейером параллельно с разбором
+            index.setDocumentStorePolicy(conv.GetDocumentStorePolicy());
+            index.setPositionalIndex(conv.IsPositionalIndexEnabled());
+            auto indexing_future = std::async(std::launch::async, [&]() {
+                index.updateDocumentBase(conv.GetDocumentPaths());
+            });
+            indexing_future.get();
+        }
+        std::cout << "Indexing completed.\n";
+        if (dump_stats) PrintMemoryUsage(index.memoryUsage());
+
+        live_index = std::make_shared<IndexSnapshots>(std::make_shared<const InvertedIndex>(std::move(index)));
+        SearchServer server(live_index, conv.GetResponsesLimit());
+        server.setFuzzy(conv.GetFuzzyMaxEdits());
+
+        std::cout << "Starting search for queries...\n";
+        auto search_future = std::async(std::launch::async, [&]() {
+            return server.search(queries_utf8);
+        });
+        all_results = search_future.get();
+        for (const auto& results : all_results) all_documents.push_back(server.documents(results));
+        if (snippets_enabled) {
+            for (size_t i = 0; i < queries_utf8.size(); ++i) {
+                all_snippets.push_back(server.snippets(queries_utf8[i], all_results[i], conv.GetSnippetOptions()));
+            }
+        }
+        std::cout << "Search completed.\n";
+    }
 
     // Вывод результатов
     for (size_t i = 0; i < queries_utf8.size(); ++i) {
@@ -208,16 +382,38 @@ int main(int argc, char* argv[]) {
         if (results.empty()) {
             std::cout << "  No results found.\n";
         } else {
-            for (const auto& entry : results) {
-                std::cout << "  Document #" << entry.doc_id << " - relevance: " << entry.rank << "\n";
+            for (size_t k = 0; k < results.size(); ++k) {
+                const auto& entry = results[k];
+                std::cout << "  Document #" << entry.doc_id;
+                if (!all_documents[i][k].path.empty()) std::cout << " (" << all_documents[i][k].path << ")";
+                std::cout << " - relevance: " << entry.rank << "\n";
             }
         }
         std::cout << "\n";
     }
 
-    server.saveAnswers("config/answers.json", queries_utf8, all_results);
+    if (!conv.SaveAnswers("config/answers.json", queries_utf8, all_results, all_snippets, all_documents)) {
+        std::cout << "Failed to save answers.json\n";
+        return 1;
+    }
 
     std::cout << "Search results saved to answers.json\n";
+
+    if (watch_mode) {
+        if (live_index) {
+            RunWatchMode(live_index, conv);
+        } else {
+            std::cout << "Watch mode is not supported with several shards.\n";
+        }
+    }
+
+    if (dump_stats) {
+        if (Stats::Instance().SaveJSON("stats.json")) {
+            std::cout << "Performance stats saved to stats.json\n";
+        } else {
+            std::cout << "Failed to save stats.json\n";
+        }
+    }
     std::cout << "Thank you for using Simple Search Engine. Goodbye!\n";
     return 0;
 }
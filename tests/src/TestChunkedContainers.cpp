@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+#include "ChunkedContainers.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+TEST(ChunkedContainersTest, VectorCopySharesUntouchedChunks) {
+    ChunkedVector<string> original;
+    original.assign(3000, "doc");
+    original.push_back("last");
+    ASSERT_EQ(original.size(), 3001u);
+
+    ChunkedVector<string> copy = original;
+    copy.mutableAt(1500) = "changed";
+    EXPECT_EQ(original[1500], "doc");
+    EXPECT_EQ(copy[1500], "changed");
+    EXPECT_EQ(copy[3000], "last");
+    // Блок изменённого элемента скопирован, остальные общие
+    EXPECT_NE(&copy[1500], &original[1500]);
+    EXPECT_NE(&copy[1024], &original[1024]);
+    EXPECT_EQ(&copy[0], &original[0]);
+    EXPECT_EQ(&copy[2048], &original[2048]);
+
+    copy.push_back("appended");
+    EXPECT_EQ(original.size(), 3001u);
+    EXPECT_EQ(copy[3001], "appended");
+    EXPECT_EQ(copy[3000], "last");
+}
+
+TEST(ChunkedContainersTest, MapCopyIsIndependent) {
+    ShardedMap<unordered_map<string, int>> original;
+    for (int i = 0; i < 1000; ++i) original.assign("w" + to_string(i), i);
+    EXPECT_EQ(original.size(), 1000u);
+    ASSERT_NE(original.find("w500"), nullptr);
+    EXPECT_EQ(*original.find("w500"), 500);
+    EXPECT_EQ(original.find("missing"), nullptr);
+
+    ShardedMap<unordered_map<string, int>> copy = original;
+    copy.assign("w500", -1);
+    copy.assign("new", 7);
+    EXPECT_TRUE(copy.erase("w1"));
+    EXPECT_FALSE(copy.erase("missing"));
+    // Рост таблицы делит сегменты заново, не трогая копию
+    for (int i = 1000; i < 5000; ++i) copy.assign("w" + to_string(i), i);
+
+    EXPECT_EQ(*original.find("w500"), 500);
+    EXPECT_EQ(original.find("new"), nullptr);
+    EXPECT_NE(original.find("w1"), nullptr);
+    EXPECT_EQ(original.size(), 1000u);
+    EXPECT_EQ(*copy.find("w500"), -1);
+    EXPECT_EQ(*copy.find("w4999"), 4999);
+    EXPECT_EQ(copy.find("w1"), nullptr);
+    EXPECT_EQ(copy.size(), 5000u);
+
+    size_t visited = 0;
+    copy.forEach([&visited](const string&, int) { ++visited; });
+    EXPECT_EQ(visited, copy.size());
+}
@@ -0,0 +1,72 @@
+#include "gtest/gtest.h"
+#include "ConfigReader.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+string WriteTemp(const string& name, const string& content) {
+    fs::path path = fs::temp_directory_path() / name;
+    ofstream(path, ios::binary) << content;
+    return path.string();
+}
+
+} // namespace
+
+TEST(ConfigReaderTest, ReadsSectionsInOnePass) {
+    string path = WriteTemp("se_reader_config.json", R"({
+        "unused": {"nested": [1, [2, {"files": ["skip.txt"]}]], "requests": ["skip"]},
+        "config": {"version": "1.0", "stop_words": ["a", "the"], "limits": {"max": [1, 2.5, null, true]}},
+        "files": ["a.txt", {"path": "b.txt", "fields": {"year": 2021, "tags": ["x"]}}, 7, {"path": "c.txt"}],
+        "requests": ["milk", 5, {"q": "x"}, "tea сахар"]
+    })");
+    ConfigDocument document;
+    string error;
+    ASSERT_EQ(ReadConfigDocument(path, document, error), ConfigReadStatus::Ok) << error;
+
+    // config собирается деревом целиком
+    EXPECT_EQ(document.config["version"], "1.0");
+    EXPECT_EQ(document.config["stop_words"], nlohmann::json::array({"a", "the"}));
+    EXPECT_EQ(document.config["limits"]["max"].dump(), "[1,2.5,null,true]");
+
+    ASSERT_TRUE(document.has_files);
+    ASSERT_EQ(document.files.size(), 4u);
+    EXPECT_EQ(document.files[0].path, "a.txt");
+    EXPECT_TRUE(document.files[0].fields.is_null());
+    EXPECT_EQ(document.files[1].path, "b.txt");
+    EXPECT_EQ(document.files[1].fields.dump(), R"({"tags":["x"],"year":2021})");
+    EXPECT_FALSE(document.files[2].valid);
+    EXPECT_EQ(document.files[3].path, "c.txt");
+
+    ASSERT_TRUE(document.has_requests);
+    EXPECT_EQ(document.requests, (vector<string>{"milk", "tea сахар"}));
+    EXPECT_EQ(document.skipped_requests, 2u);
+    fs::remove(path);
+}
+
+TEST(ConfigReaderTest, ReportsErrors) {
+    ConfigDocument document;
+    string error;
+    EXPECT_EQ(ReadConfigDocument("missing_reader_config.json", document, error), ConfigReadStatus::NotFound);
+
+    string path = WriteTemp("se_reader_bad.json", R"({"requests": ["milk", )");
+    EXPECT_EQ(ReadConfigDocument(path, document, error), ConfigReadStatus::ParseError);
+    EXPECT_NE(error.find("parse_error"), string::npos) << error;
+
+    path = WriteTemp("se_reader_bad.json", R"({"files": [{"fields": {}}]})");
+    EXPECT_EQ(ReadConfigDocument(path, document, error), ConfigReadStatus::InvalidStructure);
+    EXPECT_EQ(error, "Config 'files' object must have a string 'path'");
+
+    // files и requests не массивы — секций нет
+    path = WriteTemp("se_reader_bad.json", R"({"files": "a.txt", "requests": {"q": 1}})");
+    ASSERT_EQ(ReadConfigDocument(path, document, error), ConfigReadStatus::Ok);
+    EXPECT_FALSE(document.has_files);
+    EXPECT_FALSE(document.has_requests);
+    EXPECT_TRUE(document.config.is_null());
+    fs::remove(path);
+}
@@ -127,3 +127,82 @@ TEST(ConverterJSONTest, SaveAnswers_CreatesCorrectJSONFile) {
     file.close();
     std::remove(answer_filename.c_str());
 }
+
+TEST(ConverterJSONTest, SaveAnswersWithSnippets) {
+    ConverterJSON conv;
+    std::vector<std::vector<RelativeIndex>> answers = {{ {0, 1.0f}, {1, 0.5f} }};
+    std::vector<std::vector<Snippet>> snippets = {{ Snippet{"capital london", {{8, 6}}}, Snippet{} }};
+
+    const std::string answer_filename = "test_answers_snippets.json";
+    ASSERT_TRUE(conv.SaveAnswers(answer_filename, {"london"}, answers, snippets));
+
+    std::ifstream file(answer_filename);
+    json result_json;
+    file >> result_json;
+    auto relevance = result_json["answers"][0]["relevance"];
+    EXPECT_EQ(relevance[0]["snippet"]["text"], "capital london");
+    EXPECT_EQ(relevance[0]["snippet"]["highlights"], json::parse("[[8, 6]]"));
+    EXPECT_FALSE(relevance[1].contains("snippet"));
+
+    file.close();
+    std::remove(answer_filename.c_str());
+}
+
+TEST(ConverterJSONTest, DocumentStorePolicyAndRelease) {
+    std::string error;
+    ConverterJSON conv;
+
+    ASSERT_TRUE(conv.LoadConfig(config_dir + "config_document_store.json", error)) << error;
+    EXPECT_EQ(conv.GetDocumentStorePolicy(), DocumentStorePolicy::Compressed);
+    ASSERT_EQ(conv.GetDocumentPaths().size(), 2);
+    EXPECT_NE(conv.GetDocumentPaths()[0].find("doc1.txt"), std::string::npos);
+
+    conv.ReleaseTextDocuments();
+    EXPECT_TRUE(conv.GetTextDocuments().empty());
+    EXPECT_EQ(conv.GetDocumentPaths().size(), 2);
+
+    ConverterJSON defaults;
+    ASSERT_TRUE(defaults.LoadConfig(config_dir + "test_config.json", error)) << error;
+    EXPECT_EQ(defaults.GetDocumentStorePolicy(), DocumentStorePolicy::None);
+}
+
+TEST(ConverterJSONTest, FileObjectsWithFields) {
+    std::string error;
+    ConverterJSON conv;
+
+    ASSERT_TRUE(conv.LoadConfig(config_dir + "config_document_fields.json", error)) << error;
+    ASSERT_EQ(conv.GetDocumentPaths().size(), 2);
+    EXPECT_NE(conv.GetDocumentPaths()[0].find("doc1.txt"), std::string::npos);
+    ASSERT_EQ(conv.GetDocumentFields().size(), 2);
+    EXPECT_EQ(conv.GetDocumentFields()[0],
+              (DocumentFields{{"author", std::string("Smith")}, {"year", 2021.0}}));
+    EXPECT_TRUE(conv.GetDocumentFields()[1].empty());
+
+    std::vector<std::vector<DocumentInfo>> documents = {{ DocumentInfo{"doc1.txt", 10, 1700000000, 0xabc, {{"year", 2021.0}}} }};
+    const std::string answer_filename = "test_answers_documents.json";
+    ASSERT_TRUE(conv.SaveAnswers(answer_filename, {"milk"}, {{ {0, 1.0f} }}, {}, documents));
+
+    std::ifstream file(answer_filename);
+    json result_json;
+    file >> result_json;
+    auto document = result_json["answers"][0]["relevance"][0]["document"];
+    EXPECT_EQ(document["path"], "doc1.txt");
+    EXPECT_EQ(document["size"], 10);
+    EXPECT_EQ(document["mtime"], 1700000000);
+    EXPECT_EQ(document["hash"], "0000000000000abc");
+    EXPECT_EQ(document["fields"]["year"], 2021);
+
+    file.close();
+    std::remove(answer_filename.c_str());
+}
+
+TEST(ConverterJSONTest, FieldsFromSidecarFile) {
+    std::string error;
+    ConverterJSON conv;
+
+    ASSERT_TRUE(conv.LoadConfig(config_dir + "config_fields_file.json", error, false)) << error;
+    ASSERT_EQ(conv.GetDocumentFields().size(), 2);
+    // Значение из отдельного файла заменяет значение из files
+    EXPECT_EQ(conv.GetDocumentFields()[0], (DocumentFields{{"year", 2022.0}}));
+    EXPECT_EQ(conv.GetDocumentFields()[1], (DocumentFields{{"rating", 4.5}, {"year", 2024.0}}));
+}
@@ -0,0 +1,155 @@
+#include "gtest/gtest.h"
+#include "DocumentLoader.h"
+#include "InvertedIndex.h"
+#include "UringReader.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Создаёт во временном каталоге файлы с заданными текстами
+vector<string> WriteFiles(const fs::path& dir, const vector<string>& texts) {
+    fs::create_directories(dir);
+    vector<string> paths;
+    for (size_t i = 0; i < texts.size(); ++i) {
+        fs::path path = dir / ("doc" + to_string(i) + ".txt");
+        ofstream(path, ios::binary) << texts[i];
+        paths.push_back(path.string());
+    }
+    return paths;
+}
+
+} // namespace
+
+TEST(DocumentLoaderTest, ReadsAllFilesThroughSmallQueue) {
+    fs::path dir = fs::temp_directory_path() / "search_engine_loader_test";
+    vector<string> texts;
+    for (size_t i = 0; i < 50; ++i) texts.push_back(string(i * 1000, 'a' + i % 26));
+    vector<string> paths = WriteFiles(dir, texts);
+    paths.push_back((dir / "missing.txt").string());
+
+    DocumentLoader::Options options;
+    options.io_threads = 3;
+    options.worker_threads = 2;
+    options.queue_capacity = 2;
+
+    mutex m;
+    vector<string> loaded(paths.size());
+    vector<size_t> failed;
+    DocumentLoader(options).run(
+        paths,
+        [&](size_t i, string& text) {
+            lock_guard<mutex> lock(m);
+            loaded[i] = move(text);
+        },
+        [&](size_t i, const string&) {
+            lock_guard<mutex> lock(m);
+            failed.push_back(i);
+        });
+
+    for (size_t i = 0; i < texts.size(); ++i) EXPECT_EQ(loaded[i], texts[i]) << i;
+    EXPECT_EQ(failed, vector<size_t>{texts.size()});
+    fs::remove_all(dir);
+}
+
+TEST(DocumentLoaderTest, IndexFromFilesMatchesIndexFromStrings) {
+    fs::path dir = fs::temp_directory_path() / "search_engine_loader_index";
+    vector<string> texts = {"milk water milk", "", "london is the capital", "water, water!"};
+    vector<string> paths = WriteFiles(dir, texts);
+
+    InvertedIndex from_files;
+    from_files.updateDocumentBase(paths);
+    InvertedIndex from_strings;
+    from_strings.updateDocumentBaseFromStrings(texts);
+
+    EXPECT_EQ(from_files.documentCount(), texts.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        EXPECT_EQ(from_files.documentTable().path(i), paths[i]);
+        EXPECT_EQ(from_files.documentTable().get(i).mtime, FileModificationTime(paths[i]));
+    }
+    for (const string word : {"milk", "water", "london", "capital", "is"}) {
+        EXPECT_EQ(from_files.getWordCount(word), from_strings.getWordCount(word)) << word;
+    }
+    fs::remove_all(dir);
+}
+
+TEST(DocumentLoaderTest, UnreadableFileKeepsItsPath) {
+    fs::path dir = fs::temp_directory_path() / "search_engine_loader_missing";
+    vector<string> paths = WriteFiles(dir, {"milk water"});
+    paths.push_back((dir / "missing.txt").string());
+
+    InvertedIndex index;
+    index.updateDocumentBase(paths);
+    ASSERT_EQ(index.documentCount(), 2u);
+    EXPECT_EQ(index.documentTable().path(1), paths[1]);
+    EXPECT_EQ(index.documentTable().get(1).size, 0u);
+    EXPECT_EQ(index.documentTable().get(1).mtime, 0);
+    fs::remove_all(dir);
+}
+
+TEST(DocumentLoaderTest, UringReaderMatchesPlainRead) {
+    UringReader uring(4, 4096);
+    if (!uring.ok()) GTEST_SKIP() << "io_uring is not available";
+
+    fs::path dir = fs::temp_directory_path() / "search_engine_uring_test";
+    // Пустой файл, файлы меньше, ровно в буфер и больше буфера
+    vector<string> texts = {"", "milk", string(4096, 'x'), string(10000, 'y'), "water tea"};
+    for (size_t i = 0; i < 20; ++i) texts.push_back(string(i * 700, 'a' + i % 26));
+    vector<string> paths = WriteFiles(dir, texts);
+    paths.push_back((dir / "missing.txt").string());
+
+    vector<string> loaded(paths.size());
+    vector<int64_t> mtimes(paths.size(), 0);
+    vector<size_t> failed;
+    atomic<size_t> next{0};
+    uring.run(paths, next,
+              [&](size_t i, string& text, int64_t mtime) {
+                  loaded[i] = move(text);
+                  mtimes[i] = mtime;
+              },
+              [&](size_t i, const string&) { failed.push_back(i); });
+
+    for (size_t i = 0; i < texts.size(); ++i) {
+        EXPECT_EQ(loaded[i], texts[i]) << i;
+        EXPECT_EQ(mtimes[i], FileModificationTime(paths[i])) << i;
+    }
+    EXPECT_EQ(failed, vector<size_t>{texts.size()});
+    fs::remove_all(dir);
+}
+
+TEST(DocumentLoaderTest, DirectReadMatchesPlainRead) {
+    AlignedBuffer buffer(5000);
+    EXPECT_EQ(buffer.size(), 2 * AlignedBuffer::kAlignment);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % AlignedBuffer::kAlignment, 0u);
+
+    fs::path dir = fs::temp_directory_path() / "search_engine_direct_test";
+    // Размеры вокруг границ страницы и блока чтения (1 МиБ)
+    vector<string> texts = {"", "milk", string(4096, 'x'), string(4097, 'y'),
+                            string(size_t{1} << 20, 'z'), string((size_t{1} << 20) + 5, 'w')};
+    vector<string> paths = WriteFiles(dir, texts);
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        string text, error;
+        int64_t mtime = 0;
+        ASSERT_TRUE(ReadWholeFile(paths[i], text, error, &mtime, true)) << error;
+        EXPECT_EQ(text, texts[i]) << i;
+        EXPECT_EQ(mtime, FileModificationTime(paths[i])) << i;
+    }
+
+    for (bool uring : {false, true}) {
+        DocumentLoader::Options options;
+        options.use_io_uring = uring;
+        options.direct_io = true;
+        vector<string> loaded(paths.size());
+        DocumentLoader(options).run(paths, [&](size_t i, string& text) { loaded[i] = move(text); });
+        EXPECT_EQ(loaded, texts) << uring;
+    }
+    fs::remove_all(dir);
+}
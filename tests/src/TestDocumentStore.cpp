@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+#include "DocumentStore.h"
+#include "InvertedIndex.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace std;
+
+TEST(DocumentStoreTest, LzRoundTrip) {
+    vector<string> inputs = {
+        "",
+        "abc",
+        "milk milk milk milk milk milk milk milk milk milk",
+        string(100000, 'x'),
+    };
+    string mixed;
+    for (int i = 0; i < 5000; ++i) {
+        mixed += "word" + to_string(i * 7919 % 1000) + " ";
+    }
+    inputs.push_back(mixed);
+
+    for (const auto& input : inputs) {
+        string packed = LzCompress(input);
+        EXPECT_EQ(LzDecompress(packed, input.size()), input);
+    }
+    EXPECT_LT(LzCompress(string(100000, 'x')).size(), 1000);
+}
+
+TEST(DocumentStoreTest, NonePolicyKeepsNothing) {
+    InvertedIndex idx;
+    idx.updateDocumentBaseFromStrings({"milk sugar", "water"});
+
+    EXPECT_FALSE(idx.getDocument(0).has_value());
+    EXPECT_EQ(idx.documentCount(), 2);
+    EXPECT_EQ(idx.getWordCount("milk").size(), 1);
+}
+
+TEST(DocumentStoreTest, CompressedPolicy) {
+    InvertedIndex idx;
+    idx.setDocumentStorePolicy(DocumentStorePolicy::Compressed);
+    idx.updateDocumentBaseFromStrings({"milk sugar salt", "london is the capital of great britain"});
+
+    EXPECT_EQ(idx.getDocument(1), "london is the capital of great britain");
+    EXPECT_FALSE(idx.getDocument(2).has_value());
+}
+
+TEST(DocumentStoreTest, MappedPolicyReadsSource) {
+    const string path = "mapped_doc.txt";
+    const string text = "milk water milk";
+    {
+        ofstream out(path);
+        out << text;
+    }
+
+    InvertedIndex idx;
+    idx.setDocumentStorePolicy(DocumentStorePolicy::Mapped);
+    idx.updateDocumentBaseFromStrings({text, "no source file"}, {path});
+
+    EXPECT_EQ(idx.getDocument(0), text);
+    // Без исходного файла документ хранится сжатым
+    EXPECT_EQ(idx.getDocument(1), "no source file");
+
+    filesystem::remove(path);
+    EXPECT_FALSE(idx.getDocument(0).has_value());
+}
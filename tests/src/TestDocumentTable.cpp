@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+#include "DocumentTable.h"
+#include "Hash.h"
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+#include "ShardedIndex.h"
+#include "ShardedSearchServer.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+TEST(DocumentTableTest, XXH64ReferenceValues) {
+    EXPECT_EQ(XXH64(""), 0xEF46DB3751D8E999ULL);
+    EXPECT_EQ(XXH64("a"), 0xD24EC4F1A98C6E5BULL);
+    EXPECT_EQ(XXH64("abc"), 0x44BC2CF5AD770999ULL);
+
+    // Длинный текст проходит через четыре аккумулятора и хвост
+    string text(1000, 'x');
+    EXPECT_EQ(XXH64(text), XXH64(text.data(), text.size()));
+    EXPECT_NE(XXH64(text), XXH64(text, 1));
+    text[999] = 'y';
+    EXPECT_NE(XXH64(text), XXH64(string(1000, 'x')));
+}
+
+TEST(DocumentTableTest, ColumnsAndFields) {
+    DocumentTable table;
+    table.reset(3);
+    table.set(0, "", "milk water", 0);
+    table.set(2, "missing/file.txt", "tea", 0);
+    table.setFields({
+        {{"year", 2020.0}, {"author", string("Smith")}},
+        {{"year", 2024.0}, {"author", string("Smith")}},
+        {{"year", string("unknown")}}  // тип не совпадает со столбцом — не сохраняется
+    });
+
+    DocumentInfo info = table.get(0);
+    EXPECT_EQ(info.size, 10u);
+    EXPECT_EQ(info.hash, XXH64("milk water"));
+    EXPECT_EQ(info.mtime, 0);
+    EXPECT_EQ(info.fields, (DocumentFields{{"author", string("Smith")}, {"year", 2020.0}}));
+
+    EXPECT_EQ(table.path(2), "missing/file.txt");
+    EXPECT_TRUE(table.get(2).fields.empty());
+
+    const FieldColumn* year = table.field("year");
+    ASSERT_NE(year, nullptr);
+    EXPECT_TRUE(year->numeric());
+    EXPECT_EQ(year->number(1), 2024.0);
+    EXPECT_TRUE(std::isnan(year->number(2)));
+    EXPECT_FALSE(table.field("author")->numeric());
+    EXPECT_EQ(table.field("missing"), nullptr);
+}
+
+TEST(DocumentTableTest, IndexReturnsDocumentInfo) {
+    const string path = "../tests/resources/doc1.txt";
+    InvertedIndex index;
+    index.setDocumentFields({{{"year", 2021.0}}});
+    index.updateDocumentBase({path});
+
+    SearchServer server(index);
+    vector<DocumentInfo> documents = server.documents({{0, 1.0f}});
+    ASSERT_EQ(documents.size(), 1u);
+    EXPECT_EQ(documents[0].path, path);
+    EXPECT_EQ(documents[0].mtime, FileModificationTime(path));
+    EXPECT_GT(documents[0].mtime, 0);
+    EXPECT_EQ(documents[0].fields, (DocumentFields{{"year", 2021.0}}));
+    ASSERT_TRUE(documents[0].size > 0);
+
+    // Шардированный индекс возвращает сведения по глобальным номерам
+    vector<string> docs = {"milk", "water", "milk water"};
+    ShardedIndex sharded(2);
+    sharded.setDocumentFields({{{"n", 0.0}}, {{"n", 1.0}}, {{"n", 2.0}}});
+    sharded.updateDocumentBaseFromStrings(docs, {"a", "b", "c"});
+    ShardedSearchServer sharded_server(sharded);
+    documents = sharded_server.documents({{2, 1.0f}, {1, 0.5f}});
+    EXPECT_EQ(documents[0].path, "c");
+    EXPECT_EQ(documents[0].hash, XXH64("milk water"));
+    EXPECT_EQ(documents[0].fields, (DocumentFields{{"n", 2.0}}));
+    EXPECT_EQ(documents[1].path, "b");
+}
@@ -23,3 +23,26 @@ TEST(RelativeIndexTest, EqualityOperator) {
     EXPECT_FALSE(r1 == r3);
     EXPECT_FALSE(r1 == r4);
 }
+
+TEST(EntryTest, CompactLayout) {
+#ifndef SEARCH_ENGINE_WIDE_IDS
+    EXPECT_EQ(sizeof(Entry), 8u);
+    EXPECT_EQ(sizeof(RelativeIndex), 8u);
+#endif
+    EXPECT_EQ(sizeof(Entry), sizeof(DocId) + sizeof(TermCount));
+}
+
+TEST(PostingsTest, ColumnsMatchEntries) {
+    Postings postings;
+    postings.push_back(1, 10);
+    postings.push_back(4, 2);
+
+    Postings more;
+    more.push_back(7, 1);
+    postings.append(more);
+
+    EXPECT_EQ(postings.doc_ids, (std::vector<DocId>{1, 4, 7}));
+    EXPECT_EQ(postings.counts, (std::vector<TermCount>{10, 2, 1}));
+    EXPECT_EQ(postings[1], (Entry{4, 2}));
+    EXPECT_EQ(postings.entries(), (std::vector<Entry>{{1, 10}, {4, 2}, {7, 1}}));
+}
@@ -0,0 +1,82 @@
+#include "gtest/gtest.h"
+#include "ExternalIndexBuilder.h"
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+vector<string> Corpus() {
+    vector<string> docs;
+    const vector<string> words = {"milk", "water", "tea", "coffee", "sugar", "london", "capital", "bread"};
+    for (size_t i = 0; i < 60; ++i) {
+        string doc;
+        for (size_t k = 0; k < words.size(); ++k) {
+            size_t repeat = (i * (k + 2) + k) % 4;
+            for (size_t r = 0; r < repeat; ++r) doc += words[k] + ", ";
+        }
+        docs.push_back(doc);
+    }
+    return docs;
+}
+
+} // namespace
+
+TEST(ExternalIndexBuilderTest, MatchesInMemoryIndex) {
+    vector<string> docs = Corpus();
+    fs::path temp_dir = fs::temp_directory_path() / "search_engine_test_runs";
+    string index_path = (temp_dir / "index.bin").string();
+    string error;
+
+    ExternalIndexBuilder builder(temp_dir.string(), 512);
+    for (const auto& doc : docs) ASSERT_TRUE(builder.addDocument(doc, error)) << error;
+    ASSERT_TRUE(builder.finish(index_path, error)) << error;
+    EXPECT_GT(builder.runCount(), 1u);
+    EXPECT_FALSE(fs::exists(temp_dir / "run_0.tmp"));
+
+    InvertedIndex expected;
+    expected.updateDocumentBaseFromStrings(docs);
+    InvertedIndex loaded;
+    ASSERT_TRUE(loaded.loadFromFile(index_path, error)) << error;
+
+    EXPECT_EQ(loaded.documentCount(), docs.size());
+    EXPECT_EQ(loaded.terms().size(), expected.terms().size());
+    for (auto it = expected.terms().begin(); it.valid(); it.next()) {
+        EXPECT_EQ(loaded.getWordCount(it.term()), expected.getWordCount(it.term())) << it.term();
+    }
+
+    vector<string> queries = {"milk", "tea coffee", "london OR bread", "capit*"};
+    EXPECT_EQ(SearchServer(loaded, 10).search(queries), SearchServer(expected, 10).search(queries));
+    fs::remove_all(temp_dir);
+}
+
+TEST(ExternalIndexBuilderTest, RejectsCorruptedFile) {
+    fs::path path = fs::temp_directory_path() / "search_engine_bad_index.bin";
+    {
+        ofstream out(path, ios::binary);
+        out << "SEPL\x01\x02\x04milk\x05";  // список обрывается
+    }
+    InvertedIndex index;
+    string error;
+    EXPECT_FALSE(index.loadFromFile(path.string(), error));
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(index.loadFromFile((fs::temp_directory_path() / "missing_index.bin").string(), error));
+    fs::remove(path);
+}
+
+TEST(ExternalIndexBuilderTest, TempDirectoriesAreUnique) {
+    auto first = CreateUniqueTempDirectory("search_engine_test_unique_");
+    auto second = CreateUniqueTempDirectory("search_engine_test_unique_");
+    ASSERT_TRUE(first && second);
+    EXPECT_NE(*first, *second);
+    EXPECT_TRUE(fs::is_directory(*first));
+    EXPECT_TRUE(fs::is_empty(*second));
+    fs::remove_all(*first);
+    fs::remove_all(*second);
+}
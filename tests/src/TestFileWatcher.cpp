@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+#include "FileWatcher.h"
+#include "IndexWatcher.h"
+#include "SearchServer.h"
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Пачки изменений, полученные из потока наблюдения
+class BatchCollector {
+public:
+    void add(const vector<size_t>& changed) {
+        lock_guard<mutex> lock(m);
+        batches.push_back(changed);
+        cv.notify_all();
+    }
+
+    bool waitFor(size_t count) {
+        unique_lock<mutex> lock(m);
+        return cv.wait_for(lock, chrono::seconds(10), [&]() { return batches.size() >= count; });
+    }
+
+    vector<vector<size_t>> get() {
+        lock_guard<mutex> lock(m);
+        return batches;
+    }
+
+private:
+    mutex m;
+    condition_variable cv;
+    vector<vector<size_t>> batches;
+};
+
+fs::path MakeDirectory(const string& name) {
+    fs::path dir = fs::temp_directory_path() / name;
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    return dir;
+}
+
+void WriteFile(const fs::path& path, const string& text) {
+    ofstream(path, ios::binary) << text;
+}
+
+void ExpectBatchedChanges(bool force_polling) {
+    fs::path dir = MakeDirectory(force_polling ? "se_watch_polling" : "se_watch_default");
+    vector<string> paths;
+    for (int i = 0; i < 3; ++i) {
+        paths.push_back((dir / ("doc" + to_string(i) + ".txt")).string());
+        WriteFile(paths.back(), "milk");
+    }
+
+    WatchOptions options;
+    options.debounce = chrono::milliseconds(300);
+    options.poll_interval = chrono::milliseconds(20);
+    options.force_polling = force_polling;
+    FileWatcher watcher(paths, options);
+    BatchCollector batches;
+    string error;
+    ASSERT_TRUE(watcher.start([&](const vector<size_t>& changed) { batches.add(changed); }, error)) << error;
+    if (force_polling) {
+        EXPECT_FALSE(watcher.usesInotify());
+    }
+
+    // Запись на месте и замена переименованием попадают в одну пачку
+    WriteFile(paths[2], "milk water");
+    WriteFile(dir / "new.tmp", "tea tea tea");
+    fs::rename(dir / "new.tmp", paths[0]);
+    WriteFile(dir / "unrelated.txt", "coffee");
+
+    ASSERT_TRUE(batches.waitFor(1));
+    watcher.stop();
+    auto result = batches.get();
+    ASSERT_EQ(result.size(), 1u);
+    EXPECT_EQ(result[0], (vector<size_t>{0, 2}));
+    fs::remove_all(dir);
+}
+
+} // namespace
+
+TEST(FileWatcherTest, BatchesChanges) {
+    ExpectBatchedChanges(false);
+}
+
+TEST(FileWatcherTest, PollingFallbackBatchesChanges) {
+    ExpectBatchedChanges(true);
+}
+
+TEST(FileWatcherTest, IndexFollowsFiles) {
+    fs::path dir = MakeDirectory("se_watch_index");
+    vector<string> paths;
+    const vector<string> texts = {"milk water", "water", "tea"};
+    for (size_t i = 0; i < texts.size(); ++i) {
+        paths.push_back((dir / ("doc" + to_string(i) + ".txt")).string());
+        WriteFile(paths.back(), texts[i]);
+    }
+    auto index = make_shared<InvertedIndex>();
+    index->updateDocumentBase(paths);
+    auto snapshots = make_shared<IndexSnapshots>(std::move(index));
+    SearchServer server(snapshots, 5);
+
+    WatchOptions options;
+    options.debounce = chrono::milliseconds(200);
+    options.poll_interval = chrono::milliseconds(20);
+    IndexWatcher watcher(snapshots, options);
+
+    // Файл с прежним содержимым не переиндексируется и версия не публикуется
+    ReloadStats stats = watcher.apply({1});
+    EXPECT_EQ(stats.files_read, 1u);
+    EXPECT_EQ(stats.files_changed, 0u);
+    EXPECT_EQ(snapshots->version(), 0u);
+
+    BatchCollector batches;
+    string error;
+    ASSERT_TRUE(watcher.start(error, [&](const ReloadStats& s) { batches.add({s.files_changed}); })) << error;
+    WriteFile(paths[2], "milk milk tea");
+    fs::remove(paths[1]);
+    ASSERT_TRUE(batches.waitFor(1));
+    watcher.stop();
+
+    // Удалённый файл стал пустым документом
+    EXPECT_EQ(batches.get()[0], (vector<size_t>{2}));
+    EXPECT_EQ(snapshots->version(), 1u);
+    EXPECT_EQ(server.search({"milk"})[0], (vector<RelativeIndex>{{2, 1.0f}, {0, 0.5f}}));
+    EXPECT_TRUE(server.search({"water"})[0] == (vector<RelativeIndex>{{0, 1.0f}}));
+    EXPECT_EQ(snapshots->acquire()->documentTable().get(2).size, 13u);
+    fs::remove_all(dir);
+}
@@ -0,0 +1,298 @@
+#include "gtest/gtest.h"
+#include "DocumentLoader.h"
+#include "IndexManifest.h"
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+namespace {
+
+vector<string> Corpus() {
+    vector<string> docs;
+    const vector<string> words = {"milk", "water", "tea", "coffee", "sugar", "london", "capital"};
+    for (size_t i = 0; i < 30; ++i) {
+        string doc;
+        for (size_t k = 0; k < words.size(); ++k) {
+            size_t repeat = (i * (k + 3) + k) % 4;
+            for (size_t r = 0; r < repeat; ++r) doc += words[k] + " ";
+        }
+        docs.push_back(doc);
+    }
+    return docs;
+}
+
+// Все слова индекса со списками и позициями
+void ExpectSameIndex(const InvertedIndex& actual, const InvertedIndex& expected) {
+    ASSERT_EQ(actual.terms().size(), expected.terms().size());
+    for (const auto& word : expected.terms().expandWildcard("*", SIZE_MAX)) {
+        auto entries = expected.getWordCount(word);
+        ASSERT_EQ(actual.getWordCount(word), entries) << word;
+        if (!expected.hasPositions()) continue;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            EXPECT_EQ(actual.getPositionList(word)->decode(i), expected.getPositionList(word)->decode(i)) << word;
+        }
+    }
+}
+
+void WriteFile(const fs::path& path, const string& text, int hours_ago) {
+    ofstream(path, ios::binary) << text;
+    fs::last_write_time(path, fs::file_time_type::clock::now() - chrono::hours(hours_ago));
+}
+
+} // namespace
+
+TEST(IndexManifestTest, ReindexMatchesFreshBuild) {
+    vector<string> docs = Corpus();
+    InvertedIndex index;
+    index.setPositionalIndex(true);
+    index.updateDocumentBaseFromStrings(docs);
+
+    // Изменённые документы: новые слова, исчезнувшие слова, пустой текст
+    vector<size_t> changed = {17, 3, 29};
+    vector<string> texts = {"milk bread bread", "", "tea london newword"};
+    for (size_t k = 0; k < changed.size(); ++k) docs[changed[k]] = texts[k];
+    index.reindexDocuments(changed, texts);
+
+    InvertedIndex fresh;
+    fresh.setPositionalIndex(true);
+    fresh.updateDocumentBaseFromStrings(docs);
+    ExpectSameIndex(index, fresh);
+    EXPECT_EQ(index.documentTable().hash(3), fresh.documentTable().hash(3));
+
+    vector<string> queries = {"milk", "bread", "\"tea london\"", "newword", "capital -sugar"};
+    EXPECT_EQ(SearchServer(index).search(queries), SearchServer(fresh).search(queries));
+}
+
+TEST(IndexManifestTest, ReindexUpdatesPairIndex) {
+    // Все слова корпуса — частые: набор пар тот же, что у нового построения
+    vector<string> docs = Corpus();
+    InvertedIndex index;
+    index.setPairIndexTerms(7);
+    index.updateDocumentBaseFromStrings(docs);
+    vector<size_t> changed = {2, 11, 20};
+    vector<string> texts = {"milk", "", "tea london london milk"};
+    for (size_t k = 0; k < changed.size(); ++k) docs[changed[k]] = texts[k];
+    index.reindexDocuments(changed, texts);
+
+    InvertedIndex fresh;
+    fresh.setPairIndexTerms(7);
+    fresh.updateDocumentBaseFromStrings(docs);
+    const vector<string> words = {"milk", "water", "tea", "coffee", "sugar", "london", "capital"};
+    for (const auto& a : words) {
+        for (const auto& b : words) {
+            const CompressedPostings* expected = fresh.findPairPostings(a, b);
+            const CompressedPostings* actual = index.findPairPostings(a, b);
+            ASSERT_EQ(actual == nullptr, expected == nullptr) << a << " " << b;
+            if (!expected) continue;
+            Postings x, y;
+            actual->decode(x);
+            expected->decode(y);
+            EXPECT_EQ(x.entries(), y.entries()) << a << " " << b;
+        }
+    }
+}
+
+TEST(IndexManifestTest, ReindexAfterLoadMatchesFreshBuild) {
+    // Прямой индекс загруженного индекса строится из списков при первой переиндексации
+    vector<string> docs = Corpus();
+    InvertedIndex built;
+    built.updateDocumentBaseFromStrings(docs);
+    fs::path path = fs::temp_directory_path() / "search_engine_test_forward.bin";
+    string error;
+    ASSERT_TRUE(built.saveToFile(path.string(), error)) << error;
+
+    InvertedIndex index;
+    ASSERT_TRUE(index.loadFromFile(path.string(), error)) << error;
+    EXPECT_EQ(index.memoryUsage().forward_bytes, 0u);
+    vector<size_t> changed = {0, 12};
+    vector<string> texts = {"bread", "milk milk sugar"};
+    for (size_t k = 0; k < changed.size(); ++k) docs[changed[k]] = texts[k];
+    index.reindexDocuments(changed, texts);
+    EXPECT_GT(index.memoryUsage().forward_bytes, 0u);
+    // Повторное изменение тех же документов опирается на обновлённый прямой индекс
+    texts = {"water", "coffee"};
+    for (size_t k = 0; k < changed.size(); ++k) docs[changed[k]] = texts[k];
+    index.reindexDocuments(changed, texts);
+    // Номер исчезнувшего слова достаётся новому
+    changed = {5};
+    texts = {"fresh milk"};
+    docs[5] = texts[0];
+    index.reindexDocuments(changed, texts);
+    changed = {5, 12};
+    texts = {"tea", "fresh"};
+    docs[5] = texts[0];
+    docs[12] = texts[1];
+    index.reindexDocuments(changed, texts);
+
+    InvertedIndex fresh;
+    fresh.updateDocumentBaseFromStrings(docs);
+    ExpectSameIndex(index, fresh);
+    EXPECT_TRUE(index.getWordCount("bread").empty());
+    fs::remove(path);
+}
+
+TEST(IndexManifestTest, ReindexKeepsMtimeTakenBeforeRead) {
+    fs::path dir = fs::temp_directory_path() / "search_engine_test_mtime";
+    fs::create_directories(dir);
+    const string path = (dir / "doc.txt").string();
+    WriteFile(path, "milk water", 3);
+    string text, error;
+    int64_t mtime = 0;
+    ASSERT_TRUE(ReadWholeFile(path, text, error, &mtime)) << error;
+    EXPECT_EQ(mtime, FileModificationTime(path));
+
+    InvertedIndex index;
+    index.updateDocumentBaseFromStrings({"tea"}, {path});
+    // Файл изменён после чтения: сохраняется время прочитанной версии,
+    // и следующая проверка по отпечатку увидит изменение
+    WriteFile(path, "milk water bread", 1);
+    index.reindexDocuments({0}, {text}, {path}, {mtime});
+    EXPECT_EQ(index.documentTable().get(0).mtime, mtime);
+    EXPECT_NE(index.documentTable().get(0).mtime, FileModificationTime(path));
+    fs::remove_all(dir);
+}
+
+TEST(IndexManifestTest, ManifestRoundTrip) {
+    fs::path path = fs::temp_directory_path() / "search_engine_test.manifest";
+    IndexManifest manifest{0xfeedbeefcafe1234ULL, 1700000000, {{"dir with space/a.txt", 12, 1699999999, 0xabcdef},
+                                                               {"b.txt", 0, 0, 0}}};
+    string error;
+    ASSERT_TRUE(SaveManifest(path.string(), manifest, error)) << error;
+
+    IndexManifest loaded;
+    ASSERT_TRUE(LoadManifest(path.string(), loaded, error)) << error;
+    EXPECT_EQ(loaded.settings, manifest.settings);
+    EXPECT_EQ(loaded.saved_at, manifest.saved_at);
+    EXPECT_EQ(loaded.files, manifest.files);
+    fs::remove(path);
+
+    EXPECT_FALSE(LoadManifest(path.string(), loaded, error));
+}
+
+TEST(IndexManifestTest, ReloadReadsOnlyChangedFiles) {
+    fs::path dir = fs::temp_directory_path() / "search_engine_test_reload";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    vector<string> docs = Corpus();
+    vector<string> paths;
+    for (size_t i = 0; i < docs.size(); ++i) {
+        paths.push_back((dir / ("doc" + to_string(i) + ".txt")).string());
+        WriteFile(paths.back(), docs[i], 3);
+    }
+    const string index_path = (dir / "index.bin").string();
+    string error;
+    ReloadStats stats;
+
+    InvertedIndex first;
+    ASSERT_TRUE(ReloadIndex(first, paths, index_path, stats, error)) << error;
+    EXPECT_TRUE(stats.full_rebuild);
+
+    // Ничего не изменилось: файлы не читаются
+    InvertedIndex second;
+    ASSERT_TRUE(ReloadIndex(second, paths, index_path, stats, error)) << error;
+    EXPECT_FALSE(stats.full_rebuild);
+    EXPECT_EQ(stats.files_read, 0u);
+    ExpectSameIndex(second, first);
+
+    // Один файл изменён, другой только «тронут» (то же содержимое, другое время)
+    docs[4] = "bread and milk";
+    WriteFile(paths[4], docs[4], 2);
+    WriteFile(paths[7], docs[7], 2);
+    InvertedIndex third;
+    ASSERT_TRUE(ReloadIndex(third, paths, index_path, stats, error)) << error;
+    EXPECT_FALSE(stats.full_rebuild);
+    EXPECT_EQ(stats.files_read, 2u);
+    EXPECT_EQ(stats.files_changed, 1u);
+
+    InvertedIndex fresh;
+    fresh.updateDocumentBaseFromStrings(docs, paths);
+    ExpectSameIndex(third, fresh);
+    EXPECT_EQ(third.documentTable().get(4), fresh.documentTable().get(4));
+
+    // Другие настройки разбора — индекс строится заново
+    InvertedIndex lowercase;
+    lowercase.setLowercase(true);
+    ASSERT_TRUE(ReloadIndex(lowercase, paths, index_path, stats, error)) << error;
+    EXPECT_TRUE(stats.full_rebuild);
+
+    fs::remove_all(dir);
+}
+
+TEST(IndexManifestTest, ReloadIndexesUnreadableFileAsEmpty) {
+    fs::path dir = fs::temp_directory_path() / "search_engine_test_reload_missing";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    vector<string> docs = Corpus();
+    vector<string> paths;
+    for (size_t i = 0; i < docs.size(); ++i) {
+        paths.push_back((dir / ("doc" + to_string(i) + ".txt")).string());
+        WriteFile(paths.back(), docs[i], 3);
+    }
+    const string index_path = (dir / "index.bin").string();
+    string error;
+    ReloadStats stats;
+    InvertedIndex first;
+    ASSERT_TRUE(ReloadIndex(first, paths, index_path, stats, error)) << error;
+
+    // Пропавший файл не прерывает обновление: документ становится пустым, как при полном построении
+    fs::remove(paths[6]);
+    InvertedIndex second;
+    ASSERT_TRUE(ReloadIndex(second, paths, index_path, stats, error)) << error;
+    EXPECT_FALSE(stats.full_rebuild);
+    EXPECT_EQ(stats.files_changed, 1u);
+    InvertedIndex fresh;
+    fresh.updateDocumentBase(paths);
+    ExpectSameIndex(second, fresh);
+    EXPECT_EQ(second.documentTable().get(6), fresh.documentTable().get(6));
+    EXPECT_EQ(second.documentTable().path(6), paths[6]);
+
+    // Время 0 в манифесте: вернувшийся файл будет прочитан
+    WriteFile(paths[6], docs[6], 3);
+    InvertedIndex third;
+    ASSERT_TRUE(ReloadIndex(third, paths, index_path, stats, error)) << error;
+    EXPECT_EQ(stats.files_read, 1u);
+    ExpectSameIndex(third, first);
+    fs::remove_all(dir);
+}
+
+TEST(IndexManifestTest, ReloadRereadsFileRewrittenInTheSameSecond) {
+    fs::path dir = fs::temp_directory_path() / "search_engine_test_reload_same_second";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    vector<string> paths = {(dir / "a.txt").string(), (dir / "b.txt").string()};
+    WriteFile(paths[0], "milk water", 3);
+    const string index_path = (dir / "index.bin").string();
+    string error;
+    ReloadStats stats;
+
+    // Начало новой секунды — худший случай: по грубым часам ядра файл может
+    // получить mtime предыдущей секунды. Файл записан и сразу проиндексирован
+    const auto second = [] { return chrono::duration_cast<chrono::seconds>(chrono::system_clock::now().time_since_epoch()); };
+    for (const auto start = second(); second() == start;) this_thread::sleep_for(chrono::milliseconds(1));
+    ofstream(paths[1], ios::binary) << "tea sugar";
+    InvertedIndex first;
+    ASSERT_TRUE(ReloadIndex(first, paths, index_path, stats, error)) << error;
+    const int64_t mtime = first.documentTable().get(1).mtime;
+
+    // Перезапись с тем же размером и тем же mtime — отличить её можно только по времени манифеста
+    const auto written = fs::last_write_time(paths[1]);
+    ofstream(paths[1], ios::binary) << "tea bread";
+    fs::last_write_time(paths[1], written);
+    ASSERT_EQ(FileModificationTime(paths[1]), mtime);
+
+    InvertedIndex second_index;
+    ASSERT_TRUE(ReloadIndex(second_index, paths, index_path, stats, error)) << error;
+    EXPECT_FALSE(stats.full_rebuild);
+    EXPECT_EQ(stats.files_changed, 1u);
+    EXPECT_EQ(second_index.getWordCount("bread"), (vector<Entry>{{1, 1}}));
+    EXPECT_TRUE(second_index.getWordCount("sugar").empty());
+    fs::remove_all(dir);
+}
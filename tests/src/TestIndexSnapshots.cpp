@@ -0,0 +1,120 @@
+#include "gtest/gtest.h"
+#include "IndexSnapshots.h"
+#include "SearchServer.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+TEST(IndexSnapshotsTest, OldVersionSurvivesPublish) {
+    auto snapshots = make_shared<IndexSnapshots>();
+    EXPECT_EQ(snapshots->version(), 0u);
+    EXPECT_EQ(snapshots->acquire()->documentCount(), 0u);
+
+    snapshots->rebuild([](InvertedIndex& idx) { idx.updateDocumentBaseFromStrings({"milk water"}); });
+    shared_ptr<const InvertedIndex> pinned = snapshots->acquire();
+    EXPECT_EQ(snapshots->version(), 1u);
+
+    snapshots->rebuild([](InvertedIndex& idx) { idx.updateDocumentBaseFromStrings({"tea", "tea milk"}); });
+    EXPECT_EQ(snapshots->version(), 2u);
+
+    // Закреплённая версия не меняется после публикации новой
+    EXPECT_EQ(pinned->documentCount(), 1u);
+    EXPECT_EQ(pinned->getWordCount("tea").size(), 0u);
+    EXPECT_EQ(snapshots->acquire()->documentCount(), 2u);
+    EXPECT_EQ(snapshots->acquire()->getWordCount("tea").size(), 2u);
+}
+
+TEST(IndexSnapshotsTest, UpdateSharesUntouchedLists) {
+    auto snapshots = make_shared<IndexSnapshots>();
+    snapshots->rebuild([](InvertedIndex& idx) {
+        idx.setPositionalIndex(true);
+        idx.updateDocumentBaseFromStrings({"milk water", "tea sugar", "milk tea"});
+    });
+    shared_ptr<const InvertedIndex> before = snapshots->acquire();
+    snapshots->update([](InvertedIndex& idx) { idx.reindexDocuments({1}, {"coffee sugar"}); });
+    shared_ptr<const InvertedIndex> after = snapshots->acquire();
+
+    // Списки слов, которых изменение не касается, общие у обеих версий
+    EXPECT_EQ(after->findPostings("milk"), before->findPostings("milk"));
+    EXPECT_EQ(after->getPositionList("water"), before->getPositionList("water"));
+    EXPECT_NE(after->findPostings("tea"), before->findPostings("tea"));
+    EXPECT_EQ(before->getWordCount("tea").size(), 2u);
+    EXPECT_EQ(after->getWordCount("tea").size(), 1u);
+    EXPECT_EQ(before->findPostings("coffee"), nullptr);
+    EXPECT_EQ(after->getWordCount("coffee").size(), 1u);
+}
+
+TEST(IndexSnapshotsTest, SearchDuringRebuild) {
+    // Две версии корпуса с разными ответами на один запрос
+    const vector<string> corpus_a = {"milk milk", "milk water", "water"};
+    const vector<string> corpus_b = {"water", "milk", "tea", "milk milk milk"};
+    const vector<RelativeIndex> expected_a = {{0, 1.0f}, {1, 0.5f}};
+    const vector<RelativeIndex> expected_b = {{3, 1.0f}, {1, 1.0f / 3}};
+
+    auto snapshots = make_shared<IndexSnapshots>();
+    snapshots->rebuild([&](InvertedIndex& idx) { idx.updateDocumentBaseFromStrings(corpus_a); });
+    SearchServer server(snapshots, 5);
+
+    atomic<bool> stop{false};
+    atomic<size_t> mismatches{0};
+    atomic<size_t> searches{0};
+    vector<thread> readers;
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&]() {
+            while (!stop.load()) {
+                auto result = server.search({"milk"});
+                if (result[0] != expected_a && result[0] != expected_b) ++mismatches;
+                ++searches;
+            }
+        });
+    }
+
+    while (searches.load() == 0) this_thread::yield();
+    for (int i = 0; i < 20; ++i) {
+        const auto& corpus = i % 2 == 0 ? corpus_b : corpus_a;
+        snapshots->rebuild([&](InvertedIndex& idx) { idx.updateDocumentBaseFromStrings(corpus); });
+    }
+    stop = true;
+    for (auto& t : readers) t.join();
+
+    EXPECT_EQ(mismatches.load(), 0u);
+    EXPECT_GT(searches.load(), 0u);
+    EXPECT_EQ(snapshots->version(), 21u);
+}
+
+TEST(IndexSnapshotsTest, UpdateCopiesOnlyTouchedBlocks) {
+    auto& memory = MemoryCounterFor<IndexMemoryTag>();
+    const size_t baseline = memory.current();
+    auto snapshots = make_shared<IndexSnapshots>();
+    // У каждого документа своё слово из букв (цифры не входят в слова)
+    auto letters = [](size_t n) {
+        string word;
+        for (; n > 0; n /= 26) word += static_cast<char>('a' + n % 26);
+        return word;
+    };
+    vector<string> docs;
+    for (size_t i = 0; i < 20000; ++i) docs.push_back("milk x" + letters(i + 1) + " tea" + letters(i % 50 + 1));
+    snapshots->rebuild([&docs](InvertedIndex& idx) {
+        idx.setPositionalIndex(true);
+        idx.setPairIndexTerms(8);
+        idx.updateDocumentBaseFromStrings(docs);
+    });
+    // Первая переиндексация строит прямой индекс
+    snapshots->update([](InvertedIndex& idx) { idx.reindexDocuments({3}, {"milk sugar"}); });
+    shared_ptr<const InvertedIndex> before = snapshots->acquire();
+    const size_t built = memory.current() - baseline;
+
+    snapshots->update([](InvertedIndex& idx) { idx.reindexDocuments({7}, {"milk coffee teah"}); });
+    shared_ptr<const InvertedIndex> after = snapshots->acquire();
+    // Пока обе версии живы, новая добавляет только скопированные сегменты
+    EXPECT_LT(memory.current() - baseline - built, built / 10);
+    EXPECT_EQ(&after->documentTable().path(15000), &before->documentTable().path(15000));
+    EXPECT_TRUE(after->terms().contains("coffee"));
+    EXPECT_FALSE(after->terms().contains("x" + letters(8)));
+    EXPECT_TRUE(before->terms().contains("x" + letters(8)));
+    EXPECT_EQ(after->getWordCount("coffee").size(), 1u);
+}
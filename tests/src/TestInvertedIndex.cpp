@@ -68,3 +68,80 @@ TEST(InvertedIndexTest, CaseSensitivity) {
     EXPECT_EQ(idx.getWordCount("Apple"), expected_Apple);
     EXPECT_EQ(idx.getWordCount("APPLE"), expected_APPLE);
 }
+
+TEST(InvertedIndexTest, MemoryUsageReport) {
+    InvertedIndex idx;
+    EXPECT_EQ(idx.memoryUsage().posting_bytes, 0);
+
+    vector<string> docs = {
+        "milk sugar salt",
+        "milk a milk b milk c milk d",
+        "averyveryverylongwordthatdoesnotfitintosso"
+    };
+    idx.updateDocumentBaseFromStrings(docs);
+
+    auto usage = idx.memoryUsage();
+    EXPECT_GE(usage.posting_bytes, 8 * 10); // 8 различных слов: заголовок блока и байты чисел
+    EXPECT_GT(usage.term_bytes, 0);
+    EXPECT_GT(usage.hash_table_bytes, 0);
+    EXPECT_GE(usage.document_bytes, docs[2].size());
+    EXPECT_GE(usage.peak_build_bytes, usage.posting_bytes);
+    EXPECT_GT(usage.dictionary_bytes, 0);
+    EXPECT_GT(usage.table_bytes, 0);
+    EXPECT_EQ(usage.forward_bytes, 0);  // прямой индекс строится только для переиндексации
+    EXPECT_EQ(usage.total(), usage.term_bytes + usage.posting_bytes +
+                             usage.hash_table_bytes + usage.position_bytes +
+                             usage.dictionary_bytes + usage.document_bytes + usage.table_bytes + usage.pair_bytes +
+                             usage.forward_bytes);
+
+    idx.reindexDocuments({0}, {"milk salt"});
+    EXPECT_GT(idx.memoryUsage().forward_bytes, 0);
+}
+
+TEST(InvertedIndexTest, PositionalIndex) {
+    InvertedIndex idx;
+    idx.setPositionalIndex(true);
+    vector<string> docs = {
+        "london is the capital of great britain",
+        "capital london london"
+    };
+    idx.updateDocumentBaseFromStrings(docs);
+
+    const PositionList* london = idx.getPositionList("london");
+    ASSERT_NE(london, nullptr);
+    ASSERT_EQ(london->size(), 2);
+    EXPECT_EQ(london->decode(0), vector<uint32_t>({0}));
+    EXPECT_EQ(london->decode(1), vector<uint32_t>({1, 2}));
+    EXPECT_GT(idx.memoryUsage().position_bytes, 0);
+
+    InvertedIndex plain;
+    plain.updateDocumentBaseFromStrings(docs);
+    EXPECT_EQ(plain.getPositionList("london"), nullptr);
+    EXPECT_EQ(plain.memoryUsage().position_bytes, 0);
+}
+
+TEST(InvertedIndexTest, StopWordsAndPairIndex) {
+    InvertedIndex idx;
+    idx.setStopWords({"the", "of"});
+    idx.setPairIndexTerms(3);
+    idx.updateDocumentBaseFromStrings({
+        "the milk of water",
+        "milk water water tea",
+        "milk tea",
+        "water"
+    });
+
+    EXPECT_TRUE(idx.getWordCount("the").empty());
+    EXPECT_TRUE(idx.getWordCount("of").empty());
+
+    // Три самых частых слова: milk и water (по 3 документа), tea (2)
+    const CompressedPostings* pair = idx.findPairPostings("water", "milk");
+    ASSERT_NE(pair, nullptr);
+    Postings both;
+    pair->decode(both);
+    EXPECT_EQ(both.entries(), (vector<Entry>{{0, 2}, {1, 3}}));
+    EXPECT_EQ(idx.findPairPostings("milk", "water"), pair);
+    EXPECT_NE(idx.findPairPostings("milk", "tea"), nullptr);
+    EXPECT_EQ(idx.findPairPostings("milk", "missing"), nullptr);
+    EXPECT_GT(idx.memoryUsage().pair_bytes, 0);
+}
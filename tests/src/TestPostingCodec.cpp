@@ -0,0 +1,114 @@
+#include "gtest/gtest.h"
+#include "PostingCodec.h"
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+vector<SimdLevel> SupportedLevels() {
+    vector<SimdLevel> levels = {SimdLevel::Scalar};
+    if (DetectSimdLevel() != SimdLevel::Scalar) levels.push_back(SimdLevel::Sse2);
+    if (DetectSimdLevel() == SimdLevel::Avx2) levels.push_back(SimdLevel::Avx2);
+    return levels;
+}
+
+// Возрастающие doc_id с разбросом разностей от 1 байта до 4
+Postings RandomPostings(size_t count, mt19937& rng) {
+    Postings entries;
+    DocId doc = rng() % 3;
+    for (size_t i = 0; i < count; ++i) {
+        entries.push_back(doc, 1 + rng() % (i % 7 == 0 ? 100000 : 5));
+        uint32_t shift = rng() % 4 * 7;
+        doc += 1 + (rng() % 200) * (size_t{1} << shift) % 2000000;  // doc_id остаются в 32 битах
+    }
+    return entries;
+}
+
+} // namespace
+
+TEST(PostingCodecTest, RoundTripAllSizes) {
+    mt19937 rng(7);
+    for (size_t count : {0, 1, 3, 4, 5, 127, 128, 129, 256, 1000}) {
+        Postings entries = RandomPostings(count, rng);
+        CompressedPostings compressed(entries);
+        EXPECT_EQ(compressed.size(), count);
+        for (SimdLevel level : SupportedLevels()) {
+            Postings decoded;
+            compressed.decode(decoded, level);
+            EXPECT_EQ(decoded.doc_ids, entries.doc_ids) << count << " " << SimdLevelName(level);
+            EXPECT_EQ(decoded.counts, entries.counts) << count << " " << SimdLevelName(level);
+        }
+    }
+}
+
+TEST(PostingCodecTest, CompressesDenseLists) {
+    Postings entries;
+    for (DocId d = 0; d < 10000; ++d) entries.push_back(d * 2, 1);
+    CompressedPostings compressed(entries);
+    // Разность и частота — по байту плюс управляющие биты
+    EXPECT_LT(compressed.memoryBytes(), entries.size() * 3);
+}
+
+TEST(PostingCodecTest, StreamVByteAndPrefixSum) {
+    vector<uint32_t> values = {0, 255, 256, 65535, 65536, 16777215, 16777216, 4294967295u, 7, 1, 2};
+    vector<uint8_t> bytes;
+    EncodeStreamVByte(values.data(), values.size(), bytes);
+
+    for (SimdLevel level : SupportedLevels()) {
+        vector<uint32_t> decoded(values.size());
+        const uint8_t* end = DecodeStreamVByte(bytes.data(), bytes.data() + bytes.size(), values.size(),
+                                               decoded.data(), level);
+        EXPECT_EQ(decoded, values) << SimdLevelName(level);
+        EXPECT_EQ(end, bytes.data() + bytes.size());
+
+        vector<uint32_t> sums = {1, 2, 3, 4, 5, 6, 7};
+        PrefixSum(sums.data(), sums.size(), 10, level);
+        EXPECT_EQ(sums, (vector<uint32_t>{11, 13, 16, 20, 25, 31, 38})) << SimdLevelName(level);
+    }
+}
+
+TEST(PostingCodecTest, DenseListsUseBitmap) {
+    Postings entries;
+    for (DocId d = 0; d < 1000; d += 3) entries.push_back(d, d % 5 == 0 ? 4000000000u : 1 + d % 7);
+    CompressedPostings compressed(entries);
+    ASSERT_TRUE(compressed.isBitmap());
+    EXPECT_EQ(compressed.size(), entries.size());
+
+    Postings decoded;
+    compressed.decode(decoded);
+    EXPECT_EQ(decoded.entries(), entries.entries());
+
+    uint32_t count = 0;
+    EXPECT_TRUE(compressed.lookup(999, count));
+    EXPECT_EQ(count, 1u + 999 % 7);
+    EXPECT_TRUE(compressed.lookup(15, count));
+    EXPECT_EQ(count, 4000000000u);
+    EXPECT_FALSE(compressed.lookup(1, count));
+    EXPECT_FALSE(compressed.lookup(100000, count));
+
+    Postings sparse;
+    sparse.push_back(0, 1);
+    sparse.push_back(1000000, 1);
+    EXPECT_FALSE(CompressedPostings(sparse).isBitmap());
+}
+
+TEST(PostingCodecTest, IntersectBitmaps) {
+    Postings a, b;
+    for (DocId d = 0; d < 2000; d += 2) a.push_back(d, d % 3 + 1);
+    for (DocId d = 0; d < 1500; d += 3) b.push_back(d, d % 5 + 1);
+    CompressedPostings ca(a), cb(b);
+    ASSERT_TRUE(ca.isBitmap());
+    ASSERT_TRUE(cb.isBitmap());
+
+    vector<DocId> docs;
+    CompressedPostings::IntersectBitmaps(ca, cb, [&](DocId doc, uint32_t count_a, uint32_t count_b) {
+        EXPECT_EQ(count_a, doc % 3 + 1);
+        EXPECT_EQ(count_b, doc % 5 + 1);
+        docs.push_back(doc);
+    });
+    vector<DocId> expected;
+    for (DocId d = 0; d < 1500; d += 6) expected.push_back(d);
+    EXPECT_EQ(docs, expected);
+}
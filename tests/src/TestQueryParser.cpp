@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+#include "QueryParser.h"
+#include <sstream>
+#include <string>
+
+using namespace std;
+
+namespace {
+
+// Печатает план в компактном виде для сравнения
+string Dump(const QueryNode* node) {
+    if (!node) return "<empty>";
+    switch (node->type) {
+        case QueryNode::Type::Term:
+            return node->words.front();
+        case QueryNode::Type::Phrase: {
+            string out = "\"";
+            for (size_t i = 0; i < node->words.size(); ++i) {
+                out += (i ? " " : "") + node->words[i];
+            }
+            out += "\"";
+            if (node->slop) out += "~" + to_string(node->slop);
+            return out;
+        }
+        case QueryNode::Type::Wildcard:
+            return node->words.front();
+        case QueryNode::Type::Fuzzy:
+            return node->words.front() + "~" + to_string(node->slop);
+        case QueryNode::Type::Range:
+            return "[" + node->words[0] + " TO " + node->words[1] + "]";
+        case QueryNode::Type::Filter: {
+            const char* ops[] = {"<", "<=", "=", ">=", ">"};
+            ostringstream out;
+            out << node->words.front() << ops[static_cast<int>(node->compare)] << node->value;
+            return out.str();
+        }
+        case QueryNode::Type::Not:
+            return "NOT(" + Dump(node->children.front().get()) + ")";
+        case QueryNode::Type::And:
+        case QueryNode::Type::Or: {
+            string out = node->type == QueryNode::Type::And ? "AND(" : "OR(";
+            for (size_t i = 0; i < node->children.size(); ++i) {
+                out += (i ? "," : "") + Dump(node->children[i].get());
+            }
+            return out + ")";
+        }
+    }
+    return "?";
+}
+
+string Parse(const string& query) {
+    return Dump(QueryParser::Parse(query).get());
+}
+
+} // namespace
+
+TEST(QueryParserTest, ImplicitAnd) {
+    EXPECT_EQ(Parse("milk water"), "AND(milk,water)");
+    EXPECT_EQ(Parse("milk AND water"), "AND(milk,water)");
+    EXPECT_EQ(Parse("milk milk"), "milk");
+    EXPECT_EQ(Parse("   "), "<empty>");
+}
+
+TEST(QueryParserTest, OrBindsLooserThanAnd) {
+    EXPECT_EQ(Parse("a b OR c"), "OR(AND(a,b),c)");
+    EXPECT_EQ(Parse("a (b OR c)"), "AND(a,OR(b,c))");
+    EXPECT_EQ(Parse("a OR b OR c"), "OR(a,b,c)");
+}
+
+TEST(QueryParserTest, NegationAndRequired) {
+    EXPECT_EQ(Parse("milk -water"), "AND(milk,NOT(water))");
+    EXPECT_EQ(Parse("milk NOT (water OR tea)"), "AND(milk,NOT(OR(water,tea)))");
+    EXPECT_EQ(Parse("+milk water"), "AND(milk,water)");
+    EXPECT_EQ(Parse("NOT NOT milk"), "milk");
+}
+
+TEST(QueryParserTest, Phrases) {
+    EXPECT_EQ(Parse("\"capital london\" big"), "AND(\"capital london\",big)");
+    EXPECT_EQ(Parse("\"capital london\"~3"), "\"capital london\"~3");
+    EXPECT_EQ(Parse("\"london\""), "london");
+    // Слишком большое расстояние не роняет разбор, а ограничивается
+    EXPECT_EQ(Parse("\"a b\"~99999999999999999999"), "\"a b\"~1000");
+    EXPECT_EQ(Parse("\"a b\"~5000"), "\"a b\"~1000");
+}
+
+TEST(QueryParserTest, LenientSyntax) {
+    EXPECT_EQ(Parse("(a OR b"), "OR(a,b)");
+    EXPECT_EQ(Parse("a ) b"), "AND(a,b)");
+    EXPECT_EQ(Parse("a OR"), "a");
+    EXPECT_EQ(Parse("NOT"), "<empty>");
+    EXPECT_EQ(Parse("\"open phrase"), "\"open phrase\"");
+}
+
+TEST(QueryParserTest, DeepNesting) {
+    // Глубина рекурсии ограничена: сотни тысяч скобок и отрицаний не роняют разбор
+    EXPECT_EQ(Parse(string(100000, '(') + "milk"), "milk");
+    EXPECT_EQ(Parse(string(100000, '(') + "a OR b" + string(100000, ')') + " c"), "AND(OR(a,b),c)");
+    EXPECT_EQ(Parse(string(100000, '-') + "milk"), "milk");
+    EXPECT_EQ(Parse(string(100001, '-') + "milk"), "NOT(milk)");
+    EXPECT_EQ(Parse(string(30, '(') + "a OR b" + string(30, ')') + " c"), "AND(OR(a,b),c)");
+}
+
+TEST(QueryParserTest, WildcardAndRange) {
+    auto node = QueryParser::Parse("capit* [a TO c]");
+    ASSERT_TRUE(node);
+    ASSERT_EQ(node->type, QueryNode::Type::And);
+    EXPECT_EQ(node->children[0]->type, QueryNode::Type::Wildcard);
+    EXPECT_EQ(node->children[0]->words.front(), "capit*");
+    EXPECT_EQ(node->children[1]->type, QueryNode::Type::Range);
+    EXPECT_EQ(node->children[1]->words, vector<string>({"a", "c"}));
+
+    EXPECT_EQ(Parse("[a b]"), "<empty>");
+}
+
+TEST(QueryParserTest, Fuzzy) {
+    EXPECT_EQ(Parse("milk~"), "milk~2");
+    EXPECT_EQ(Parse("milk~1 water"), "AND(milk~1,water)");
+    EXPECT_EQ(Parse("milk~0"), "milk~0");
+    EXPECT_EQ(Parse("milk~7"), "milk~2");
+    EXPECT_EQ(Parse("milk~x"), "milk~2");
+    // Переполнение числа правок не роняет разбор
+    EXPECT_EQ(Parse("milk~99999999999999999999"), "milk~2");
+}
+
+TEST(QueryParserTest, FieldFiltersAndSort) {
+    EXPECT_EQ(Parse("milk year>=2020"), "AND(milk,year>=2020)");
+    EXPECT_EQ(Parse("milk -price<2.5 rating=5"), "AND(milk,NOT(price<2.5),rating=5)");
+    EXPECT_EQ(Parse("a>b 1x>2"), "AND(a>b,1x>2)");  // не числа и не имена полей — обычные слова
+
+    SortOrder sort;
+    EXPECT_EQ(Dump(QueryParser::Parse("milk sort:-year water", sort).get()), "AND(milk,water)");
+    EXPECT_EQ(sort.field, "year");
+    EXPECT_TRUE(sort.descending);
+
+    SortOrder unchanged;
+    QueryParser::Parse("milk sort:", unchanged);
+    EXPECT_TRUE(unchanged.field.empty());
+}
@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
 #include "SearchServer.h"
 #include "InvertedIndex.h"
+#include "ShardedIndex.h"
+#include "ShardedSearchServer.h"
 #include <vector>
 #include <string>
 
@@ -50,3 +52,266 @@ TEST(SearchServerTest, MaxResponsesLimit) {
     // Проверяем, что количество результатов не больше 2
     EXPECT_LE(results[0].size(), 2);
 }
+
+TEST(SearchServerTest, PhraseAndProximity) {
+    vector<string> docs = {
+        "london is the capital of great britain",
+        "the capital london is big",
+        "capital city of london"
+    };
+    InvertedIndex idx;
+    idx.setPositionalIndex(true);
+    idx.updateDocumentBaseFromStrings(docs);
+    SearchServer server(idx);
+
+    auto results = server.search({"capital london", "\"capital london\"", "\"capital london\"~2", "\"london capital\"~0"});
+
+    EXPECT_EQ(results[0].size(), 3);
+    ASSERT_EQ(results[1].size(), 1);
+    EXPECT_EQ(results[1][0].doc_id, 1);
+    EXPECT_EQ(results[2].size(), 2);
+    EXPECT_TRUE(results[3].empty());
+}
+
+TEST(SearchServerTest, LongPhraseOverRepeatedWords) {
+    // Фраза из повторов одного слова в длинном документе: проверка линейна,
+    // перебор вариантов здесь не завершился бы
+    string repeated;
+    for (int i = 0; i < 400; ++i) repeated += "milk ";
+    vector<string> docs = {
+        "water " + repeated,
+        repeated + "water",
+        "tea milk milk bread sugar"
+    };
+    InvertedIndex idx;
+    idx.setPositionalIndex(true);
+    idx.updateDocumentBaseFromStrings(docs);
+    SearchServer server(idx);
+
+    string phrase = "\"";
+    for (int i = 0; i < 12; ++i) phrase += "milk ";
+    phrase += "water\"~50";
+    // Второе «milk» нужно взять не ближайшее к «tea», иначе до «sugar» далеко
+    auto results = server.search({phrase, "\"tea milk sugar\"~1"});
+
+    ASSERT_EQ(results[0].size(), 1);
+    EXPECT_EQ(results[0][0].doc_id, 1);
+    ASSERT_EQ(results[1].size(), 1);
+    EXPECT_EQ(results[1][0].doc_id, 2);
+}
+
+TEST(SearchServerTest, EmptyQuery) {
+    InvertedIndex idx;
+    idx.updateDocumentBaseFromStrings({"milk"});
+    SearchServer server(idx);
+
+    auto results = server.search({"", "   "});
+    ASSERT_EQ(results.size(), 2);
+    EXPECT_TRUE(results[0].empty());
+    EXPECT_TRUE(results[1].empty());
+}
+
+TEST(SearchServerTest, BooleanQueries) {
+    vector<string> docs = {
+        "milk water sugar",
+        "milk milk tea",
+        "water juice",
+        "coffee"
+    };
+    InvertedIndex idx;
+    idx.updateDocumentBaseFromStrings(docs);
+    SearchServer server(idx);
+
+    auto results = server.search({
+        "milk OR water",
+        "milk -water",
+        "(tea OR juice) NOT milk",
+        "coffee OR (milk water)",
+        "-milk"
+    });
+
+    ASSERT_EQ(results[0].size(), 3);
+    EXPECT_EQ(results[0][0].doc_id, 0); // milk + water = 2
+    EXPECT_FLOAT_EQ(results[0][0].rank, 1.0f);
+
+    ASSERT_EQ(results[1].size(), 1);
+    EXPECT_EQ(results[1][0].doc_id, 1);
+
+    ASSERT_EQ(results[2].size(), 1);
+    EXPECT_EQ(results[2][0].doc_id, 2);
+
+    ASSERT_EQ(results[3].size(), 2);
+    EXPECT_EQ(results[3][0].doc_id, 0);
+    EXPECT_EQ(results[3][1].doc_id, 3);
+
+    EXPECT_TRUE(results[4].empty());
+}
+
+TEST(SearchServerTest, WildcardAndRangeQueries) {
+    vector<string> docs = {
+        "the capital of great britain",
+        "capitalism and capitol",
+        "captain cat"
+    };
+    InvertedIndex idx;
+    idx.updateDocumentBaseFromStrings(docs);
+    SearchServer server(idx);
+
+    auto results = server.search({"capit*", "ca?", "[capital TO capitol]", "zz*", "capit* great"});
+    EXPECT_EQ(results[0].size(), 2);
+    ASSERT_EQ(results[1].size(), 1);
+    EXPECT_EQ(results[1][0].doc_id, 2);
+    EXPECT_EQ(results[2].size(), 2);
+    EXPECT_TRUE(results[3].empty());
+    ASSERT_EQ(results[4].size(), 1);
+    EXPECT_EQ(results[4][0].doc_id, 0);
+
+    server.setMaxExpansions(1);
+    auto limited = server.search({"capit*"});
+    ASSERT_EQ(limited[0].size(), 1); // только "capital"
+    EXPECT_EQ(limited[0][0].doc_id, 0);
+}
+
+TEST(SearchServerTest, FuzzyQueries) {
+    vector<string> docs = {
+        "london is the capital of great britain",
+        "milk milk milk water",
+        "milks"
+    };
+    InvertedIndex idx;
+    idx.updateDocumentBaseFromStrings(docs);
+    SearchServer server(idx);
+
+    auto results = server.search({"lodnon", "lodnon~", "capitl~1 great"});
+    EXPECT_TRUE(results[0].empty());
+    ASSERT_EQ(results[1].size(), 1);
+    EXPECT_EQ(results[1][0].doc_id, 0);
+    ASSERT_EQ(results[2].size(), 1);
+
+    server.setFuzzy(1);
+    auto fuzzy = server.search({"milk", "watr"});
+    ASSERT_EQ(fuzzy[0].size(), 2);
+    EXPECT_EQ(fuzzy[0][0].doc_id, 1); // точное совпадение выше
+    EXPECT_EQ(fuzzy[0][1].doc_id, 2);
+    EXPECT_LT(fuzzy[0][1].rank, 1.0f);
+    ASSERT_EQ(fuzzy[1].size(), 1);
+    EXPECT_EQ(fuzzy[1][0].doc_id, 1);
+}
+
+TEST(SearchServerTest, DenseTermsMatchDecodedIntersection) {
+    // "common" и "even" встречаются достаточно часто, чтобы храниться битовыми картами
+    vector<string> docs;
+    for (size_t d = 0; d < 300; ++d) {
+        string text = "common";
+        for (size_t k = 0; k < d % 3; ++k) text += " common";
+        if (d % 2 == 0) text += " even";
+        if (d % 50 == 0) text += " rare";
+        docs.push_back(text);
+    }
+    InvertedIndex idx;
+    idx.updateDocumentBaseFromStrings(docs);
+    SearchServer server(idx);
+    server.setMaxResponses(1000);
+
+    auto results = server.search({"common even", "even rare", "common AND even AND rare", "even -rare"});
+
+    ASSERT_EQ(results[0].size(), 150);
+    EXPECT_EQ(results[0][0].doc_id, 2);  // 3 × common + even
+    EXPECT_FLOAT_EQ(results[0][0].rank, 1.0f);
+    for (const auto& r : results[0]) {
+        EXPECT_EQ(r.doc_id % 2, 0u);
+        EXPECT_FLOAT_EQ(r.rank, (r.doc_id % 3 + 2) / 4.0f);
+    }
+
+    ASSERT_EQ(results[1].size(), 6);
+    for (const auto& r : results[1]) EXPECT_EQ(r.doc_id % 50, 0u);
+
+    ASSERT_EQ(results[2].size(), 6);
+    EXPECT_EQ(results[2][0].doc_id, 50);  // 3 × common + even + rare
+
+    EXPECT_EQ(results[3].size(), 144);
+}
+
+TEST(SearchServerTest, StopWordsAndPairIndex) {
+    vector<string> docs = {
+        "the capital of london",
+        "the milk and the water",
+        "milk water tea",
+        "the tea"
+    };
+    InvertedIndex plain;
+    plain.setPositionalIndex(true);
+    plain.setStopWords({"the", "of", "and"});
+    plain.updateDocumentBaseFromStrings(docs);
+
+    InvertedIndex paired;
+    paired.setPositionalIndex(true);
+    paired.setStopWords({"the", "of", "and"});
+    paired.setPairIndexTerms(4);
+    paired.updateDocumentBaseFromStrings(docs);
+
+    vector<string> queries = {"the", "the milk", "milk AND water", "water tea milk",
+                              "\"capital of london\"", "tea -the", "the OR tea"};
+    SearchServer plain_server(plain);
+    SearchServer paired_server(paired);
+    auto results = plain_server.search(queries);
+    EXPECT_EQ(paired_server.search(queries), results);
+
+    EXPECT_TRUE(results[0].empty());  // запрос только из стоп-слов
+    ASSERT_EQ(results[1].size(), 2u);
+    EXPECT_EQ(results[2].size(), 2u);
+    ASSERT_EQ(results[3].size(), 1u);
+    EXPECT_EQ(results[3][0].doc_id, 2u);
+    ASSERT_EQ(results[4].size(), 1u);
+    EXPECT_EQ(results[4][0].doc_id, 0u);
+    EXPECT_EQ(results[5].size(), 2u);
+    EXPECT_EQ(results[6].size(), 2u);
+}
+
+TEST(SearchServerTest, FieldFiltersAndSort) {
+    vector<string> docs = {
+        "milk water",        // year 2019
+        "milk milk water",   // year 2023
+        "milk water tea",    // year 2021
+        "milk",              // year 2024
+        "milk water water"   // без поля
+    };
+    vector<DocumentFields> fields = {{{"year", 2019.0}}, {{"year", 2023.0}}, {{"year", 2021.0}},
+                                     {{"year", 2024.0}}, {}};
+    InvertedIndex index;
+    index.setDocumentFields(fields);
+    index.updateDocumentBaseFromStrings(docs);
+    SearchServer server(index, 3);
+
+    auto ids = [](const vector<RelativeIndex>& results) {
+        vector<size_t> out;
+        for (const auto& r : results) out.push_back(r.doc_id);
+        return out;
+    };
+    vector<string> queries = {
+        "milk water year>=2021",
+        "milk water sort:-year",
+        "milk water sort:year",
+        "milk -year<2021",
+        "milk year>2020 sort:-year",
+        "milk missing>0"
+    };
+    auto results = server.search(queries);
+    EXPECT_EQ(ids(results[0]), (vector<size_t>{1, 2}));
+    EXPECT_EQ(ids(results[1]), (vector<size_t>{1, 2, 0}));
+    EXPECT_EQ(ids(results[2]), (vector<size_t>{0, 2, 1}));
+    EXPECT_EQ(ids(results[3]), (vector<size_t>{1, 2, 3}));  // у документа без поля условие ложно, исключение — нет
+    EXPECT_EQ(ids(results[4]), (vector<size_t>{3, 1, 2}));
+    EXPECT_TRUE(results[5].empty());
+
+    // Ранг — относительно лучшего по релевантности документа ответа
+    EXPECT_FLOAT_EQ(results[1][0].rank, 1.0f);
+    EXPECT_FLOAT_EQ(results[2][0].rank, 2.0f / 3.0f);
+
+    // Шарды сливают ответы в том же порядке
+    ShardedIndex sharded(2);
+    sharded.setDocumentFields(fields);
+    sharded.updateDocumentBaseFromStrings(docs);
+    ShardedSearchServer sharded_server(sharded, 3);
+    EXPECT_EQ(sharded_server.search(queries), results);
+}
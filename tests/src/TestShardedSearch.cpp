@@ -0,0 +1,64 @@
+#include "gtest/gtest.h"
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+#include "ShardedIndex.h"
+#include "ShardedSearchServer.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+vector<string> Corpus() {
+    vector<string> docs;
+    const vector<string> words = {"milk", "water", "tea", "coffee", "sugar", "london", "capital"};
+    for (size_t i = 0; i < 40; ++i) {
+        string doc;
+        for (size_t k = 0; k < words.size(); ++k) {
+            // Разное число повторов, чтобы ранги отличались
+            size_t repeat = (i * (k + 3)) % 5;
+            for (size_t r = 0; r < repeat; ++r) doc += words[k] + " ";
+        }
+        docs.push_back(doc);
+    }
+    return docs;
+}
+
+} // namespace
+
+TEST(ShardedSearchTest, MatchesSingleIndex) {
+    vector<string> docs = Corpus();
+    vector<string> queries = {"milk", "milk water", "tea OR coffee", "london -sugar", "capit*", "missing"};
+
+    InvertedIndex single;
+    single.updateDocumentBaseFromStrings(docs);
+    SearchServer server(single, 7);
+    auto expected = server.search(queries);
+
+    for (size_t shards : {1, 3, 4}) {
+        ShardedIndex sharded(shards);
+        sharded.updateDocumentBaseFromStrings(docs);
+        EXPECT_EQ(sharded.documentCount(), docs.size());
+
+        ShardedSearchServer sharded_server(sharded, 7);
+        auto actual = sharded_server.search(queries);
+        EXPECT_EQ(actual, expected) << shards << " shards";
+    }
+}
+
+TEST(ShardedSearchTest, GlobalDocIds) {
+    ShardedIndex sharded(2);
+    sharded.updateDocumentBaseFromStrings({"milk", "water", "milk water"});
+
+    EXPECT_EQ(sharded.shard(0).documentCount(), 2);
+    EXPECT_EQ(sharded.shard(1).documentCount(), 1);
+    EXPECT_EQ(sharded.globalDocId(0, 1), 2);
+    EXPECT_EQ(sharded.globalDocId(1, 0), 1);
+
+    ShardedSearchServer server(sharded);
+    auto results = server.search({"water"});
+    ASSERT_EQ(results[0].size(), 2);
+    EXPECT_EQ(results[0][0].doc_id, 1);
+    EXPECT_EQ(results[0][1].doc_id, 2);
+}
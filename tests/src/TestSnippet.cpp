@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+#include "ShardedIndex.h"
+#include "ShardedSearchServer.h"
+#include "Snippet.h"
+#include "TokenFilter.h"
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Подсвеченные слова фрагмента как строки
+vector<string> Highlighted(const Snippet& snippet) {
+    vector<string> words;
+    for (const auto& [offset, length] : snippet.highlights) words.push_back(snippet.text.substr(offset, length));
+    return words;
+}
+
+} // namespace
+
+TEST(SnippetTest, PicksWindowWithMostQueryWords) {
+    string text = "milk is here. then a long story about nothing at all, "
+                  "and finally London, the capital with milk.";
+    SnippetOptions limits;
+    limits.window_words = 5;
+
+    Snippet snippet = MakeSnippet(text, {"london", "capital", "milk"}, TokenizerOptions{true}, limits);
+    EXPECT_EQ(snippet.text, "London, the capital with milk.");
+    EXPECT_EQ(Highlighted(snippet), (vector<string>{"London", "capital", "milk"}));
+    EXPECT_EQ(snippet.highlights[0], make_pair(0u, 6u));
+}
+
+TEST(SnippetTest, ShortTextAndNoMatches) {
+    Snippet snippet = MakeSnippet("  milk water  ", {"tea"}, {});
+    EXPECT_EQ(snippet.text, "milk water");
+    EXPECT_TRUE(snippet.highlights.empty());
+
+    EXPECT_TRUE(MakeSnippet("   ", {"tea"}, {}).text.empty());
+}
+
+TEST(SnippetTest, StemmedWordsAndScanLimit) {
+    TokenizerOptions options;
+    options.lowercase = true;
+    options.filters = MakeStemmingPipeline({StemLanguage::English});
+
+    Snippet snippet = MakeSnippet("Cats were running home", {"run", "cat"}, options);
+    EXPECT_EQ(Highlighted(snippet), (vector<string>{"Cats", "running"}));
+
+    SnippetOptions limits;
+    limits.max_scan_bytes = 9;
+    snippet = MakeSnippet("milk tea water milk", {"water"}, {}, limits);
+    EXPECT_EQ(snippet.text, "milk tea");
+    EXPECT_TRUE(snippet.highlights.empty());
+}
+
+TEST(SnippetTest, SearchServerUsesDocumentStore) {
+    vector<string> docs = {
+        "water and tea",
+        "a story about milk and sugar, then about London the capital",
+        "coffee"
+    };
+    const vector<string> queries = {"london -coffee", "\"capital\" OR water"};
+
+    InvertedIndex index;
+    index.setDocumentStorePolicy(DocumentStorePolicy::Compressed);
+    index.setLowercase(true);
+    index.updateDocumentBaseFromStrings(docs);
+    SearchServer server(index);
+
+    SnippetOptions limits;
+    limits.window_words = 4;
+    auto results = server.search(queries);
+    ASSERT_EQ(results[0].size(), 1u);
+    Snippet snippet = server.snippets(queries[0], results[0], limits)[0];
+    EXPECT_EQ(snippet.text, "sugar, then about London");  // самое раннее из равных окон
+    EXPECT_EQ(Highlighted(snippet), (vector<string>{"London"}));
+
+    // Шардированный поиск возвращает те же фрагменты для глобальных номеров
+    ShardedIndex sharded(2);
+    sharded.setDocumentStorePolicy(DocumentStorePolicy::Compressed);
+    sharded.setLowercase(true);
+    sharded.updateDocumentBaseFromStrings(docs);
+    ShardedSearchServer sharded_server(sharded);
+    EXPECT_EQ(sharded_server.snippets(queries[1], results[1], limits), server.snippets(queries[1], results[1], limits));
+
+    // Без хранилища документов фрагменты пустые
+    InvertedIndex bare;
+    bare.updateDocumentBaseFromStrings(docs);
+    EXPECT_TRUE(SearchServer(bare).snippets(queries[0], results[0])[0].text.empty());
+}
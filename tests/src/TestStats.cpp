@@ -0,0 +1,47 @@
+#include "gtest/gtest.h"
+#include "Stats.h"
+#include "json.hpp"
+
+using json = nlohmann::json;
+
+TEST(StatsTest, CounterAccumulates) {
+    StatCounter c;
+    c.add();
+    c.add(41);
+    EXPECT_EQ(c.value(), 42);
+    c.reset();
+    EXPECT_EQ(c.value(), 0);
+}
+
+TEST(StatsTest, HistogramPercentiles) {
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 1000; ++v) {
+        h.record(v * 1000);
+    }
+
+    EXPECT_EQ(h.count(), 1000);
+    EXPECT_EQ(h.max(), 1000000);
+
+    // Погрешность корзин не превышает 1/16
+    auto p50 = static_cast<double>(h.percentile(0.5));
+    auto p99 = static_cast<double>(h.percentile(0.99));
+    EXPECT_NEAR(p50, 500000.0, 500000.0 / 16);
+    EXPECT_NEAR(p99, 990000.0, 990000.0 / 16);
+    EXPECT_LE(h.percentile(0.999), h.max());
+}
+
+TEST(StatsTest, EmptyHistogram) {
+    LatencyHistogram h;
+    EXPECT_EQ(h.percentile(0.99), 0);
+}
+
+TEST(StatsTest, DumpJSONContainsRegisteredMetrics) {
+    Stats::Instance().counter("test_counter").add(3);
+    Stats::Instance().histogram("test_timer").record(100);
+
+    json j = json::parse(Stats::Instance().DumpJSON());
+    EXPECT_GE(j["counters"]["test_counter"].get<uint64_t>(), 3u);
+    ASSERT_TRUE(j["timers"].contains("test_timer"));
+    EXPECT_TRUE(j["timers"]["test_timer"].contains("p99_ns"));
+    EXPECT_TRUE(j["timers"]["test_timer"].contains("p999_ns"));
+}
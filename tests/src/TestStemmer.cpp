@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+#include "Stemmer.h"
+#include "TokenFilter.h"
+#include <atomic>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+string English(string word) {
+    StemEnglish(word);
+    return word;
+}
+
+string Russian(string word) {
+    StemRussian(word);
+    return word;
+}
+
+// Считает вызовы вложенного фильтра
+class CountingFilter : public TokenFilter {
+public:
+    bool apply(string& word) const override {
+        ++calls;
+        if (word == "drop") return false;
+        word += "!";
+        return true;
+    }
+    mutable atomic<int> calls{0};
+};
+
+} // namespace
+
+TEST(StemmerTest, EnglishSnowballVocabulary) {
+    const vector<pair<string, string>> cases = {
+        {"consign", "consign"}, {"consigned", "consign"}, {"consignment", "consign"},
+        {"consistency", "consist"}, {"consistently", "consist"}, {"consolatory", "consolatori"},
+        {"consolidating", "consolid"}, {"constance", "constanc"}, {"knackeries", "knackeri"},
+        {"knitting", "knit"}, {"knives", "knive"}, {"generously", "generous"}, {"caresses", "caress"},
+        {"flies", "fli"}, {"dies", "die"}, {"ties", "tie"}, {"cries", "cri"}, {"agreed", "agre"},
+        {"hopping", "hop"}, {"hoping", "hope"}, {"sensational", "sensat"}, {"traditional", "tradit"},
+        {"itemization", "item"}, {"skies", "sky"}, {"milks", "milk"}, {"Running", "run"},
+        {"gas", "gas"}, {"by", "by"}, {"happily", "happili"},
+    };
+    for (const auto& [word, stem] : cases) EXPECT_EQ(English(word), stem) << word;
+
+    EXPECT_EQ(English("x-ray"), "x-ray");  // не только латинские буквы
+}
+
+TEST(StemmerTest, RussianSnowballVocabulary) {
+    const vector<pair<string, string>> cases = {
+        {"важная", "важн"}, {"важнейшими", "важн"}, {"вагоне", "вагон"}, {"вазы", "ваз"},
+        {"валенки", "валенк"}, {"валялась", "валя"}, {"ванной", "ван"}, {"варенье", "варен"},
+        {"вашего", "ваш"}, {"введено", "введ"}, {"ведь", "вед"}, {"великий", "велик"},
+        {"весело", "весел"}, {"весной", "весн"}, {"видел", "видел"}, {"вижу", "виж"},
+        {"вопросы", "вопрос"}, {"вошла", "вошл"}, {"впрочем", "впроч"}, {"время", "врем"},
+        {"говорил", "говор"}, {"делать", "дела"}, {"читающий", "чита"}, {"бегущий", "бегущ"},
+        {"Молоко", "молок"}, {"МОЛОКА", "молок"}, {"ёлки", "елк"},
+    };
+    for (const auto& [word, stem] : cases) EXPECT_EQ(Russian(word), stem) << word;
+
+    EXPECT_EQ(Russian("milk"), "milk");
+}
+
+TEST(StemmerTest, CachedFilterRunsInnerOnce) {
+    auto inner = make_shared<CountingFilter>();
+    CachedTokenFilter cached(inner, 64);
+
+    for (int i = 0; i < 3; ++i) {
+        string word = "milk";
+        EXPECT_TRUE(cached.apply(word));
+        EXPECT_EQ(word, "milk!");
+        string dropped = "drop";
+        EXPECT_FALSE(cached.apply(dropped));
+    }
+    EXPECT_EQ(inner->calls, 2);
+}
+
+TEST(StemmerTest, StemmedIndexMatchesWordForms) {
+    InvertedIndex idx;
+    idx.setStemming({StemLanguage::English, StemLanguage::Russian});
+    idx.setPositionalIndex(true);
+    idx.updateDocumentBaseFromStrings({
+        "Cows give milk, «молоко» и сливки",
+        "the milks are running",
+        "красивые коровы"
+    });
+    SearchServer server(idx);
+
+    auto results = server.search({"milk", "молока", "runs milk", "\"give milks\"", "корова", "сливка"});
+    EXPECT_EQ(results[0].size(), 2u);
+    ASSERT_EQ(results[1].size(), 1u);
+    EXPECT_EQ(results[1][0].doc_id, 0u);
+    ASSERT_EQ(results[2].size(), 1u);
+    EXPECT_EQ(results[2][0].doc_id, 1u);
+    EXPECT_EQ(results[3].size(), 1u);
+    ASSERT_EQ(results[4].size(), 1u);
+    EXPECT_EQ(results[4][0].doc_id, 2u);
+    EXPECT_EQ(results[5].size(), 1u);
+}
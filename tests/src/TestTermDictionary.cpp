@@ -0,0 +1,188 @@
+#include "gtest/gtest.h"
+#include "TermDictionary.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+vector<string> SampleTerms() {
+    vector<string> terms = {"capital", "capitalism", "capitol", "captain", "car", "cat",
+                            "london", "milk", "water", "apple", "banana"};
+    // Достаточно слов, чтобы получилось несколько блоков
+    for (int i = 0; i < 100; ++i) {
+        terms.push_back("term" + to_string(i));
+    }
+    return terms;
+}
+
+} // namespace
+
+TEST(TermDictionaryTest, IteratesInSortedOrder) {
+    vector<string> terms = SampleTerms();
+    TermDictionary dict;
+    dict.build(terms);
+
+    sort(terms.begin(), terms.end());
+    vector<string> decoded;
+    for (auto it = dict.begin(); it.valid(); it.next()) {
+        decoded.push_back(it.term());
+    }
+    EXPECT_EQ(decoded, terms);
+    EXPECT_EQ(dict.size(), terms.size());
+}
+
+TEST(TermDictionaryTest, ContainsAndSeek) {
+    TermDictionary dict;
+    dict.build(SampleTerms());
+
+    EXPECT_TRUE(dict.contains("capitol"));
+    EXPECT_TRUE(dict.contains("term57"));
+    EXPECT_FALSE(dict.contains("capit"));
+    EXPECT_FALSE(dict.contains("zzz"));
+
+    auto it = dict.seek("cas");
+    ASSERT_TRUE(it.valid());
+    EXPECT_EQ(it.term(), "cat");
+    EXPECT_FALSE(dict.seek("zzz").valid());
+}
+
+TEST(TermDictionaryTest, PrefixRangeWildcard) {
+    TermDictionary dict;
+    dict.build(SampleTerms());
+
+    EXPECT_EQ(dict.expandPrefix("capit", 10), vector<string>({"capital", "capitalism", "capitol"}));
+    EXPECT_EQ(dict.expandPrefix("capit", 2), vector<string>({"capital", "capitalism"}));
+    EXPECT_EQ(dict.expandRange("banana", "capitol", 10),
+              vector<string>({"banana", "capital", "capitalism", "capitol"}));
+    EXPECT_EQ(dict.expandWildcard("ca?", 10), vector<string>({"car", "cat"}));
+    EXPECT_EQ(dict.expandWildcard("*ital*", 10), vector<string>({"capital", "capitalism"}));
+    EXPECT_EQ(dict.expandWildcard("term9?", 100).size(), 10);
+}
+
+TEST(TermDictionaryTest, CompressesSharedPrefixes) {
+    vector<string> terms;
+    size_t raw = 0;
+    for (int i = 0; i < 1000; ++i) {
+        terms.push_back("internationalization" + to_string(i));
+        raw += terms.back().size();
+    }
+    TermDictionary dict;
+    dict.build(terms);
+    EXPECT_LT(dict.memoryBytes(), raw / 2);
+}
+
+TEST(TermDictionaryTest, WildcardMatch) {
+    EXPECT_TRUE(WildcardMatch("a*c", "abbbc"));
+    EXPECT_TRUE(WildcardMatch("*", ""));
+    EXPECT_FALSE(WildcardMatch("a?c", "ac"));
+    EXPECT_TRUE(WildcardMatch("*b*", "abc"));
+
+    // '?' — один символ UTF-8, а не байт
+    EXPECT_TRUE(WildcardMatch("молок?", "молока"));
+    EXPECT_FALSE(WildcardMatch("молок??", "молока"));
+    EXPECT_TRUE(WildcardMatch("*?а", "молока"));
+    EXPECT_TRUE(WildcardMatch("?", "ж"));
+
+    TermDictionary dict;
+    dict.build({"молоко", "молока", "молоку", "молокозавод", "moloka"});
+    EXPECT_EQ(dict.expandWildcard("молок?", 10), vector<string>({"молока", "молоко", "молоку"}));
+}
+
+TEST(TermDictionaryTest, FuzzyExpansion) {
+    TermDictionary dict;
+    dict.build(SampleTerms());
+
+    auto one = dict.expandFuzzy("capitol", 1, 10);
+    ASSERT_EQ(one.size(), 2);
+    EXPECT_EQ(one[0], make_pair(string("capitol"), 0u));
+    EXPECT_EQ(one[1], make_pair(string("capital"), 1u));
+
+    auto typo = dict.expandFuzzy("lodnon", 2, 10);
+    ASSERT_EQ(typo.size(), 1);
+    EXPECT_EQ(typo[0].first, "london");
+
+    EXPECT_TRUE(dict.expandFuzzy("xyzzy", 2, 10).empty());
+    EXPECT_EQ(dict.expandFuzzy("term5", 1, 3).size(), 3);
+
+    // Правки считаются в символах: у «о» и «а» ведущие байты одинаковы,
+    // у «о» и «я» — разные, но обе замены стоят по одной правке
+    TermDictionary cyrillic;
+    cyrillic.build({"молоко", "молока", "молокя", "малако", "молокозавод"});
+    auto milk = cyrillic.expandFuzzy("молоко", 1, 10);
+    ASSERT_EQ(milk.size(), 3);
+    EXPECT_EQ(milk[0], make_pair(string("молоко"), 0u));
+    EXPECT_EQ(milk[1], make_pair(string("молока"), 1u));
+    EXPECT_EQ(milk[2], make_pair(string("молокя"), 1u));
+    EXPECT_EQ(cyrillic.expandFuzzy("малоко", 1, 10).size(), 2);  // молоко, малако
+}
+
+TEST(TermDictionaryTest, FuzzyMatchesBruteForce) {
+    vector<string> terms = SampleTerms();
+    TermDictionary dict;
+    dict.build(terms);
+
+    auto distance = [](const string& a, const string& b) {
+        vector<size_t> row(b.size() + 1);
+        for (size_t j = 0; j <= b.size(); ++j) row[j] = j;
+        for (size_t i = 1; i <= a.size(); ++i) {
+            size_t diag = row[0];
+            row[0] = i;
+            for (size_t j = 1; j <= b.size(); ++j) {
+                size_t up = row[j];
+                row[j] = min({row[j] + 1, row[j - 1] + 1, diag + (a[i - 1] == b[j - 1] ? 0 : 1)});
+                diag = up;
+            }
+        }
+        return row[b.size()];
+    };
+
+    for (const string query : {"cat", "capt", "tern1", "mlk", "banan"}) {
+        size_t expected = 0;
+        for (const auto& t : terms) {
+            if (distance(query, t) <= 2) ++expected;
+        }
+        EXPECT_EQ(dict.expandFuzzy(query, 2, 1000).size(), expected) << query;
+    }
+}
+
+TEST(TermDictionaryTest, UpdateMatchesBuild) {
+    // Несколько страниц: изменения в начале, середине, конце и за пределами словаря
+    vector<string> terms;
+    for (int i = 0; i < 5000; ++i) terms.push_back("w" + to_string(i * 2));
+    TermDictionary dict;
+    dict.build(terms);
+
+    vector<string> added = {"a", "w1", "w5001", "w9999", "zz"};
+    for (int i = 0; i < 3000; ++i) added.push_back("w3" + to_string(i * 2 + 1) + "x");
+    vector<string> removed;
+    for (int i = 0; i < 1500; ++i) removed.push_back("w" + to_string(i * 2));
+    removed.push_back("w9998");
+    dict.update(added, removed);
+
+    vector<string> expected;
+    for (const auto& term : terms) {
+        if (find(removed.begin(), removed.end(), term) == removed.end()) expected.push_back(term);
+    }
+    expected.insert(expected.end(), added.begin(), added.end());
+    TermDictionary fresh;
+    fresh.build(expected);
+
+    vector<string> decoded;
+    for (auto it = dict.begin(); it.valid(); it.next()) decoded.push_back(it.term());
+    EXPECT_EQ(decoded, fresh.expandWildcard("*", SIZE_MAX));
+    EXPECT_EQ(dict.size(), fresh.size());
+    EXPECT_TRUE(dict.contains("w5001"));
+    EXPECT_FALSE(dict.contains("w0"));
+    EXPECT_EQ(dict.seek("w30").term(), fresh.seek("w30").term());
+    EXPECT_EQ(dict.expandPrefix("w999", 10), fresh.expandPrefix("w999", 10));
+
+    // Удаление всех слов опустошает словарь
+    dict.update({}, decoded);
+    EXPECT_EQ(dict.size(), 0u);
+    EXPECT_FALSE(dict.begin().valid());
+    dict.update({"milk"}, {});
+    EXPECT_TRUE(dict.contains("milk"));
+}
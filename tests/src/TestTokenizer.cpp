@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include "InvertedIndex.h"
+#include "SearchServer.h"
+#include "Tokenizer.h"
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Исходный разбор через stringstream и <cctype>
+vector<string> ReferenceTokenize(const string& text) {
+    vector<string> words;
+    stringstream ss(text);
+    string word;
+    while (ss >> word) {
+        word.erase(remove_if(word.begin(), word.end(),
+                             [](char c) { return !isalnum(static_cast<unsigned char>(c)); }),
+                   word.end());
+        bool valid = !word.empty() && word.size() <= 100
+                  && all_of(word.begin(), word.end(), [](char c) { return isalpha(static_cast<unsigned char>(c)); });
+        if (valid) words.push_back(word);
+    }
+    return words;
+}
+
+vector<SimdLevel> SupportedLevels() {
+    vector<SimdLevel> levels = {SimdLevel::Scalar};
+    if (DetectSimdLevel() != SimdLevel::Scalar) levels.push_back(SimdLevel::Sse2);
+    if (DetectSimdLevel() == SimdLevel::Avx2) levels.push_back(SimdLevel::Avx2);
+    return levels;
+}
+
+} // namespace
+
+TEST(TokenizerTest, KnownCases) {
+    EXPECT_EQ(Tokenize("milk, water!  tea\n"), (vector<string>{"milk", "water", "tea"}));
+    EXPECT_EQ(Tokenize("abc123 r2d2 x-ray don't"), (vector<string>{"xray", "dont"}));
+    EXPECT_EQ(Tokenize(""), vector<string>{});
+    EXPECT_EQ(Tokenize(string(100, 'a') + " " + string(101, 'b')), vector<string>{string(100, 'a')});
+    EXPECT_EQ(Tokenize("Milk WATER", TokenizerOptions{true}), (vector<string>{"milk", "water"}));
+}
+
+TEST(TokenizerTest, MatchesReferenceOnRandomText) {
+    // Алфавит с пробелами, цифрами, знаками, байтами UTF-8 и длинными словами
+    const string alphabet = "abcXYZ  \t\n\r\v\f019.,!-'\"()\x80\xd0\xb0\xff";
+    mt19937 rng(42);
+    for (int round = 0; round < 300; ++round) {
+        string text;
+        size_t length = rng() % 600;
+        while (text.size() < length) {
+            if (rng() % 40 == 0) {
+                text += string(90 + rng() % 20, 'q');  // слова на границе 100 символов
+            } else {
+                text += alphabet[rng() % alphabet.size()];
+            }
+        }
+        vector<string> expected = ReferenceTokenize(text);
+        for (SimdLevel level : SupportedLevels()) {
+            EXPECT_EQ(Tokenize(text, {}, level), expected) << SimdLevelName(level) << " round " << round;
+        }
+    }
+}
+
+TEST(TokenizerTest, LowercaseKernels) {
+    string text;
+    for (int c = 0; c < 256; ++c) text += static_cast<char>(c);
+    text += text;
+    string expected = text;
+    for (auto& c : expected) {
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+    }
+    for (SimdLevel level : SupportedLevels()) {
+        string copy = text;
+        AsciiLowercase(copy, level);
+        EXPECT_EQ(copy, expected) << SimdLevelName(level);
+    }
+}
+
+TEST(TokenizerTest, LowercaseIndexNormalizesQueries) {
+    InvertedIndex idx;
+    idx.setLowercase(true);
+    idx.updateDocumentBaseFromStrings({"Milk and WATER", "milk"});
+    SearchServer server(idx);
+    auto result = server.search({"MILK Water", "mil*"});
+    EXPECT_EQ(result[0], (vector<RelativeIndex>{{0, 1.0f}}));
+    EXPECT_EQ(result[1].size(), 2u);
+}
+
+TEST(TokenizerTest, StopWordsAfterLowercase) {
+    TokenizerOptions options;
+    options.lowercase = true;
+    options.stop_words = std::make_shared<const StopWordSet>(StopWordSet{"the", "and"});
+    EXPECT_EQ(Tokenize("The milk AND the water", options), (vector<string>{"milk", "water"}));
+}
+
+TEST(TokenizerTest, Utf8LettersKeepCyrillic) {
+    TokenizerOptions options;
+    options.utf8_letters = true;
+    for (SimdLevel level : SupportedLevels()) {
+        EXPECT_EQ(Tokenize("«Молоко» — café, 2х r2d2 naïve", options, level),
+                  (vector<string>{"Молоко", "café", "naïve"}))
+            << SimdLevelName(level);
+    }
+    EXPECT_EQ(Tokenize("«Молоко» café"), (vector<string>{"caf"}));
+}
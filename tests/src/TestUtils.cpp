@@ -1,6 +1,8 @@
 #include "gtest/gtest.h"
-#include "configUtils.h"
+#include "ConfigUtils.h"
+#include <stdexcept>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -17,3 +19,38 @@ TEST(UtilsTest, WstringToUtf8AndBack) {
 
     EXPECT_EQ(original, back);
 }
+
+TEST(UtilsTest, Utf8TranscodingAllLengths) {
+    // 1-, 2-, 3- и 4-байтовые символы, в том числе за длинным участком ASCII
+    string utf8 = string(70, 'a') + "é€😀Ж" + string(40, 'b') + "ё";
+    wstring wide = utf8_to_wstring(utf8);
+    EXPECT_EQ(wstring_to_utf8(wide), utf8);
+    EXPECT_EQ(wide.substr(70, 2), L"é€");
+    EXPECT_EQ(wide.back(), L'ё');
+    EXPECT_EQ(utf8_ascii_prefix(utf8), 70u);
+    EXPECT_EQ(utf8_ascii_prefix(string(100, 'x')), 100u);
+    EXPECT_TRUE(is_valid_utf8(utf8));
+}
+
+TEST(UtilsTest, InvalidUtf8IsRejected) {
+    const vector<string> invalid = {
+        "\xC0\x80",          // избыточная форма
+        "\xE0\x80\xAF",      // избыточная форма
+        "\xED\xA0\x80",      // суррогат
+        "\xF4\x90\x80\x80",  // больше U+10FFFF
+        "\xD0",              // обрыв
+        "milk \xE2\x80",     // обрыв в конце
+        "\x80",              // продолжение без начала
+        string(40, 'a') + "\xFF",
+    };
+    for (const auto& text : invalid) {
+        EXPECT_FALSE(is_valid_utf8(text)) << text.size();
+        EXPECT_THROW(utf8_to_wstring(text), std::range_error);
+    }
+    EXPECT_THROW(wstring_to_utf8(wstring(1, static_cast<wchar_t>(0xD800))), std::range_error);
+}
+
+TEST(UtilsTest, NormalizeDashUtf8) {
+    EXPECT_EQ(normalize_dash(string("file–name—x.txt")), "file-name-x.txt");
+    EXPECT_EQ(normalize_dash(string("€ plain")), "€ plain");
+}